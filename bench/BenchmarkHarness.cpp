@@ -0,0 +1,160 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkHarness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+    void WriteJsonString(std::ostream &out, const std::string &value)
+    {
+        out << '"';
+        for (auto c : value)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+    std::string GetTimestamp()
+    {
+        auto now = std::time(nullptr);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buffer;
+    }
+}
+
+void bench::BenchmarkHarness::Run(const std::string &name, const std::function<void()> &setup, const std::function<void()> &body,
+    double itemsPerSample, std::vector<std::pair<std::string, double>> counters)
+{
+    if (!Filter.empty() && name.find(Filter) == std::string::npos)
+        return;
+    //One untimed run warms up the caches and any lazily allocated scratch.
+    if (setup)
+        setup();
+    body();
+
+    std::vector<double> samples;
+    double totalSeconds = 0;
+    while (samples.size() < static_cast<size_t>(MaximumSamples) &&
+        (totalSeconds < MinimumTime || samples.size() < static_cast<size_t>(MinimumSamples)))
+    {
+        if (setup)
+            setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalSeconds += seconds;
+        samples.push_back(seconds * 1e9);
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.samples = samples.size();
+    result.itemsPerSample = itemsPerSample;
+    result.counters = std::move(counters);
+    std::sort(samples.begin(), samples.end());
+    result.minimumNs = samples.front();
+    result.maximumNs = samples.back();
+    auto middle = samples.size() / 2;
+    result.medianNs = samples.size() % 2 == 1 ? samples[middle] : 0.5 * (samples[middle - 1] + samples[middle]);
+    double sum = 0;
+    for (auto sample : samples)
+        sum += sample;
+    result.meanNs = sum / samples.size();
+    double squaredDeviations = 0;
+    for (auto sample : samples)
+        squaredDeviations += (sample - result.meanNs) * (sample - result.meanNs);
+    result.standardDeviationNs = samples.size() > 1 ? std::sqrt(squaredDeviations / (samples.size() - 1)) : 0.0;
+    results.push_back(std::move(result));
+}
+
+const std::vector<bench::BenchmarkResult> &bench::BenchmarkHarness::GetResults() const {return results;}
+
+void bench::BenchmarkHarness::WriteJson(std::ostream &out) const
+{
+    out << std::setprecision(9);
+    out << "{\n  \"context\": {\n";
+    out << "    \"library\": \"cppbepuik\",\n";
+    out << "    \"date\": ";
+    WriteJsonString(out, GetTimestamp());
+    out << ",\n";
+#ifdef NDEBUG
+    out << "    \"build_type\": \"release\",\n";
+#else
+    out << "    \"build_type\": \"debug\",\n";
+#endif
+#ifdef BEPUIK_MATH_USE_GLM
+    out << "    \"math\": \"glm\",\n";
+#else
+    out << "    \"math\": \"bepu\",\n";
+#endif
+    out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"minimum_time_s\": " << MinimumTime << "\n";
+    out << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto &result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        WriteJsonString(out, result.name);
+        out << ", \"samples\": " << result.samples;
+        out << ", \"mean_ns\": " << result.meanNs;
+        out << ", \"median_ns\": " << result.medianNs;
+        out << ", \"min_ns\": " << result.minimumNs;
+        out << ", \"max_ns\": " << result.maximumNs;
+        out << ", \"stddev_ns\": " << result.standardDeviationNs;
+        out << ", \"items_per_sample\": " << result.itemsPerSample;
+        out << ", \"median_ns_per_item\": " << result.medianNs / result.itemsPerSample;
+        out << ", \"counters\": {";
+        for (size_t j = 0; j < result.counters.size(); ++j)
+        {
+            out << (j == 0 ? "" : ", ");
+            WriteJsonString(out, result.counters[j].first);
+            out << ": " << result.counters[j].second;
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void bench::BenchmarkHarness::WriteTable(std::ostream &out) const
+{
+    size_t nameWidth = 9;
+    for (auto &result : results)
+        nameWidth = std::max(nameWidth, result.name.size());
+    out << std::left << std::setw(nameWidth) << "benchmark" << std::right
+        << std::setw(10) << "samples" << std::setw(16) << "median (us)" << std::setw(14) << "stddev (%)" << std::setw(16) << "ns/item" << "\n";
+    out << std::fixed;
+    for (auto &result : results)
+    {
+        out << std::left << std::setw(nameWidth) << result.name << std::right
+            << std::setw(10) << result.samples
+            << std::setw(16) << std::setprecision(3) << result.medianNs * 1e-3
+            << std::setw(14) << std::setprecision(1) << (result.meanNs > 0 ? 100 * result.standardDeviationNs / result.meanNs : 0.0)
+            << std::setw(16) << std::setprecision(2) << result.medianNs / result.itemsPerSample << "\n";
+    }
+    out << std::defaultfloat;
+}
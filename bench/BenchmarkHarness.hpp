@@ -0,0 +1,91 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    /// <summary>
+    /// Timing statistics of a single benchmark. All times are wall clock nanoseconds per sample.
+    /// </summary>
+    struct BenchmarkResult
+    {
+        std::string name;
+        size_t samples = 0;
+        double meanNs = 0;
+        double medianNs = 0;
+        double minimumNs = 0;
+        double maximumNs = 0;
+        double standardDeviationNs = 0;
+        /// <summary>
+        /// Number of items (bones, joints, characters) processed by one sample. Used to report the time per item.
+        /// </summary>
+        double itemsPerSample = 1;
+        /// <summary>
+        /// Extra values describing the benchmark, such as the size of the rig it ran on.
+        /// </summary>
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    /// <summary>
+    /// Minimal benchmark runner. Every sample runs an untimed setup followed by the timed body, so state consumed by the body can be restored between samples.
+    /// Samples are taken until both the minimum time and the minimum sample count are reached.
+    /// </summary>
+    class BenchmarkHarness
+    {
+    public:
+        /// <summary>
+        /// Minimum accumulated body time in seconds per benchmark.
+        /// </summary>
+        double MinimumTime = 0.1;
+        int MinimumSamples = 5;
+        int MaximumSamples = 1000000;
+        /// <summary>
+        /// Only benchmarks whose name contains this string are run. Empty runs everything.
+        /// </summary>
+        std::string Filter;
+
+        /// <summary>
+        /// Runs a benchmark if it passes the filter and records its result.
+        /// </summary>
+        /// <param name="name">Unique name of the benchmark, conventionally "group/case".</param>
+        /// <param name="setup">Untimed work run before every sample. May be empty.</param>
+        /// <param name="body">Timed work of a sample.</param>
+        /// <param name="itemsPerSample">Number of items processed by one sample.</param>
+        /// <param name="counters">Extra values stored alongside the result.</param>
+        void Run(const std::string &name, const std::function<void()> &setup, const std::function<void()> &body,
+            double itemsPerSample = 1, std::vector<std::pair<std::string, double>> counters = {});
+
+        const std::vector<BenchmarkResult> &GetResults() const;
+
+        /// <summary>
+        /// Writes the recorded results, along with a description of the build, as a JSON document.
+        /// </summary>
+        void WriteJson(std::ostream &out) const;
+
+        /// <summary>
+        /// Writes the recorded results as a human readable table.
+        /// </summary>
+        void WriteTable(std::ostream &out) const;
+    private:
+        std::vector<BenchmarkResult> results;
+    };
+}
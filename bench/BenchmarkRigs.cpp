@@ -0,0 +1,224 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRigs.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/limit/IKTwistLimit.hpp"
+#include "bepuik/control/StateControl.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
+
+using namespace BEPUik;
+
+BEPUik::Bone &bench::BenchmarkRig::AddBone(const Vector3 &start, const Vector3 &end, float radius)
+{
+    auto direction = vector3::Subtract(end, start);
+    auto length = vector3::Length(direction);
+    direction = vector3::Divide(direction, length);
+    auto orientation = quaternion::GetQuaternionBetweenNormalizedVectors(vector3::Up, direction);
+    auto center = vector3::Multiply(vector3::Add(start, end), 0.5f);
+    bones.push_back(std::make_unique<Bone>(center, orientation, radius, length));
+    return *bones.back();
+}
+
+void bench::BenchmarkRig::AddLimitedBallSocket(Bone &parent, Bone &child, const Vector3 &anchor,
+    const Vector3 &parentAxis, const Vector3 &childAxis, float maximumSwing, float maximumTwist)
+{
+    AddJoint<IKBallSocketJoint>(parent, child, anchor);
+    AddJoint<IKSwingLimit>(parent, child, parentAxis, childAxis, maximumSwing);
+    AddJoint<IKTwistLimit>(parent, child, parentAxis, childAxis, maximumTwist);
+}
+
+BEPUik::DragControl &bench::BenchmarkRig::AddDrag(Bone &bone, const Vector3 &target)
+{
+    auto control = std::make_unique<DragControl>();
+    auto &result = *control;
+    control->SetTargetBone(&bone);
+    control->GetLinearMotor()->TargetPosition = target;
+    control->GetLinearMotor()->LocalOffset = vector3::Zero;
+    controls.push_back(control.get());
+    ownedControls.push_back(std::move(control));
+    return result;
+}
+
+void bench::BenchmarkRig::CaptureRestPose()
+{
+    restPositions.clear();
+    restOrientations.clear();
+    for (auto &bone : bones)
+    {
+        restPositions.push_back(bone->Position);
+        restOrientations.push_back(bone->Orientation);
+    }
+}
+
+void bench::BenchmarkRig::ResetPose()
+{
+    for (size_t i = 0; i < bones.size(); ++i)
+    {
+        bones[i]->Position = restPositions[i];
+        bones[i]->Orientation = restOrientations[i];
+    }
+}
+
+std::unique_ptr<bench::BenchmarkRig> bench::CreateHumanoidRig(const Vector3 &origin)
+{
+    auto rig = std::make_unique<BenchmarkRig>();
+    auto at = [&origin](float x, float y, float z) { return vector3::Add(origin, Vector3{x, y, z}); };
+    const Vector3 up {0.f, 1.f, 0.f};
+    const Vector3 down {0.f, -1.f, 0.f};
+
+    auto &pelvis = rig->AddBone(at(0.f, 0.95f, 0.f), at(0.f, 1.1f, 0.f), 0.12f);
+    pelvis.SetPinned(true);
+    auto &spine = rig->AddBone(at(0.f, 1.1f, 0.f), at(0.f, 1.3f, 0.f), 0.1f);
+    auto &chest = rig->AddBone(at(0.f, 1.3f, 0.f), at(0.f, 1.5f, 0.f), 0.12f);
+    auto &neck = rig->AddBone(at(0.f, 1.5f, 0.f), at(0.f, 1.6f, 0.f), 0.05f);
+    auto &head = rig->AddBone(at(0.f, 1.6f, 0.f), at(0.f, 1.8f, 0.f), 0.09f);
+    rig->AddLimitedBallSocket(pelvis, spine, at(0.f, 1.1f, 0.f), up, up, 0.4f, 0.3f);
+    rig->AddLimitedBallSocket(spine, chest, at(0.f, 1.3f, 0.f), up, up, 0.4f, 0.3f);
+    rig->AddLimitedBallSocket(chest, neck, at(0.f, 1.5f, 0.f), up, up, 0.5f, 0.5f);
+    rig->AddLimitedBallSocket(neck, head, at(0.f, 1.6f, 0.f), up, up, 0.5f, 0.5f);
+
+    for (float side : {-1.f, 1.f})
+    {
+        const Vector3 outward {side, 0.f, 0.f};
+        auto &clavicle = rig->AddBone(at(side * 0.05f, 1.48f, 0.f), at(side * 0.2f, 1.48f, 0.f), 0.04f);
+        auto &upperArm = rig->AddBone(at(side * 0.2f, 1.48f, 0.f), at(side * 0.48f, 1.48f, 0.f), 0.05f);
+        auto &forearm = rig->AddBone(at(side * 0.48f, 1.48f, 0.f), at(side * 0.74f, 1.48f, 0.f), 0.04f);
+        auto &hand = rig->AddBone(at(side * 0.74f, 1.48f, 0.f), at(side * 0.84f, 1.48f, 0.f), 0.04f);
+        rig->AddLimitedBallSocket(chest, clavicle, at(side * 0.05f, 1.48f, 0.f), up, outward, 1.6f, 0.2f);
+        rig->AddLimitedBallSocket(clavicle, upperArm, at(side * 0.2f, 1.48f, 0.f), outward, outward, 1.4f, 0.8f);
+        rig->AddLimitedBallSocket(upperArm, forearm, at(side * 0.48f, 1.48f, 0.f), outward, outward, 2.2f, 0.8f);
+        rig->AddJoint<IKRevoluteJoint>(upperArm, forearm, up);
+        rig->AddLimitedBallSocket(forearm, hand, at(side * 0.74f, 1.48f, 0.f), outward, outward, 0.8f, 0.3f);
+
+        auto &thigh = rig->AddBone(at(side * 0.1f, 1.f, 0.f), at(side * 0.1f, 0.55f, 0.f), 0.07f);
+        auto &shin = rig->AddBone(at(side * 0.1f, 0.55f, 0.f), at(side * 0.1f, 0.1f, 0.f), 0.05f);
+        auto &foot = rig->AddBone(at(side * 0.1f, 0.1f, 0.f), at(side * 0.1f, 0.05f, 0.18f), 0.04f);
+        rig->AddLimitedBallSocket(pelvis, thigh, at(side * 0.1f, 1.f, 0.f), down, down, 1.2f, 0.5f);
+        rig->AddLimitedBallSocket(thigh, shin, at(side * 0.1f, 0.55f, 0.f), down, down, 2.2f, 0.2f);
+        rig->AddJoint<IKRevoluteJoint>(thigh, shin, Vector3{1.f, 0.f, 0.f});
+        rig->AddLimitedBallSocket(shin, foot, at(side * 0.1f, 0.1f, 0.f), down, Vector3{0.f, -0.27f, 0.96f}, 0.6f, 0.3f);
+
+        //Reach forward and lift one foot so that every limb has some work to do.
+        rig->AddDrag(hand, at(side * 0.45f, 1.3f, 0.45f));
+        rig->AddDrag(foot, side < 0 ? at(side * 0.15f, 0.45f, 0.35f) : foot.Position);
+    }
+
+    auto headControl = std::make_unique<StateControl>();
+    headControl->SetTargetBone(&head);
+    headControl->GetLinearMotor()->TargetPosition = vector3::Add(head.Position, Vector3{0.f, -0.05f, 0.08f});
+    headControl->GetLinearMotor()->LocalOffset = vector3::Zero;
+    rig->controls.push_back(headControl.get());
+    rig->ownedControls.push_back(std::move(headControl));
+
+    rig->CaptureRestPose();
+    return rig;
+}
+
+std::unique_ptr<bench::BenchmarkRig> bench::CreateChainRig(int boneCount)
+{
+    auto rig = std::make_unique<BenchmarkRig>();
+    const Vector3 up {0.f, 1.f, 0.f};
+    for (int i = 0; i < boneCount; ++i)
+    {
+        Vector3 start {0.f, static_cast<float>(i), 0.f};
+        Vector3 end {0.f, static_cast<float>(i + 1), 0.f};
+        auto &bone = rig->AddBone(start, end, 0.2f);
+        if (i == 0)
+            bone.SetPinned(true);
+        else
+            rig->AddLimitedBallSocket(*rig->bones[i - 1], bone, start, up, up, 0.3f, 0.2f);
+    }
+    rig->AddDrag(*rig->bones.back(), Vector3{boneCount * 0.4f, boneCount * 0.6f, boneCount * 0.1f});
+    rig->CaptureRestPose();
+    return rig;
+}
+
+std::unique_ptr<bench::BenchmarkRig> bench::CreateTreeRig(int depth)
+{
+    auto rig = std::make_unique<BenchmarkRig>();
+    struct Node
+    {
+        Bone *bone;
+        Vector3 end;
+        Vector3 direction;
+    };
+    auto &root = rig->AddBone(Vector3{0.f, 0.f, 0.f}, Vector3{0.f, 1.f, 0.f}, 0.2f);
+    root.SetPinned(true);
+    std::vector<Node> level {{&root, Vector3{0.f, 1.f, 0.f}, Vector3{0.f, 1.f, 0.f}}};
+    for (int d = 1; d < depth; ++d)
+    {
+        std::vector<Node> next;
+        for (size_t i = 0; i < level.size(); ++i)
+        {
+            auto &parent = level[i];
+            for (float side : {-1.f, 1.f})
+            {
+                //Alternate the branching plane so the tree spreads out in three dimensions.
+                Vector3 spread = d % 2 == 0 ? Vector3{side, 0.f, 0.f} : Vector3{0.f, 0.f, side};
+                auto direction = vector3::Add(parent.direction, vector3::Multiply(spread, 0.5f));
+                vector3::Normalize(direction);
+                auto end = vector3::Add(parent.end, direction);
+                auto &child = rig->AddBone(parent.end, end, 0.15f);
+                rig->AddLimitedBallSocket(*parent.bone, child, parent.end, parent.direction, direction, 0.6f, 0.3f);
+                next.push_back({&child, end, direction});
+            }
+        }
+        level = std::move(next);
+    }
+    //Drag every fourth leaf sideways.
+    for (size_t i = 0; i < level.size(); i += 4)
+        rig->AddDrag(*level[i].bone, vector3::Add(level[i].bone->Position, Vector3{0.5f, -0.3f, 0.4f}));
+    rig->CaptureRestPose();
+    return rig;
+}
+
+std::unique_ptr<bench::BenchmarkRig> bench::CreateCyclicGraphRig(int width, int height)
+{
+    auto rig = std::make_unique<BenchmarkRig>();
+    const Vector3 up {0.f, 1.f, 0.f};
+    auto index = [width](int x, int y) { return static_cast<size_t>(y * width + x); };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            rig->AddBone(Vector3{static_cast<float>(x), static_cast<float>(y), 0.f}, Vector3{static_cast<float>(x), y + 0.5f, 0.f}, 0.1f);
+    }
+    rig->bones[index(0, 0)]->SetPinned(true);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto &bone = *rig->bones[index(x, y)];
+            if (x + 1 < width)
+            {
+                auto &right = *rig->bones[index(x + 1, y)];
+                rig->AddJoint<IKBallSocketJoint>(bone, right, vector3::Multiply(vector3::Add(bone.Position, right.Position), 0.5f));
+                rig->AddJoint<IKSwingLimit>(bone, right, up, up, 0.5f);
+            }
+            if (y + 1 < height)
+            {
+                auto &above = *rig->bones[index(x, y + 1)];
+                rig->AddJoint<IKBallSocketJoint>(bone, above, vector3::Multiply(vector3::Add(bone.Position, above.Position), 0.5f));
+                rig->AddJoint<IKSwingLimit>(bone, above, up, up, 0.5f);
+            }
+        }
+    }
+    auto &corner = *rig->bones[index(width - 1, height - 1)];
+    rig->AddDrag(corner, vector3::Add(corner.Position, Vector3{1.f, -1.f, 2.f}));
+    rig->CaptureRestPose();
+    return rig;
+}
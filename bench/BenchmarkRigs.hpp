@@ -0,0 +1,93 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/Bone.hpp"
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/control/Control.hpp"
+#include "bepuik/control/DragControl.hpp"
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    /// <summary>
+    /// Synthetic rig owning its bones, joints and controls. The rest pose is captured once the rig is built so that benchmarks can restore it between solves.
+    /// </summary>
+    struct BenchmarkRig
+    {
+        std::vector<std::unique_ptr<BEPUik::Bone>> bones;
+        std::vector<std::unique_ptr<BEPUik::IKJoint>> joints;
+        std::vector<std::unique_ptr<BEPUik::Control>> ownedControls;
+        std::vector<BEPUik::Control*> controls;
+        std::vector<BEPUik::IKJoint*> jointPointers;
+
+        /// <summary>
+        /// Adds a bone spanning the segment between two points. The local Y axis of the bone points from start to end.
+        /// </summary>
+        BEPUik::Bone &AddBone(const BEPUik::Vector3 &start, const BEPUik::Vector3 &end, float radius);
+
+        template<typename TJoint, typename... TArgs>
+        TJoint &AddJoint(TArgs&&... args)
+        {
+            auto joint = std::make_unique<TJoint>(std::forward<TArgs>(args)...);
+            auto &result = *joint;
+            jointPointers.push_back(joint.get());
+            joints.push_back(std::move(joint));
+            return result;
+        }
+
+        /// <summary>
+        /// Connects two bones at a point with a ball socket joint, a swing limit and a twist limit around the given axes.
+        /// </summary>
+        void AddLimitedBallSocket(BEPUik::Bone &parent, BEPUik::Bone &child, const BEPUik::Vector3 &anchor,
+            const BEPUik::Vector3 &parentAxis, const BEPUik::Vector3 &childAxis, float maximumSwing, float maximumTwist);
+
+        /// <summary>
+        /// Adds a drag control pulling the center of a bone towards a target position.
+        /// </summary>
+        BEPUik::DragControl &AddDrag(BEPUik::Bone &bone, const BEPUik::Vector3 &target);
+
+        void CaptureRestPose();
+        void ResetPose();
+    private:
+        std::vector<BEPUik::Vector3> restPositions;
+        std::vector<BEPUik::Quaternion> restOrientations;
+    };
+
+    /// <summary>
+    /// Humanoid with a pinned pelvis, spine, head, arms and legs. Every connection is a ball socket with swing and twist limits, elbows and knees are additionally hinged.
+    /// Hands and feet are dragged and the head is held by a state control.
+    /// </summary>
+    std::unique_ptr<BenchmarkRig> CreateHumanoidRig(const BEPUik::Vector3 &origin = {0.f, 0.f, 0.f});
+
+    /// <summary>
+    /// Single chain pinned at its root and dragged by its tip.
+    /// </summary>
+    std::unique_ptr<BenchmarkRig> CreateChainRig(int boneCount);
+
+    /// <summary>
+    /// Binary tree pinned at its root with some of its leaves dragged.
+    /// </summary>
+    std::unique_ptr<BenchmarkRig> CreateTreeRig(int depth);
+
+    /// <summary>
+    /// Grid of bones connected to their horizontal and vertical neighbours, so the joint graph contains many cycles.
+    /// One corner is pinned and the opposite corner is dragged.
+    /// </summary>
+    std::unique_ptr<BenchmarkRig> CreateCyclicGraphRig(int width, int height);
+}
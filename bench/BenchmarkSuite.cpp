@@ -0,0 +1,468 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkHarness.hpp"
+#include "BenchmarkRigs.hpp"
+#include "bepuik/IKRig.hpp"
+#include "bepuik/IKRigFile.hpp"
+#include "bepuik/IKRigWorkspace.hpp"
+#include "bepuik/IKSolver.hpp"
+#include "bepuik/IKSolverPool.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
+#include "bepuik/joint/IKAngularJoint.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKDistanceJoint.hpp"
+#include "bepuik/joint/IKPointOnLineJoint.hpp"
+#include "bepuik/joint/IKPointOnPlaneJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/joint/IKSwivelHingeJoint.hpp"
+#include "bepuik/joint/IKTwistJoint.hpp"
+#include "bepuik/limit/IKDistanceLimit.hpp"
+#include "bepuik/limit/IKEllipseSwingLimit.hpp"
+#include "bepuik/limit/IKLinearAxisLimit.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/limit/IKTwistLimit.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+//Solver benchmark suite. Times full solves and active set rebuilds on a set of synthetic rigs, and every constraint kernel in isolation.
+//Usage: cppbepuik_bench [--filter=<substring>] [--min-time=<seconds>] [--out=<file>]
+//The results are written as JSON to the output file, or to stdout if none is given. A summary table is printed to stderr.
+namespace
+{
+    using namespace BEPUik;
+    using bench::BenchmarkHarness;
+    using bench::BenchmarkRig;
+
+    std::vector<std::pair<std::string, double>> DescribeRig(const BenchmarkRig &rig)
+    {
+        return {{"bones", static_cast<double>(rig.bones.size())}, {"joints", static_cast<double>(rig.joints.size())}, {"controls", static_cast<double>(rig.controls.size())}};
+    }
+
+    void RunRigBenchmarks(BenchmarkHarness &harness, const std::string &name, BenchmarkRig &rig)
+    {
+        auto counters = DescribeRig(rig);
+        auto bones = static_cast<double>(rig.bones.size());
+        {
+            IKSolver solver;
+            harness.Run(name + "/solve", [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+        }
+        {
+            IKSolver solver;
+            solver.UseConstraintBatches = true;
+            solver.UseSimdBundles = true;
+            harness.Run(name + "/solve_batched", [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+        }
+        {
+            //Early termination for the whole active set versus per island; with islands, converged limbs stop while the others keep iterating.
+            IKSolver solver;
+            solver.ConvergenceTolerance = 1e-4f;
+            harness.Run(name + "/solve_converged", [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+            solver.UseIslands = true;
+            solver.SetParallelThreadCount(1);
+            harness.Run(name + "/solve_islands", [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+        }
+        {
+            //Uncached rebuilds measure the graph traversals; cached updates measure the cost of validating the previous result.
+            ActiveSet activeSet;
+            activeSet.UseCaching = false;
+            harness.Run(name + "/update_active_set", {}, [&rig, &activeSet]() { activeSet.UpdateActiveSet(rig.controls); }, bones, counters);
+            activeSet.UseCaching = true;
+            harness.Run(name + "/update_active_set_cached", {}, [&rig, &activeSet]() { activeSet.UpdateActiveSet(rig.controls); }, bones, counters);
+        }
+        rig.ResetPose();
+    }
+
+    //Times solves that reuse effective masses for several position iterations and reports how far the result ends up from always recomputing them.
+    //The rotation threshold keeps rigs with large motions stable; without it, long chains can diverge at larger intervals.
+    void RunEffectiveMassBenchmarks(BenchmarkHarness &harness, const std::string &name, BenchmarkRig &rig)
+    {
+        auto bones = static_cast<double>(rig.bones.size());
+        auto solvePose = [&rig](IKSolver &solver) {
+            rig.ResetPose();
+            solver.Solve(rig.controls);
+            std::vector<Vector3> positions;
+            for (auto &bone : rig.bones)
+                positions.push_back(bone->Position);
+            return positions;
+        };
+        std::vector<Vector3> reference;
+        {
+            //Only one solver may hold the rig's active set at a time.
+            IKSolver solver;
+            reference = solvePose(solver);
+        }
+        for (int interval : {1, 2, 4, 8})
+        {
+            IKSolver solver;
+            solver.EffectiveMassUpdateInterval = interval;
+            solver.EffectiveMassRotationThreshold = 0.1f;
+            auto positions = solvePose(solver);
+            double deviation = 0;
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                auto offset = vector3::Subtract(positions[i], reference[i]);
+                deviation = std::max(deviation, static_cast<double>(std::sqrt(vector3::Dot(offset, offset))));
+            }
+            auto counters = DescribeRig(rig);
+            counters.push_back({"max_deviation", deviation});
+            harness.Run(name + "/solve_mass_interval_" + std::to_string(interval), [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+        }
+        rig.ResetPose();
+    }
+
+    //Compares how close Gauss-Seidel, direct tree and Jacobi solves get to a converged pose for the same iteration budgets, so convergence can be weighed against the wall clock time.
+    //The deviation is the largest distance of any bone from where a solve with many more iterations leaves it.
+    void RunConvergenceBenchmarks(BenchmarkHarness &harness, const std::string &name, BenchmarkRig &rig)
+    {
+        auto bones = static_cast<double>(rig.bones.size());
+        auto solvePose = [&rig](IKSolver &solver) {
+            rig.ResetPose();
+            solver.Solve(rig.controls);
+            std::vector<Vector3> positions;
+            for (auto &bone : rig.bones)
+                positions.push_back(bone->Position);
+            return positions;
+        };
+        std::vector<Vector3> reference;
+        {
+            //Only one solver may hold the rig's active set at a time.
+            IKSolver solver;
+            solver.ControlIterationCount = 400;
+            solver.FixerIterationCount = 200;
+            reference = solvePose(solver);
+        }
+        uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        struct Mode
+        {
+            const char *name;
+            bool coloring;
+            bool jacobi;
+            bool treeSolve;
+            uint32_t threads;
+        };
+        std::vector<Mode> modes {{"gauss_seidel", false, false, false, 1}, {"tree_direct", false, false, true, 1}, {"jacobi", false, true, false, 1}};
+        if (hardwareThreads > 1)
+        {
+            modes.push_back({"colored", true, false, false, hardwareThreads});
+            modes.push_back({"jacobi", false, true, false, hardwareThreads});
+        }
+        for (int iterations : {10, 40})
+        {
+            for (auto &mode : modes)
+            {
+                IKSolver solver;
+                solver.ControlIterationCount = iterations;
+                solver.FixerIterationCount = iterations / 2;
+                solver.UseParallelColoring = mode.coloring;
+                solver.UseJacobi = mode.jacobi;
+                solver.UseDirectTreeSolve = mode.treeSolve;
+                solver.SetParallelThreadCount(mode.threads);
+                auto positions = solvePose(solver);
+                double deviation = 0;
+                for (size_t i = 0; i < positions.size(); ++i)
+                {
+                    auto offset = vector3::Subtract(positions[i], reference[i]);
+                    deviation = std::max(deviation, static_cast<double>(std::sqrt(vector3::Dot(offset, offset))));
+                }
+                auto counters = DescribeRig(rig);
+                counters.push_back({"iterations", static_cast<double>(iterations)});
+                counters.push_back({"threads", static_cast<double>(mode.threads)});
+                counters.push_back({"max_deviation", deviation});
+                auto benchmarkName = name + "/converge_" + mode.name + "_t" + std::to_string(mode.threads) + "_i" + std::to_string(iterations);
+                harness.Run(benchmarkName, [&rig]() { rig.ResetPose(); }, [&rig, &solver]() { solver.Solve(rig.controls); }, bones, counters);
+            }
+        }
+        rig.ResetPose();
+    }
+
+    void RunCrowdBenchmarks(BenchmarkHarness &harness, int characterCount)
+    {
+        std::vector<std::unique_ptr<BenchmarkRig>> characters;
+        std::vector<std::unique_ptr<IKSolver>> solvers;
+        std::vector<IKSolveTask> tasks;
+        for (int i = 0; i < characterCount; ++i)
+        {
+            characters.push_back(bench::CreateHumanoidRig(Vector3{2.f * (i % 32), 0.f, 2.f * (i / 32)}));
+            solvers.push_back(std::make_unique<IKSolver>());
+        }
+        for (int i = 0; i < characterCount; ++i)
+            tasks.push_back({solvers[i].get(), &characters[i]->controls, nullptr});
+        std::vector<std::pair<std::string, double>> counters {{"characters", static_cast<double>(characterCount)},
+            {"bones", static_cast<double>(characters.front()->bones.size() * characterCount)},
+            {"joints", static_cast<double>(characters.front()->joints.size() * characterCount)}};
+        auto resetPoses = [&characters]() {
+            for (auto &character : characters)
+                character->ResetPose();
+        };
+
+        harness.Run("crowd/solve_sequential", resetPoses, [&tasks]() {
+            for (auto &task : tasks)
+                task.solver->Solve(*task.controls);
+        }, characterCount, counters);
+
+        IKSolverPool pool;
+        counters.push_back({"threads", static_cast<double>(pool.GetThreadCount())});
+        harness.Run("crowd/solve_pool", resetPoses, [&tasks, &pool]() { pool.Solve(tasks); }, characterCount, counters);
+        counters.pop_back();
+
+        //The same crowd as instances of one template, solved one after another in a single workspace.
+        auto &first = *characters.front();
+        std::vector<Bone*> templateBones;
+        for (auto &bone : first.bones)
+            templateBones.push_back(bone.get());
+        IKRigTemplate rigTemplate(templateBones, first.jointPointers, first.controls);
+        std::vector<IKRigInstance> restInstances;
+        for (auto &character : characters)
+        {
+            auto &instance = restInstances.emplace_back(rigTemplate);
+            for (size_t i = 0; i < character->bones.size(); ++i)
+                instance.Positions[i] = character->bones[i]->Position;
+            for (size_t i = 0; i < character->controls.size(); ++i)
+            {
+                if (auto *motor = character->controls[i]->GetLinearMotor())
+                    instance.Goals[i].position = motor->TargetPosition;
+            }
+        }
+        auto instances = restInstances;
+        IKRigWorkspace workspace(rigTemplate);
+        harness.Run("crowd/solve_instanced", [&instances, &restInstances]() { instances = restInstances; }, [&instances, &workspace]() {
+            for (auto &instance : instances)
+                workspace.Solve(instance);
+        }, characterCount, counters);
+
+        //The same instances packed into the lanes of the bundle kernels, eight characters per solve.
+        std::vector<IKRigInstance*> instancePointers;
+        for (auto &instance : instances)
+            instancePointers.push_back(&instance);
+        harness.Run("crowd/solve_instanced_lanes", [&instances, &restInstances]() { instances = restInstances; }, [&instancePointers, &workspace]() {
+            workspace.Solve(instancePointers);
+        }, characterCount, counters);
+    }
+
+    //Times building and tearing down a limited chain with individually allocated objects and with an IKRig.
+    void RunRigSetupBenchmarks(BenchmarkHarness &harness, int boneCount)
+    {
+        std::vector<std::pair<std::string, double>> counters {{"bones", static_cast<double>(boneCount)}};
+        Vector3 up {0.f, 1.f, 0.f};
+        harness.Run("rig_setup/heap", {}, [&]() {
+            std::vector<std::unique_ptr<Bone>> bones;
+            std::vector<std::unique_ptr<IKJoint>> joints;
+            for (int i = 0; i < boneCount; ++i)
+                bones.push_back(std::make_unique<Bone>(Vector3{0.f, static_cast<float>(i), 0.f}, quat_identity, 0.2f, 1.f));
+            for (int i = 0; i + 1 < boneCount; ++i)
+            {
+                joints.push_back(std::make_unique<IKBallSocketJoint>(*bones[i], *bones[i + 1], Vector3{0.f, i + 0.5f, 0.f}));
+                joints.push_back(std::make_unique<IKSwingLimit>(*bones[i], *bones[i + 1], up, up, 0.8f));
+                joints.push_back(std::make_unique<IKTwistLimit>(*bones[i], *bones[i + 1], up, up, 0.3f));
+            }
+            auto control = std::make_unique<DragControl>();
+            control->SetTargetBone(bones.back().get());
+        }, boneCount, counters);
+        IKRig rig;
+        harness.Run("rig_setup/arena", {}, [&]() {
+            Bone *previous = nullptr;
+            for (int i = 0; i < boneCount; ++i)
+            {
+                auto &bone = rig.Create<Bone>(Vector3{0.f, static_cast<float>(i), 0.f}, quat_identity, 0.2f, 1.f);
+                if (previous)
+                {
+                    rig.Create<IKBallSocketJoint>(*previous, bone, Vector3{0.f, i - 0.5f, 0.f});
+                    rig.Create<IKSwingLimit>(*previous, bone, up, up, 0.8f);
+                    rig.Create<IKTwistLimit>(*previous, bone, up, up, 0.3f);
+                }
+                previous = &bone;
+            }
+            rig.Create<DragControl>().SetTargetBone(previous);
+            rig.Clear();
+        }, boneCount, counters);
+    }
+
+    //Times reconstructing a humanoid in code against loading it from the binary rig format, which views the descriptions in place.
+    void RunRigLoadBenchmarks(BenchmarkHarness &harness)
+    {
+        auto humanoid = bench::CreateHumanoidRig();
+        std::vector<Bone*> bones;
+        for (auto &bone : humanoid->bones)
+            bones.push_back(bone.get());
+        std::ostringstream stream;
+        IKRigFile::Write(IKRigTemplate(bones, humanoid->jointPointers, humanoid->controls), stream);
+        auto contents = stream.str();
+        //Stands in for a mapped file, which is page aligned.
+        struct alignas(16) Chunk { std::byte bytes[16]; };
+        std::vector<Chunk> buffer((contents.size() + sizeof(Chunk) - 1) / sizeof(Chunk));
+        std::memcpy(buffer.data(), contents.data(), contents.size());
+        std::span<const std::byte> data(reinterpret_cast<const std::byte*>(buffer.data()), contents.size());
+
+        std::vector<std::pair<std::string, double>> counters {{"bones", static_cast<double>(bones.size())}, {"joints", static_cast<double>(humanoid->joints.size())}};
+        harness.Run("rig_load/construct", {}, []() { bench::CreateHumanoidRig(); }, 1, counters);
+        harness.Run("rig_load/file", {}, [&data]() { IKRigFile file(data); }, 1, counters);
+    }
+
+    using JointFactory = std::function<std::unique_ptr<IKJoint>(Bone&, Bone&)>;
+
+    //Times each per-joint solver stage over a chain of joints of a single type.
+    void RunKernelBenchmarks(BenchmarkHarness &harness, const std::string &name, const JointFactory &createJoint)
+    {
+        constexpr int boneCount = 256;
+        BenchmarkRig rig;
+        for (int i = 0; i < boneCount; ++i)
+        {
+            //Bend the chain a little so the jacobians are not trivially axis aligned and the limits are violated.
+            Vector3 start {0.1f * std::sin(0.3f * i), static_cast<float>(i), 0.1f * std::cos(0.5f * i)};
+            Vector3 end {0.1f * std::sin(0.3f * (i + 1)), static_cast<float>(i + 1), 0.1f * std::cos(0.5f * (i + 1))};
+            rig.AddBone(start, end, 0.2f);
+        }
+        rig.bones.front()->SetPinned(true);
+        for (int i = 0; i + 1 < boneCount; ++i)
+        {
+            auto joint = createJoint(*rig.bones[i], *rig.bones[i + 1]);
+            rig.jointPointers.push_back(joint.get());
+            rig.joints.push_back(std::move(joint));
+        }
+        rig.AddDrag(*rig.bones.back(), rig.bones.back()->Position);
+
+        ActiveSet activeSet;
+        activeSet.UpdateActiveSet(rig.controls);
+        auto &joints = activeSet.joints;
+        auto &store = activeSet.boneStore;
+        for (auto *joint : joints)
+        {
+            joint->Preupdate(1.f, 1.f);
+            joint->UpdateJacobiansAndVelocityBias();
+            joint->ComputeEffectiveMass();
+        }
+        auto resetVelocities = [&store, &joints]() {
+            std::fill(store.linearVelocities.begin(), store.linearVelocities.end(), vector3::Zero);
+            std::fill(store.angularVelocities.begin(), store.angularVelocities.end(), vector3::Zero);
+            for (auto *joint : joints)
+                joint->ClearAccumulatedImpulses();
+        };
+        auto jointCount = static_cast<double>(joints.size());
+        std::vector<std::pair<std::string, double>> counters {{"joints", jointCount}, {"degrees_of_freedom", static_cast<double>(joints.front()->GetDegreesOfFreedom())}};
+        auto prefix = "kernel/" + name;
+
+        harness.Run(prefix + "/update_jacobians", {}, [&joints]() {
+            for (auto *joint : joints)
+                joint->UpdateJacobiansAndVelocityBias();
+        }, jointCount, counters);
+        harness.Run(prefix + "/compute_effective_mass", {}, [&joints]() {
+            for (auto *joint : joints)
+                joint->ComputeEffectiveMass();
+        }, jointCount, counters);
+        harness.Run(prefix + "/warm_start", resetVelocities, [&joints]() {
+            for (auto *joint : joints)
+                joint->WarmStart();
+        }, jointCount, counters);
+        harness.Run(prefix + "/solve_velocity", resetVelocities, [&joints]() {
+            for (auto *joint : joints)
+                joint->SolveVelocityIteration();
+        }, jointCount, counters);
+    }
+
+    void RunAllKernelBenchmarks(BenchmarkHarness &harness)
+    {
+        const Vector3 up {0.f, 1.f, 0.f};
+        const Vector3 right {1.f, 0.f, 0.f};
+        auto anchor = [](Bone &a, Bone &b) { return vector3::Multiply(vector3::Add(a.Position, b.Position), 0.5f); };
+        RunKernelBenchmarks(harness, "ball_socket", [&](Bone &a, Bone &b) { return std::make_unique<IKBallSocketJoint>(a, b, anchor(a, b)); });
+        RunKernelBenchmarks(harness, "angular", [&](Bone &a, Bone &b) { return std::make_unique<IKAngularJoint>(a, b); });
+        RunKernelBenchmarks(harness, "revolute", [&](Bone &a, Bone &b) { return std::make_unique<IKRevoluteJoint>(a, b, right); });
+        RunKernelBenchmarks(harness, "swivel_hinge", [&](Bone &a, Bone &b) { return std::make_unique<IKSwivelHingeJoint>(a, b, right, up); });
+        RunKernelBenchmarks(harness, "twist", [&](Bone &a, Bone &b) { return std::make_unique<IKTwistJoint>(a, b, up, up); });
+        RunKernelBenchmarks(harness, "distance", [&](Bone &a, Bone &b) { return std::make_unique<IKDistanceJoint>(a, b, a.Position, b.Position); });
+        RunKernelBenchmarks(harness, "point_on_line", [&](Bone &a, Bone &b) { return std::make_unique<IKPointOnLineJoint>(a, b, anchor(a, b), up, b.Position); });
+        RunKernelBenchmarks(harness, "point_on_plane", [&](Bone &a, Bone &b) { return std::make_unique<IKPointOnPlaneJoint>(a, b, anchor(a, b), right, b.Position); });
+        RunKernelBenchmarks(harness, "distance_limit", [&](Bone &a, Bone &b) { return std::make_unique<IKDistanceLimit>(a, b, a.Position, b.Position, 0.5f, 0.9f); });
+        RunKernelBenchmarks(harness, "linear_axis_limit", [&](Bone &a, Bone &b) { return std::make_unique<IKLinearAxisLimit>(a, b, anchor(a, b), up, b.Position, 0.1f, 0.4f); });
+        RunKernelBenchmarks(harness, "swing_limit", [&](Bone &a, Bone &b) { return std::make_unique<IKSwingLimit>(a, b, up, up, 0.05f); });
+        RunKernelBenchmarks(harness, "ellipse_swing_limit", [&](Bone &a, Bone &b) { return std::make_unique<IKEllipseSwingLimit>(a, b, up, up, 0.05f, 0.1f); });
+        RunKernelBenchmarks(harness, "twist_limit", [&](Bone &a, Bone &b) { return std::make_unique<IKTwistLimit>(a, b, up, up, 0.05f); });
+    }
+
+    bool ParseArgument(const char *argument, const char *option, std::string &value)
+    {
+        auto length = std::strlen(option);
+        if (std::strncmp(argument, option, length) != 0 || argument[length] != '=')
+            return false;
+        value = argument + length + 1;
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkHarness harness;
+    std::string outputPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string value;
+        if (ParseArgument(argv[i], "--filter", value))
+            harness.Filter = value;
+        else if (ParseArgument(argv[i], "--min-time", value))
+            harness.MinimumTime = std::atof(value.c_str());
+        else if (ParseArgument(argv[i], "--out", value))
+            outputPath = value;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--filter=<substring>] [--min-time=<seconds>] [--out=<file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    {
+        auto humanoid = bench::CreateHumanoidRig();
+        RunRigBenchmarks(harness, "humanoid", *humanoid);
+        RunEffectiveMassBenchmarks(harness, "humanoid", *humanoid);
+        RunConvergenceBenchmarks(harness, "humanoid", *humanoid);
+        auto chain = bench::CreateChainRig(256);
+        RunRigBenchmarks(harness, "chain", *chain);
+        RunEffectiveMassBenchmarks(harness, "chain", *chain);
+        RunConvergenceBenchmarks(harness, "chain", *chain);
+        auto tree = bench::CreateTreeRig(7);
+        RunRigBenchmarks(harness, "tree", *tree);
+        RunConvergenceBenchmarks(harness, "tree", *tree);
+        auto graph = bench::CreateCyclicGraphRig(12, 12);
+        RunRigBenchmarks(harness, "cyclic_graph", *graph);
+    }
+    RunCrowdBenchmarks(harness, 1000);
+    RunRigSetupBenchmarks(harness, 64);
+    RunRigLoadBenchmarks(harness);
+    RunAllKernelBenchmarks(harness);
+
+    harness.WriteTable(std::cerr);
+    if (outputPath.empty())
+        harness.WriteJson(std::cout);
+    else
+    {
+        std::ofstream file(outputPath);
+        if (!file)
+        {
+            fprintf(stderr, "Failed to open %s for writing.\n", outputPath.c_str());
+            return 1;
+        }
+        harness.WriteJson(file);
+    }
+    return 0;
+}
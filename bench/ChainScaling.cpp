@@ -0,0 +1,59 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/ActiveSet.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/control/DragControl.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+//Measures the cost of rebuilding the active set of a single pinned chain dragged by its tip.
+//The traversals are linear in the number of bones, so the time per bone should stay flat as the chain grows.
+int main()
+{
+    using namespace BEPUik;
+    printf("%8s %12s %12s\n", "bones", "update (us)", "ns/bone");
+    for (int boneCount = 100; boneCount <= 25600; boneCount *= 2)
+    {
+        std::vector<std::unique_ptr<Bone>> bones;
+        std::vector<std::unique_ptr<IKJoint>> joints;
+        for (int i = 0; i < boneCount; ++i)
+            bones.push_back(std::make_unique<Bone>(Vector3{0.f, static_cast<float>(i), 0.f}, Quaternion{1.f, 0.f, 0.f, 0.f}, 0.2f, 1.f));
+        bones.front()->SetPinned(true);
+        for (int i = 0; i + 1 < boneCount; ++i)
+        {
+            joints.push_back(std::make_unique<IKBallSocketJoint>(*bones[i], *bones[i + 1], Vector3{0.f, i + 0.5f, 0.f}));
+            joints.push_back(std::make_unique<IKSwingLimit>(*bones[i], *bones[i + 1], Vector3{0.f, 1.f, 0.f}, Vector3{0.f, 1.f, 0.f}, 0.8f));
+        }
+        DragControl control;
+        control.SetTargetBone(bones.back().get());
+        std::vector<Control*> controls{&control};
+
+        ActiveSet activeSet;
+        activeSet.UseCaching = false;
+        //Warm up the scratch buffers so the measurement doesn't include their first allocation.
+        activeSet.UpdateActiveSet(controls);
+        int repetitions = std::max(1, 200000 / boneCount);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; ++i)
+            activeSet.UpdateActiveSet(controls);
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+        printf("%8d %12.1f %12.2f\n", boneCount, seconds * 1e6, seconds * 1e9 / boneCount);
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BenchmarkRigs.hpp"
+#include "bepuik/IKSolver.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+
+//Replays a scripted animation on a set of rigs and prints a hash of the final bone transforms for each solver configuration.
+//Usage: bench_deterministic_replay [--reference=<file>]
+//Save the output on one platform and pass it as the reference on another to check that both produce bit-identical poses.
+//Configurations which must agree on any machine, such as the different SIMD levels and thread counts, are also compared against each other.
+//The process exits with a nonzero code on any mismatch. Build with CPPBEPUIK_DETERMINISTIC for results that are expected to match across platforms.
+namespace
+{
+    using namespace BEPUik;
+    using bench::BenchmarkRig;
+
+    constexpr int FrameCount = 60;
+
+    //FNV-1a over the bit patterns of the bone positions and orientations.
+    struct PoseHash
+    {
+        uint64_t value = 14695981039346656037ull;
+
+        void Add(float f)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            for (int i = 0; i < 4; ++i)
+            {
+                value ^= (bits >> (8 * i)) & 0xff;
+                value *= 1099511628211ull;
+            }
+        }
+    };
+
+    //Each configuration replays the scenario on freshly built rigs so that no state carries over between configurations.
+    uint64_t Replay(const std::function<void(IKSolver&)> &configure)
+    {
+        std::vector<std::unique_ptr<BenchmarkRig>> rigs;
+        rigs.push_back(bench::CreateHumanoidRig());
+        rigs.push_back(bench::CreateChainRig(32));
+        rigs.push_back(bench::CreateTreeRig(5));
+        rigs.push_back(bench::CreateCyclicGraphRig(6, 6));
+
+        IKSolver solver;
+        configure(solver);
+        for (auto &rig : rigs)
+        {
+            std::vector<Vector3> initialTargets;
+            for (auto *control : rig->controls)
+                initialTargets.push_back(control->GetLinearMotor() ? control->GetLinearMotor()->TargetPosition : Vector3{});
+            for (int frame = 0; frame < FrameCount; ++frame)
+            {
+                //Move the targets along triangle waves. The script only uses basic arithmetic so that it is reproducible as well.
+                auto phase = static_cast<float>(frame % 20) / 20.f;
+                auto wave = phase < 0.5f ? 2.f * phase : 2.f - 2.f * phase;
+                for (size_t i = 0; i < rig->controls.size(); ++i)
+                {
+                    auto *motor = rig->controls[i]->GetLinearMotor();
+                    if (!motor)
+                        continue;
+                    auto scale = 0.1f * static_cast<float>(i % 3 + 1);
+                    motor->TargetPosition = vector3::Add(initialTargets[i], Vector3{scale * wave, -scale * wave, 0.01f * frame});
+                }
+                solver.Solve(rig->controls);
+            }
+        }
+
+        PoseHash hash;
+        for (auto &rig : rigs)
+        {
+            for (auto &bone : rig->bones)
+            {
+                hash.Add(bone->Position.x);
+                hash.Add(bone->Position.y);
+                hash.Add(bone->Position.z);
+                hash.Add(bone->Orientation.x);
+                hash.Add(bone->Orientation.y);
+                hash.Add(bone->Orientation.z);
+                hash.Add(bone->Orientation.w);
+            }
+        }
+        return hash.value;
+    }
+
+    //Replays every variant of a configuration and fails if they disagree. Returns the hash of the first variant.
+    bool ReplayVariants(const std::string &name, const std::vector<std::pair<std::string, std::function<void(IKSolver&)>>> &variants, std::map<std::string, uint64_t> &hashes)
+    {
+        bool consistent = true;
+        uint64_t expected = 0;
+        for (size_t i = 0; i < variants.size(); ++i)
+        {
+            auto hash = Replay(variants[i].second);
+            if (i == 0)
+                expected = hash;
+            else if (hash != expected)
+            {
+                fprintf(stderr, "%s: %s produced %016" PRIx64 ", expected %016" PRIx64 " from %s\n", name.c_str(), variants[i].first.c_str(), hash, expected, variants.front().first.c_str());
+                consistent = false;
+            }
+        }
+        hashes[name] = expected;
+        return consistent;
+    }
+
+    bool ReadReference(const std::string &path, std::map<std::string, uint64_t> &hashes)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            //Lines starting with '#' are comments.
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream stream(line);
+            std::string name, hash;
+            if (stream >> name >> hash)
+                hashes[name] = std::stoull(hash, nullptr, 16);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string referencePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--reference=", 12) == 0)
+            referencePath = argv[i] + 12;
+        else
+        {
+            fprintf(stderr, "Usage: %s [--reference=<file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bool success = true;
+    std::map<std::string, uint64_t> hashes;
+    success &= ReplayVariants("sequential", {{"default", [](IKSolver&) {}}}, hashes);
+    success &= ReplayVariants("batched", {{"default", [](IKSolver &solver) { solver.UseConstraintBatches = true; }}}, hashes);
+
+    //The bundle kernels of every instruction set must match the scalar fallback lane for lane.
+    std::vector<std::pair<std::string, std::function<void(IKSolver&)>>> bundleVariants;
+    for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(GetSupportedSimdLevel()); ++level)
+    {
+        bundleVariants.push_back({"simd level " + std::to_string(level), [level](IKSolver &solver) {
+            solver.UseConstraintBatches = true;
+            solver.UseSimdBundles = true;
+            solver.MaximumSimdLevel = static_cast<SimdLevel>(level);
+        }});
+    }
+    success &= ReplayVariants("bundled", bundleVariants, hashes);
+
+    //The joints of a color share no integrated bones, so the thread count must not affect the result.
+    std::vector<std::pair<std::string, std::function<void(IKSolver&)>>> coloredVariants;
+    for (uint32_t threadCount : {1u, 2u, 4u})
+    {
+        coloredVariants.push_back({std::to_string(threadCount) + " threads", [threadCount](IKSolver &solver) {
+            solver.UseParallelColoring = true;
+            solver.SetParallelThreadCount(threadCount);
+        }});
+    }
+    success &= ReplayVariants("colored", coloredVariants, hashes);
+
+    //Islands share no moving bones, so neither may the islands' thread count.
+    std::vector<std::pair<std::string, std::function<void(IKSolver&)>>> islandVariants;
+    for (uint32_t threadCount : {1u, 2u, 4u})
+    {
+        islandVariants.push_back({std::to_string(threadCount) + " threads", [threadCount](IKSolver &solver) {
+            solver.UseIslands = true;
+            solver.SetParallelThreadCount(threadCount);
+        }});
+    }
+    success &= ReplayVariants("islands", islandVariants, hashes);
+
+    //Jacobi iterations gather the impulses of every bone in a fixed order, whichever thread computed them.
+    std::vector<std::pair<std::string, std::function<void(IKSolver&)>>> jacobiVariants;
+    for (uint32_t threadCount : {1u, 2u, 4u})
+    {
+        jacobiVariants.push_back({std::to_string(threadCount) + " threads", [threadCount](IKSolver &solver) {
+            solver.UseJacobi = true;
+            solver.SetParallelThreadCount(threadCount);
+        }});
+    }
+    success &= ReplayVariants("jacobi", jacobiVariants, hashes);
+
+    success &= ReplayVariants("tree_direct", {{"default", [](IKSolver &solver) { solver.UseDirectTreeSolve = true; }}}, hashes);
+
+    success &= ReplayVariants("presolved", {{"default", [](IKSolver &solver) { solver.UseTwoBonePresolve = true; }}}, hashes);
+
+    for (auto &[name, hash] : hashes)
+        printf("%s %016" PRIx64 "\n", name.c_str(), hash);
+
+    if (!referencePath.empty())
+    {
+        std::map<std::string, uint64_t> reference;
+        if (!ReadReference(referencePath, reference))
+        {
+            fprintf(stderr, "Failed to read %s\n", referencePath.c_str());
+            return 1;
+        }
+        for (auto &[name, hash] : reference)
+        {
+            auto it = hashes.find(name);
+            if (it == hashes.end() || it->second != hash)
+            {
+                fprintf(stderr, "%s differs from the reference\n", name.c_str());
+                success = false;
+            }
+        }
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/ActiveSet.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/control/DragControl.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+//Measures the cost of a single IKJoint::SolveVelocityIteration call for joints removing three, two and one degrees of freedom.
+//This is the innermost loop of the solver and is dominated by the 3x3 matrix and vector helpers in bepuik/math.hpp.
+namespace
+{
+    using namespace BEPUik;
+    using JointFactory = std::function<std::unique_ptr<IKJoint>(Bone&, Bone&, const Vector3&)>;
+
+    double MeasureNanosecondsPerIteration(const JointFactory &createJoint)
+    {
+        constexpr int boneCount = 256;
+        constexpr int subiterations = 16;
+        constexpr int repetitions = 2000;
+        std::vector<std::unique_ptr<Bone>> bones;
+        std::vector<std::unique_ptr<IKJoint>> joints;
+        for (int i = 0; i < boneCount; ++i)
+        {
+            //Twist and offset the bones a little so the jacobians are not trivially axis aligned.
+            Vector3 axis {0.3f, 1.f, 0.2f};
+            vector3::Normalize(axis);
+            auto halfAngle = 0.05f * i;
+            axis = vector3::Multiply(axis, std::sin(halfAngle));
+            auto orientation = quaternion::Create(axis.x, axis.y, axis.z, std::cos(halfAngle));
+            bones.push_back(std::make_unique<Bone>(Vector3{0.05f * (i % 3), static_cast<float>(i), 0.f}, orientation, 0.2f, 1.f));
+        }
+        bones.front()->SetPinned(true);
+        for (int i = 0; i + 1 < boneCount; ++i)
+            joints.push_back(createJoint(*bones[i], *bones[i + 1], Vector3{0.f, i + 0.5f, 0.f}));
+        DragControl control;
+        control.SetTargetBone(bones.back().get());
+        std::vector<Control*> controls{&control};
+
+        ActiveSet activeSet;
+        activeSet.UpdateActiveSet(controls);
+        auto &store = activeSet.boneStore;
+        for (auto *joint : activeSet.joints)
+        {
+            joint->Preupdate(1.f, 1.f);
+            joint->UpdateJacobiansAndVelocityBias();
+            joint->ComputeEffectiveMass();
+        }
+
+        std::chrono::steady_clock::duration elapsed {};
+        for (int repetition = 0; repetition < repetitions; ++repetition)
+        {
+            //Start every repetition from rest so the iterations keep doing the same amount of work.
+            std::fill(store.linearVelocities.begin(), store.linearVelocities.end(), Vector3{0.f, 0.f, 0.f});
+            std::fill(store.angularVelocities.begin(), store.angularVelocities.end(), Vector3{0.f, 0.f, 0.f});
+            for (auto *joint : activeSet.joints)
+                joint->ClearAccumulatedImpulses();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < subiterations; ++i)
+            {
+                for (auto *joint : activeSet.joints)
+                    joint->SolveVelocityIteration();
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+        auto iterations = static_cast<double>(repetitions) * subiterations * activeSet.joints.size();
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+}
+
+int main()
+{
+    printf("%-16s %6s %16s\n", "joint", "dofs", "ns/iteration");
+    auto report = [](const char *name, int degreesOfFreedom, const JointFactory &createJoint) {
+        printf("%-16s %6d %16.2f\n", name, degreesOfFreedom, MeasureNanosecondsPerIteration(createJoint));
+    };
+    report("ball socket", 3, [](Bone &a, Bone &b, const Vector3 &anchor) -> std::unique_ptr<IKJoint> {
+        return std::make_unique<IKBallSocketJoint>(a, b, anchor);
+    });
+    report("revolute", 2, [](Bone &a, Bone &b, const Vector3 &) -> std::unique_ptr<IKJoint> {
+        return std::make_unique<IKRevoluteJoint>(a, b, Vector3{1.f, 0.f, 0.f});
+    });
+    report("swing limit", 1, [](Bone &a, Bone &b, const Vector3 &) -> std::unique_ptr<IKJoint> {
+        return std::make_unique<IKSwingLimit>(a, b, Vector3{0.f, 1.f, 0.f}, Vector3{0.f, 1.f, 0.f}, 0.05f);
+    });
+    return 0;
+}
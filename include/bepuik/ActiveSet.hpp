@@ -16,13 +16,80 @@
 #pragma once
 
 #include <vector>
-#include <queue>
 #include "bepuik/joint/IKJoint.hpp"
 #include "bepuik/Bone.hpp"
 #include "bepuik/control/Control.hpp"
 
 namespace BEPUik
 {
+    /// <summary>
+    /// Temporary storage used while traversing the bone-joint graph.
+    /// It holds no state between active set updates, so it can be shared by any number of active sets that are not updated concurrently.
+    /// </summary>
+    struct ActiveSetScratch
+    {
+        //Stores data about an in-process BFS. Bones before bonesToVisitStart have already been visited.
+        std::vector<Bone*> bonesToVisit;
+        size_t bonesToVisitStart = 0;
+        std::vector<Bone*> uniqueChildren;
+
+        /// <summary>
+        /// Frame of one of the depth first traversals, which run on an explicit stack so that long chains can't overflow the call stack.
+        /// </summary>
+        struct TraversalFrame
+        {
+            Bone *bone;
+            size_t jointIndex;
+            float massPerChild;
+        };
+        std::vector<TraversalFrame> traversalStack;
+        std::vector<Bone*> notificationStack;
+
+        /// <summary>
+        /// Predecessor lists of the traversed bones as singly linked lists, headed by Bone::firstPredecessor.
+        /// </summary>
+        struct PredecessorLink
+        {
+            Bone *bone;
+            uint32_t next;
+        };
+        std::vector<PredecessorLink> predecessorLinks;
+
+        /// <summary>
+        /// Open addressing hash set of the predecessor links of bones whose lists are too long to scan.
+        /// Entries from earlier traversals are invalidated by bumping the generation instead of clearing the table.
+        /// </summary>
+        struct InteractionEntry
+        {
+            const Bone *bone = nullptr;
+            const Bone *predecessor = nullptr;
+            uint32_t generation = 0;
+        };
+        std::vector<InteractionEntry> interactions;
+        size_t interactionCount = 0;
+        uint32_t interactionGeneration = 1;
+
+        //Union-find parents of the integrated bones while the islands are built.
+        std::vector<uint32_t> islandParents;
+    };
+
+    /// <summary>
+    /// Part of the active set that can be solved independently of the rest.
+    /// Pinned bones transfer no motion, so they bound islands; a joint attached to a pinned bone belongs to the island of its other bone.
+    /// </summary>
+    struct ActiveIsland
+    {
+        /// <summary>
+        /// Indices of the island's joints in ActiveSet::joints, in active set order.
+        /// </summary>
+        std::vector<uint32_t> joints;
+
+        /// <summary>
+        /// Handles of the island's moving bones in the bone store.
+        /// </summary>
+        std::vector<BoneHandle> bones;
+    };
+
     /// <summary>
     /// Manages the subset of joints which potentially need solving.
     /// The active joint set contains connected components in the joint-bone graph which interact with control constraints.
@@ -38,6 +105,23 @@ namespace BEPUik
 		
         std::vector<Bone*> bones;
 
+        /// <summary>
+        /// Packed solver state of the active bones, followed by the pinned bones bordering the active set.
+        /// The handles of the active bones match their indices in the bones list.
+        /// </summary>
+        BoneStore boneStore;
+
+        /// <summary>
+        /// Islands of the active set, ordered by their first bone in the bone store. Rebuilt together with the active set.
+        /// </summary>
+        std::vector<ActiveIsland> islands;
+
+        /// <summary>
+        /// Index of the island of each integrated bone, indexed by handle. Pinned bones belong to no island.
+        /// </summary>
+        std::vector<uint32_t> boneIslands;
+        static constexpr uint32_t NoIsland = ~0u;
+
         /// <summary>
         /// Gets or sets whether or not to automatically configure the masses of bones in the active set based upon their dependencies.
         /// Enabling this makes the solver more responsive and avoids some potential instability.
@@ -59,6 +143,27 @@ namespace BEPUik
         /// </summary>
         void SetAutomassTarget(float value);
 		
+        /// <summary>
+        /// Gets or sets whether or not the active set is kept between updates when nothing it depends on has changed.
+        /// A cached set is reused as long as the input joints or controls, the controlled bones, the automass settings and the
+        /// topology versions of the bones in the set are unchanged; only the bone store is refreshed from the bones in that case.
+        /// Caching is off by default: assigning Bone::Pinned directly or rebuilding a rig at reused addresses is not detected,
+        /// so callers that enable it must call Invalidate() after such changes.
+        /// </summary>
+        bool UseCaching = false;
+
+        /// <summary>
+        /// Forces the next update to rebuild the active set, e.g. after modifying the bone-joint graph without going through
+        /// Bone::SetPinned or IKJoint::SetEnabled, or after changing the masses of active bones while automass is enabled.
+        /// </summary>
+        void Invalidate();
+
+        /// <summary>
+        /// Gets a counter which is incremented every time the active set is rebuilt.
+        /// Data derived from the active set only has to be rebuilt when this changes.
+        /// </summary>
+        uint64_t GetVersion() const;
+
         void UpdateActiveSet(std::vector<IKJoint*> &joints);
 
         /// <summary>
@@ -71,12 +176,43 @@ namespace BEPUik
         /// <param name="controls">Currently active control constraints.</param>
         void UpdateActiveSet(std::vector<Control*> &controls);
 
+        /// <summary>
+        /// Sets the scratch storage used by the graph traversals, e.g. a per-thread scratch owned by a solver pool.
+        /// Passing nullptr reverts to the active set's own scratch.
+        /// </summary>
+        void SetScratch(ActiveSetScratch *scratch);
+
         ~ActiveSet();
 	private:
-        //Stores data aban in-process BFS.
-        std::queue<Bone*> bonesToVisit;
+        ActiveSetScratch m_ownScratch;
+        ActiveSetScratch *m_scratch = &m_ownScratch;
+
+        //Inputs of the last rebuild, used to decide whether the cached active set is still valid.
+        enum class CachedSource : uint8_t { None, Joints, Controls };
+        CachedSource m_cachedSource = CachedSource::None;
+        std::vector<IKJoint*> m_cachedJoints;
+        std::vector<bool> m_cachedJointsEnabled;
+        std::vector<Control*> m_cachedControls;
+        std::vector<Bone*> m_cachedTargetBones;
+        std::vector<uint32_t> m_cachedBoneVersions;
+        bool m_cachedUseAutomass = false;
+        float m_cachedAutomassUnstressedFalloff = 0;
+        float m_cachedAutomassTarget = 0;
+        uint64_t m_version = 0;
+
+        bool IsCacheValid(CachedSource source) const;
+        bool IsCacheValid(const std::vector<IKJoint*> &joints) const;
+        bool IsCacheValid(const std::vector<Control*> &controls) const;
+        void CacheInputs(CachedSource source);
+
+        //Predecessor lists up to this length are scanned; longer ones are looked up in the scratch hash set.
+        static constexpr uint32_t MaximumScannedPredecessors = 4;
 
 		bool BonesHaveInteracted(Bone* bone, Bone* childBone);
+        bool HasPredecessor(const Bone *bone, const Bone *predecessor) const;
+        void AddInteraction(const Bone *bone, const Bone *predecessor);
+        void AddPredecessor(Bone *bone, Bone *predecessor);
+        void ClearPredecessors();
         void FindStressedPaths(std::vector<Control*> &controls);
 
         void NotifyPredecessorsOfStress(Bone *bone);
@@ -86,11 +222,21 @@ namespace BEPUik
 
         void FindCycles(Bone *bone);
 
-        std::vector<Bone*> uniqueChildren;
+        float ComputeMassPerChild(Bone *bone);
         void DistributeMass(Bone *bone);
 
         void DistributeMass(std::vector<Control*> &controls);
 
+        /// <summary>
+        /// Fills the bone store with the active bones and any pinned bones referenced by the active joints, then binds the joints to it.
+        /// </summary>
+        void UpdateBoneStore();
+
+        /// <summary>
+        /// Splits the active joints and bones into islands connected through moving bones.
+        /// </summary>
+        void BuildIslands();
+
         /// <summary>
         /// Clears the bone and joint listings and unsets all flags.
         /// </summary>
@@ -16,7 +16,9 @@
 #pragma once
 
 #include "bepuik/math.hpp"
+#include "bepuik/BoneStore.hpp"
 #include <vector>
+#include <limits>
 
 namespace BEPUik
 {
@@ -43,17 +45,15 @@ namespace BEPUik
         Quaternion Orientation = quat_identity;
 
         /// <summary>
-        /// The mid-iteration angular velocity associated with the bone.
-        /// This is computed during the velocity subiterations and then applied to the orientation at the end of each position iteration.
+        /// Gets the store holding the solver state of the bone, or nullptr if the bone is not part of an active set.
+        /// The mid-iteration velocities and world inertia tensor of the bone live in the store.
         /// </summary>
-        Vector3 angularVelocity;
+        BoneStore *store = nullptr;
 
         /// <summary>
-        /// The mid-iteration linear velocity associated with the bone.
-        /// This is computed during the velocity subiterations and then applied to the position at the end of each position iteration.
+        /// Gets the handle of the bone within its store.
         /// </summary>
-        Vector3 linearVelocity;
-
+        BoneHandle handle = InvalidBoneHandle;
 
         float inverseMass;
 
@@ -65,7 +65,6 @@ namespace BEPUik
 		float GetMass() const;
 		void SetMass(float mass);
 
-        Matrix3x3 inertiaTensorInverse;
         Matrix3x3 localInertiaTensorInverse;
 
         /// <summary>
@@ -81,6 +80,7 @@ namespace BEPUik
 
         /// <summary>
         /// Gets or sets whether or not this bone is pinned. Pinned bones cannot be moved by constraints.
+        /// Change it through SetPinned so that cached active sets notice the change.
         /// </summary>
 		bool Pinned = false;
 		bool GetPinned() const;
@@ -93,6 +93,12 @@ namespace BEPUik
 		bool IsActive() const;
 		void SetActive(bool value);
 
+        /// <summary>
+        /// Incremented whenever the bone is pinned or unpinned, or a joint connected to it is enabled or disabled.
+        /// Active sets compare it against the value seen during their last rebuild to decide whether their cached result is still valid.
+        /// </summary>
+        uint32_t topologyVersion = 0;
+
         float radius;
         /// <summary>
         /// Gets or sets the radius of the bone.
@@ -142,47 +148,36 @@ namespace BEPUik
 
         void ComputeLocalInertiaTensor();
 
-        /// <summary>
-        /// Updates the world inertia tensor based upon the local inertia tensor and current orientation.
-        /// </summary>
-        void UpdateInertiaTensor();
-
-        /// <summary>
-        /// Integrates the position and orientation of the bone forward based upon the current linear and angular velocity.
-        /// </summary>
-        void UpdatePosition();
-
-        void ApplyLinearImpulse(Vector3 &impulse);
-
-        void ApplyAngularImpulse(Vector3 &impulse);
-
         /// <summary>
         /// Used by the per-control traversals to find stressed paths.
         /// It has to be separate from the IsActive flag because the IsActive flag is used in the same traversal
         /// to denote all visited bones (including unstressed ones).
         /// Also used in the unstressed traversals; FindCycles uses the IsActive flag and the following DistributeMass phase uses the traversed flag.
         /// </summary>
-        bool traversed;
+        bool traversed = false;
 
         /// <summary>
         /// The number of stressed paths which use this bone. A stressed path is a possible path between a pin and a control.
         /// </summary>
-        int stressCount;
+        int stressCount = 0;
 
         /// <summary>
         /// The set of parents of a given bone in a traversal. This is like a list of parents; there can be multiple incoming paths and they all need to be kept handy in order to perform some traversal details.
+        /// The list is stored in the traversal scratch of the active set; this is the index of its first link, or InvalidPredecessor if the list is empty.
         /// </summary>
-        std::vector<Bone*> predecessors;
+        uint32_t firstPredecessor = InvalidPredecessor;
+        uint32_t predecessorCount = 0;
+        static constexpr uint32_t InvalidPredecessor = std::numeric_limits<uint32_t>::max();
 
         /// <summary>
         /// True of the bone is a member of a cycle in an unstressed part of the graph or an unstressed predecessor of an unstressed cycle.
         /// Marking all the predecessors is conceptually simpler than attempting to mark the cycles in isolation.
         /// </summary>
-        bool unstressedCycle;
+        bool unstressedCycle = false;
         
         /// <summary>
         /// True if the bone is targeted by a control in the current stress cycle traversal that isn't the current source control.
         /// </summary>
-        bool targetedByOtherControl;
+        bool targetedByOtherControl = false;
     };
 }
@@ -0,0 +1,195 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/math.hpp"
+#include <span>
+#include <vector>
+#include <limits>
+#include <cinttypes>
+
+namespace BEPUik
+{
+	class Bone;
+
+	/// <summary>
+	/// Index of a bone's state within a BoneStore.
+	/// </summary>
+	using BoneHandle = uint32_t;
+	constexpr BoneHandle InvalidBoneHandle = std::numeric_limits<BoneHandle>::max();
+
+    /// <summary>
+    /// Packed structure-of-arrays storage for the solver state of the bones in an active set.
+    /// Bones refer to their slot through a handle; the solver loops stream over these arrays instead of chasing bone pointers.
+    /// </summary>
+    class BoneStore
+    {
+	public:
+		BoneStore()=default;
+		BoneStore(const BoneStore&)=delete;
+		BoneStore &operator=(const BoneStore&)=delete;
+		~BoneStore();
+
+        std::vector<Vector3> positions;
+        std::vector<Quaternion> orientations;
+
+        /// <summary>
+        /// Rotation matrices of the orientations, refreshed whenever an orientation changes.
+        /// The joints transform their local axes and anchors with these instead of rebuilding the rotation from the quaternion for every transform.
+        /// Orientations must be changed through SetOrientation to keep the two in sync.
+        /// </summary>
+        std::vector<Matrix3x3> rotations;
+
+        /// <summary>
+        /// The mid-iteration linear velocities of the bones.
+        /// These are computed during the velocity subiterations and then applied to the positions at the end of each position iteration.
+        /// </summary>
+        std::vector<Vector3> linearVelocities;
+
+        /// <summary>
+        /// The mid-iteration angular velocities of the bones.
+        /// These are computed during the velocity subiterations and then applied to the orientations at the end of each position iteration.
+        /// </summary>
+        std::vector<Vector3> angularVelocities;
+
+        /// <summary>
+        /// Inverse masses of the bones. Pinned bones are stored with zero inverse mass so that impulses cannot move them.
+        /// </summary>
+        std::vector<float> inverseMasses;
+
+        /// <summary>
+        /// World space inverse inertia tensors of the bones with a general local tensor.
+        /// Bones with an axisymmetric local tensor, which includes every capsule computed by Bone, skip this entirely; use TransformByInertiaTensorInverse to apply any bone's tensor.
+        /// </summary>
+        std::vector<Matrix3x3> inertiaTensorInverses;
+        std::vector<Matrix3x3> localInertiaTensorInverses;
+
+        /// <summary>
+        /// The bone associated with each handle, or null for unbound bones.
+        /// </summary>
+        std::vector<Bone*> bones;
+
+        /// <summary>
+        /// Gets the number of bones in the store.
+        /// </summary>
+		size_t GetCount() const;
+
+        /// <summary>
+        /// Gets the number of leading bones which are integrated by the solver.
+        /// Bones beyond this count are pinned bones that are only referenced by joints on the border of the active set.
+        /// </summary>
+		size_t GetIntegratedCount() const;
+
+        /// <summary>
+        /// Adds a bone to the store, copies its current state and binds the bone to the new handle.
+        /// Integrated bones must be added before any border bones.
+        /// </summary>
+        /// <param name="bone">Bone to add.</param>
+        /// <param name="integrated">Whether or not the solver should integrate the bone's state.</param>
+        /// <returns>Handle of the bone within the store.</returns>
+        BoneHandle Add(Bone &bone, bool integrated);
+
+        /// <summary>
+        /// Adds the state of a bone that is not bound to a Bone object, such as a bone of an IKRigInstance. The pose is left for the caller to fill in.
+        /// The pose of unbound bones is not written back by the integration, and Refresh leaves them untouched.
+        /// </summary>
+        /// <param name="inverseMass">Inverse mass of the bone. Zero for pinned bones.</param>
+        /// <param name="localInertiaTensorInverse">Inverse of the bone's local inertia tensor. Zero for pinned bones.</param>
+        /// <param name="integrated">Whether or not the solver should integrate the bone's state.</param>
+        /// <returns>Handle of the bone within the store.</returns>
+        BoneHandle AddUnbound(float inverseMass, const Matrix3x3 &localInertiaTensorInverse, bool integrated);
+
+        /// <summary>
+        /// Unbinds all bones and empties the store.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Copies the current pose and mass of the bound bones into the store and resets their velocities.
+        /// Used in place of a rebuild when the same bones are solved again.
+        /// </summary>
+        void Refresh();
+
+        /// <summary>
+        /// Updates the world inertia tensors of the integrated bones based upon their local inertia tensors and current orientations.
+        /// Bones whose orientation has not changed since their last update keep their tensor.
+        /// </summary>
+        void UpdateInertiaTensors();
+
+        /// <summary>
+        /// Integrates the positions and orientations of the integrated bones forward based upon their current linear and angular velocities.
+        /// </summary>
+        /// <returns>Largest distance or angle in radians that any bone moved during the integration.</returns>
+        float UpdatePositions();
+
+        /// <summary>
+        /// Updates the world inertia tensors of a subset of the integrated bones, e.g. one island of the active set.
+        /// </summary>
+        void UpdateInertiaTensors(std::span<const BoneHandle> handles);
+
+        /// <summary>
+        /// Integrates a subset of the integrated bones forward.
+        /// </summary>
+        /// <returns>Largest distance or angle in radians that any of the bones moved during the integration.</returns>
+        float UpdatePositions(std::span<const BoneHandle> handles);
+
+        void UpdateInertiaTensor(BoneHandle handle);
+        void UpdatePosition(BoneHandle handle);
+
+        /// <summary>
+        /// Sets the orientation of a bone in the store along with its rotation matrix, and marks its world inertia tensor for an update.
+        /// </summary>
+        void SetOrientation(BoneHandle handle, const Quaternion &orientation);
+
+        /// <summary>
+        /// Gets whether or not the bone with the given handle is integrated by the solver, as opposed to being a pinned border bone.
+        /// </summary>
+        bool IsIntegrated(BoneHandle handle) const {return handle < integratedCount;}
+
+        /// <summary>
+        /// Applies an impulse to an integrated bone. Impulses on border bones and pinned bones are ignored.
+        /// </summary>
+        void ApplyLinearImpulse(BoneHandle handle, const Vector3 &impulse);
+        void ApplyAngularImpulse(BoneHandle handle, const Vector3 &impulse);
+
+        /// <summary>
+        /// Transforms a vector by the world inverse inertia tensor of a bone.
+        /// The local tensor of an axisymmetric bone is diagonal with radial component a and axial component b around the bone's local Y axis,
+        /// so the world tensor is applied as a * v + (b - a) * (axis . v) * axis without ever being built.
+        /// </summary>
+        Vector3 TransformByInertiaTensorInverse(BoneHandle handle, const Vector3 &v) const
+        {
+            if (!axisymmetricInertias[handle])
+                return matrix::Transform(v, inertiaTensorInverses[handle]);
+            //The local Y axis in world space is the second row of the rotation.
+            const auto &axis = rotations[handle][1];
+            return vector3::Add(vector3::Multiply(v, radialInertiaTensorInverses[handle]), vector3::Multiply(axis, axialInertiaTensorInverseOffsets[handle] * vector3::Dot(axis, v)));
+        }
+	private:
+        size_t integratedCount = 0;
+        //Nonzero for bones whose local inverse inertia tensor is diagonal with equal X and Z components.
+        std::vector<uint8_t> axisymmetricInertias;
+        //The radial component a of the axisymmetric local tensors and the difference b - a of their axial component.
+        std::vector<float> radialInertiaTensorInverses;
+        std::vector<float> axialInertiaTensorInverseOffsets;
+        //Nonzero for bones whose orientation changed since their world inertia tensor was last computed.
+        //Bytes rather than vector<bool> so that islands solved on different threads never share a word.
+        std::vector<uint8_t> inertiaTensorsStale;
+
+        void CopyState(BoneHandle handle);
+        void SetLocalInertiaTensorInverse(BoneHandle handle, const Matrix3x3 &localInertiaTensorInverse);
+    };
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/Bone.hpp"
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/control/Control.hpp"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Owns the bones, joints, limits and controls of a rig.
+    /// Objects are constructed in place in large memory blocks instead of being allocated individually, which keeps the data of a character together
+    /// and lets the whole rig be released at once.
+    /// </summary>
+    class IKRig
+    {
+	public:
+        /// <summary>
+        /// Default size in bytes of the memory blocks. Enough for a typical humanoid with its limits and controls.
+        /// </summary>
+        static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+        /// <summary>
+        /// Constructs an empty rig.
+        /// </summary>
+        /// <param name="blockSize">Size in bytes of the memory blocks the objects are placed in. Objects larger than a block get a block of their own.</param>
+        IKRig(size_t blockSize = DefaultBlockSize);
+		IKRig(const IKRig&)=delete;
+		IKRig &operator=(const IKRig&)=delete;
+        ~IKRig();
+
+        /// <summary>
+        /// Constructs an object in the rig's memory. The object lives until the rig is cleared or destroyed.
+        /// Bones, joints (including limits) and controls are also added to the corresponding lists of the rig.
+        /// </summary>
+        /// <param name="args">Arguments forwarded to the constructor of the object.</param>
+        /// <returns>The new object.</returns>
+        template<typename T, typename... TArgs>
+        T &Create(TArgs&&... args)
+        {
+            static_assert(alignof(T) <= BlockAlignment, "Over-aligned types cannot be placed in the rig's memory blocks.");
+            auto *object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<TArgs>(args)...);
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                destructors.push_back({object, [](void *o) { static_cast<T*>(o)->~T(); }});
+            if constexpr (std::is_base_of_v<Bone, T>)
+                bones.push_back(object);
+            else if constexpr (std::is_base_of_v<IKJoint, T>)
+                joints.push_back(object);
+            else if constexpr (std::is_base_of_v<Control, T>)
+                controls.push_back(object);
+            return *object;
+        }
+
+        /// <summary>
+        /// Gets the bones of the rig in creation order.
+        /// </summary>
+        const std::vector<Bone*> &GetBones() const {return bones;}
+
+        /// <summary>
+        /// Gets the joints and limits of the rig in creation order.
+        /// </summary>
+        const std::vector<IKJoint*> &GetJoints() const {return joints;}
+
+        /// <summary>
+        /// Gets the controls of the rig in creation order. The list can be passed to IKSolver::Solve directly.
+        /// </summary>
+        std::vector<Control*> &GetControls() {return controls;}
+
+        /// <summary>
+        /// Destroys all objects in the reverse order of their creation. The first memory block is kept for reuse; the others are released.
+        /// Objects created afterwards reuse the addresses of the destroyed ones, so invalidate the active set of any solver that solved the rig.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Gets the total size in bytes of the memory blocks held by the rig.
+        /// </summary>
+        size_t GetReservedBytes() const;
+	private:
+        static constexpr size_t BlockAlignment = 64;
+
+        struct Block
+        {
+            std::byte *memory;
+            size_t size;
+        };
+        struct Destructor
+        {
+            void *object;
+            void (*destroy)(void*);
+        };
+
+        size_t blockSize;
+        std::vector<Block> blocks;
+        size_t blockOffset = 0;
+        std::vector<Destructor> destructors;
+        std::vector<Bone*> bones;
+        std::vector<IKJoint*> joints;
+        std::vector<Control*> controls;
+
+        void *Allocate(size_t size, size_t alignment);
+        void DestroyObjects();
+    };
+}
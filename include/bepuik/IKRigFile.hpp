@@ -0,0 +1,85 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/IKRigTemplate.hpp"
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Flat binary storage of an IKRigTemplate.
+    /// A file is a header followed by the bone, joint and control descriptions exactly as they are laid out in memory, each array aligned to 16 bytes.
+    /// Loading maps the file and views the arrays in place, so no joint is reconstructed and nothing is parsed or allocated per description.
+    /// Files are only readable by builds with the same byte order and description layout (i.e. the same math configuration); anything else is rejected on load.
+    /// </summary>
+    class IKRigFile
+    {
+	public:
+        /// <summary>
+        /// Version of the format written by this build. Bumped whenever a description changes.
+        /// </summary>
+        static constexpr uint32_t Version = 1;
+
+        /// <summary>
+        /// Maps a rig file into memory. The file is mapped read-only for the lifetime of the IKRigFile.
+        /// Throws std::runtime_error if the file cannot be mapped or is not a valid rig file.
+        /// </summary>
+        /// <param name="path">Path of the file.</param>
+        explicit IKRigFile(const std::string &path);
+
+        /// <summary>
+        /// Views rig file data that is already in memory, e.g. loaded by a streaming system. Nothing is copied; the data must outlive the IKRigFile
+        /// and be aligned to at least 16 bytes. Throws std::runtime_error if the data is not a valid rig file.
+        /// </summary>
+        /// <param name="data">Contents of a rig file.</param>
+        explicit IKRigFile(std::span<const std::byte> data);
+
+		IKRigFile(const IKRigFile&)=delete;
+		IKRigFile &operator=(const IKRigFile&)=delete;
+        ~IKRigFile();
+
+        /// <summary>
+        /// Gets the template stored in the file. It views the file's memory and is valid as long as the IKRigFile.
+        /// </summary>
+        const IKRigTemplate &GetTemplate() const {return *rigTemplate;}
+
+        /// <summary>
+        /// Serializes a template.
+        /// </summary>
+        /// <param name="rigTemplate">Template to write.</param>
+        /// <param name="stream">Binary stream to write to.</param>
+        static void Write(const IKRigTemplate &rigTemplate, std::ostream &stream);
+
+        /// <summary>
+        /// Serializes a template to a file. Throws std::runtime_error if the file cannot be written.
+        /// </summary>
+        /// <param name="rigTemplate">Template to write.</param>
+        /// <param name="path">Path of the file.</param>
+        static void Write(const IKRigTemplate &rigTemplate, const std::string &path);
+	private:
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        std::optional<IKRigTemplate> rigTemplate;
+
+        void Load(std::span<const std::byte> data);
+        void Unmap();
+    };
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/IKRigTemplate.hpp"
+#include "bepuik/IKSolver.hpp"
+#include <vector>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Per-character state of a rig described by an IKRigTemplate: the bone poses, the control goals and the impulses kept between solves.
+    /// Instances don't own any bones, joints or controls; they are solved by an IKRigWorkspace of the same template.
+    /// </summary>
+    class IKRigInstance
+    {
+	public:
+        /// <summary>
+        /// Constructs an instance in the rest pose of the template, with the goals of the template's controls.
+        /// </summary>
+        /// <param name="rigTemplate">Template of the instance. Must outlive the instance.</param>
+        IKRigInstance(const IKRigTemplate &rigTemplate);
+
+        /// <summary>
+        /// Positions of the bones, in template order.
+        /// </summary>
+        std::vector<Vector3> Positions;
+
+        /// <summary>
+        /// Orientations of the bones, in template order.
+        /// </summary>
+        std::vector<Quaternion> Orientations;
+
+        /// <summary>
+        /// Goals of the controls, in template order.
+        /// </summary>
+        std::vector<ControlGoal> Goals;
+
+        /// <summary>
+        /// Gets the template of the instance.
+        /// </summary>
+        const IKRigTemplate &GetTemplate() const {return *rigTemplate;}
+
+        /// <summary>
+        /// Discards the impulses kept from previous solves, e.g. after teleporting the character.
+        /// </summary>
+        void ClearAccumulatedImpulses();
+	private:
+        friend class IKRigWorkspace;
+
+        const IKRigTemplate *rigTemplate;
+        IKSolver::WarmStartState warmStart;
+        //Linear and angular motor impulses of each control.
+        std::vector<Vector3> controlImpulses;
+    };
+}
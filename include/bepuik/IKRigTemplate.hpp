@@ -0,0 +1,168 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/math.hpp"
+#include <cinttypes>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace BEPUik
+{
+	class Bone;
+	class IKJoint;
+	class Control;
+	class IKRig;
+
+    /// <summary>
+    /// Concrete control types that can be part of a rig template.
+    /// </summary>
+	enum class ControlType : uint8_t
+	{
+		Drag = 0,
+		State,
+		Revolute,
+		AngularPlane
+	};
+
+    /// <summary>
+    /// Immutable definition of a bone: its rest pose and the properties its mass and inertia are derived from.
+    /// </summary>
+    struct BoneDescription
+    {
+        Vector3 position;
+        Quaternion orientation;
+        float radius;
+        float height;
+        float mass;
+        float inertiaTensorScaling;
+        uint8_t pinned;
+        uint8_t reserved[3];
+    };
+
+    /// <summary>
+    /// Immutable definition of a joint or limit in the local spaces of its bones.
+    /// The meaning of the vectors and scalars depends on the type; see IKRigTemplate::Describe.
+    /// </summary>
+    struct JointDescription
+    {
+        JointType type;
+        uint8_t enabled;
+        uint8_t reserved[2];
+        uint32_t boneA;
+        uint32_t boneB;
+        float rigidity;
+        float maximumForce;
+        Quaternion orientation;
+        Vector3 vectors[6];
+        float scalars[2];
+    };
+
+    /// <summary>
+    /// Goal of a control. Drag controls use the position, state controls the position and orientation,
+    /// revolute controls use the axis as the world free axis and angular plane controls as the plane normal.
+    /// </summary>
+    struct ControlGoal
+    {
+        Vector3 position;
+        Quaternion orientation;
+        Vector3 axis;
+    };
+
+    /// <summary>
+    /// Immutable definition of a control. The goal is the initial goal of new instances.
+    /// </summary>
+    struct ControlDescription
+    {
+        ControlType type;
+        uint8_t reserved[3];
+        uint32_t bone;
+        Vector3 localOffset;
+        Vector3 localAxis;
+        float linearRigidity;
+        float angularRigidity;
+        float maximumForce;
+        ControlGoal goal;
+    };
+
+    //The descriptions are stored verbatim by IKRigFile. Padding is spelled out so that the stored bytes are fully defined.
+    static_assert(std::is_trivially_copyable_v<BoneDescription> && std::is_trivially_copyable_v<JointDescription> && std::is_trivially_copyable_v<ControlDescription>,
+        "Rig descriptions must be trivially copyable.");
+
+    /// <summary>
+    /// Shared, immutable description of a rig's bones, joints and controls, in the local spaces of the bones.
+    /// Characters with the same skeleton and constraint layout are IKRigInstances of one template; they only store their own pose, goals and impulses.
+    /// They are solved by an IKRigWorkspace, which instantiates the template once and can be reused for any number of instances.
+    /// </summary>
+    class IKRigTemplate
+    {
+	public:
+        /// <summary>
+        /// Captures the definitions of a set of bones, joints and controls in their current state.
+        /// Joints and controls may only reference the given bones. Custom joint types and control types other than those in ControlType cannot be captured.
+        /// </summary>
+        /// <param name="bones">Bones of the rig. Their order defines the bone indices of the template.</param>
+        /// <param name="joints">Joints and limits of the rig.</param>
+        /// <param name="controls">Controls of the rig.</param>
+        IKRigTemplate(const std::vector<Bone*> &bones, const std::vector<IKJoint*> &joints, const std::vector<Control*> &controls);
+
+        /// <summary>
+        /// Captures the bones, joints and controls of a rig.
+        /// </summary>
+        IKRigTemplate(IKRig &rig);
+
+        /// <summary>
+        /// Constructs a template viewing existing descriptions, e.g. those of a memory-mapped IKRigFile. Nothing is copied or validated; the memory must outlive the template.
+        /// </summary>
+        IKRigTemplate(std::span<const BoneDescription> bones, std::span<const JointDescription> joints, std::span<const ControlDescription> controls);
+
+		IKRigTemplate(const IKRigTemplate&)=delete;
+		IKRigTemplate &operator=(const IKRigTemplate&)=delete;
+
+        std::span<const BoneDescription> GetBones() const {return bones;}
+        std::span<const JointDescription> GetJoints() const {return joints;}
+        std::span<const ControlDescription> GetControls() const {return controls;}
+
+        /// <summary>
+        /// Creates the bones, joints and controls described by the template in a rig, in template order.
+        /// </summary>
+        /// <param name="rig">Rig to create the objects in.</param>
+        void Instantiate(IKRig &rig) const;
+
+        /// <summary>
+        /// Describes a joint in the local spaces of its bones.
+        /// </summary>
+        /// <param name="joint">Joint to describe. Must be one of the built-in joint types.</param>
+        /// <param name="boneA">Index of the joint's first connection within the template.</param>
+        /// <param name="boneB">Index of the joint's second connection within the template.</param>
+        static JointDescription Describe(const IKJoint &joint, uint32_t boneA, uint32_t boneB);
+
+        /// <summary>
+        /// Creates a joint from its description in a rig.
+        /// </summary>
+        static IKJoint &CreateJoint(IKRig &rig, const JointDescription &description, Bone &connectionA, Bone &connectionB);
+	private:
+        std::span<const BoneDescription> bones;
+        std::span<const JointDescription> joints;
+        std::span<const ControlDescription> controls;
+        //Storage of captured descriptions. Empty for templates viewing external memory.
+        std::vector<BoneDescription> ownedBones;
+        std::vector<JointDescription> ownedJoints;
+        std::vector<ControlDescription> ownedControls;
+    };
+}
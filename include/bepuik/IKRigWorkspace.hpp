@@ -0,0 +1,123 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/IKRig.hpp"
+#include "bepuik/IKRigInstance.hpp"
+#include "bepuik/IKSolver.hpp"
+#include "bepuik/BoneStore.hpp"
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/PermutationMapper.hpp"
+#include <span>
+#include <vector>
+
+namespace BEPUik
+{
+	class SingleBoneConstraint;
+
+    /// <summary>
+    /// Scratch rig used to solve the instances of an IKRigTemplate.
+    /// The workspace instantiates the template once; each solve loads an instance's pose, goals and kept impulses into it, solves, and writes them back.
+    /// Since all instances share the joints of the workspace, the solver's active set, batches and coloring are built once and reused for every instance.
+    /// A workspace solves one instance at a time; use one workspace per thread to solve instances in parallel.
+    /// </summary>
+    class IKRigWorkspace
+    {
+        //Declared ahead of the solver, whose active set still references the bones of the rig when it is destroyed.
+        const IKRigTemplate *rigTemplate;
+        IKRig rig;
+	public:
+        /// <summary>
+        /// Constructs a workspace for a template.
+        /// </summary>
+        /// <param name="rigTemplate">Template of the instances to solve. Must outlive the workspace.</param>
+        IKRigWorkspace(const IKRigTemplate &rigTemplate);
+		IKRigWorkspace(const IKRigWorkspace&)=delete;
+		IKRigWorkspace &operator=(const IKRigWorkspace&)=delete;
+
+        /// <summary>
+        /// Solver used for the instances. Its settings apply to every instance solved by the workspace.
+        /// </summary>
+        IKSolver Solver;
+
+        /// <summary>
+        /// Gets the template of the workspace.
+        /// </summary>
+        const IKRigTemplate &GetTemplate() const {return *rigTemplate;}
+
+        /// <summary>
+        /// Gets the rig the instances are solved in. Holds the state of the last solved instance.
+        /// </summary>
+        const IKRig &GetRig() const {return rig;}
+
+        /// <summary>
+        /// Solves an instance and updates its pose and kept impulses.
+        /// </summary>
+        /// <param name="instance">Instance to solve. Must be an instance of the workspace's template.</param>
+        void Solve(IKRigInstance &instance);
+
+        /// <summary>
+        /// Solves several instances at once. Groups of up to JointBundleWidth instances are packed into the lanes of the SIMD joint bundles,
+        /// so that lane i of every joint and control belongs to instance i, and each group goes through the solver iterations once.
+        /// The solver's iteration counts, convergence tolerance, time step, control autoscaling, impulse persistence and maximum SIMD level apply;
+        /// its batching, coloring, Jacobi, tree solve, island and presolve settings don't. A group iterates until all of its instances have converged.
+        /// The joints of each instance are solved in the same order as by Solve(IKRigInstance&), but the results are not bit-identical to it
+        /// since the bundle kernels round differently.
+        /// </summary>
+        /// <param name="instances">Instances to solve. Must be instances of the workspace's template; none may appear twice.</param>
+        void Solve(std::span<IKRigInstance* const> instances);
+	private:
+        //Linear and angular motor of each control, or null where the control has none.
+        std::vector<SingleBoneConstraint*> motors;
+
+        //Active joint of the workspace and the lane bundle solving it for all instances of a group.
+        struct LaneJoint
+        {
+            IKJoint *joint;
+            int rows;
+            uint32_t bundle;
+            bool isLimit;
+        };
+        //Active control motor and the lane bundle solving it.
+        struct LaneMotor
+        {
+            uint32_t control;
+            uint32_t motor;
+        };
+        //Bones of the active set for JointBundleWidth instances, interleaved so that bone h of lane i has the handle h * JointBundleWidth + i.
+        BoneStore laneBones;
+        //Template bone index of each handle of the workspace's active set.
+        std::vector<uint32_t> laneBoneIndices;
+        std::vector<LaneJoint> laneJoints;
+        std::vector<LaneMotor> laneMotors;
+        std::vector<JointBundle<1>> laneBundles1;
+        std::vector<JointBundle<2>> laneBundles2;
+        std::vector<JointBundle<3>> laneBundles3;
+        std::vector<JointBundle<3>> laneMotorBundles;
+        PermutationMapper lanePermutationMapper;
+        uint64_t laneVersion = 0;
+
+        void CheckInstance(const IKRigInstance &instance) const;
+        void BuildLanes();
+        void SolveLanes(std::span<IKRigInstance* const> instances);
+        void UpdateLaneJoints();
+        void UpdateLaneMotors(std::span<IKRigInstance* const> instances);
+        void SolveLaneVelocities(bool includeMotors);
+        float &LaneImpulse(const LaneJoint &joint, int row, int lane);
+        void LoadLaneImpulses(std::span<IKRigInstance* const> instances, bool fixerPhase);
+        void StoreLaneImpulses(std::span<IKRigInstance* const> instances, bool fixerPhase);
+    };
+}
@@ -17,6 +17,15 @@
 
 #include "bepuik/ActiveSet.hpp"
 #include "bepuik/PermutationMapper.hpp"
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/JointColoring.hpp"
+#include "bepuik/JointJacobi.hpp"
+#include "bepuik/JointTreeSolver.hpp"
+#include "bepuik/WorkerGroup.hpp"
+#include "bepuik/SolverStats.hpp"
+#include "bepuik/TwoBonePresolver.hpp"
+#include <memory>
+#include <utility>
 
 namespace BEPUik
 {
@@ -57,6 +66,69 @@ namespace BEPUik
         /// </summary>
         int VelocitySubiterationCount = 3;
 
+        /// <summary>
+        /// Gets or sets the motion below which the solver considers the pose converged and stops iterating early.
+        /// After each position iteration, the largest distance or angle in radians that any bone moved is compared against this value;
+        /// the control and fixer loops end independently once it is reached. Zero disables early termination.
+        /// </summary>
+        float ConvergenceTolerance = 0;
+
+        /// <summary>
+        /// Gets or sets the number of position iterations an effective mass is used for before it is recomputed.
+        /// 1 recomputes the effective masses of all joints and controls in every position iteration. Larger values reuse them in between,
+        /// trading accuracy for speed since the bone orientations and jacobians drift away from those the effective masses were computed with.
+        /// The jacobians and velocity biases are still updated every iteration, and the first iteration of the control and fixer phases always recomputes.
+        /// Rigs that move far per iteration, like long chains dragged to distant goals, can diverge with stale effective masses; use EffectiveMassRotationThreshold to guard against that.
+        /// </summary>
+        int EffectiveMassUpdateInterval = 1;
+
+        /// <summary>
+        /// Gets or sets the rotation in radians after which reused effective masses are recomputed before the update interval elapses.
+        /// The rotation of the bones is bounded by summing the largest motion of any bone over the iterations since the last recomputation,
+        /// so large translations trigger it as well. Zero disables the early recomputation.
+        /// </summary>
+        float EffectiveMassRotationThreshold = 0;
+
+        /// <summary>
+        /// Gets or sets whether or not control driven solves first place simple two bone limbs analytically before iterating.
+        /// This moves limbs such as arms and legs most of the way to their goals up front, so far fewer control iterations are needed.
+        /// See TwoBonePresolver for the limbs that qualify.
+        /// </summary>
+        bool UseTwoBonePresolve = false;
+
+        /// <summary>
+        /// Gets the number of limbs the two bone presolve placed during the last solve.
+        /// </summary>
+        int GetLastPresolvedLimbCount() const { return lastPresolvedLimbCount; }
+
+        /// <summary>
+        /// Gets the number of control iterations the last solve actually performed.
+        /// </summary>
+        int GetLastControlIterationCount() const { return lastControlIterationCount; }
+
+        /// <summary>
+        /// Gets the number of fixer iterations the last solve actually performed.
+        /// </summary>
+        int GetLastFixerIterationCount() const { return lastFixerIterationCount; }
+
+        /// <summary>
+        /// Gets or sets whether or not accumulated impulses are kept between solves to warm start the next one.
+        /// The control and fixer iterations each resume from the impulses they ended with in the previous solve,
+        /// as long as the active joints and the controls are the same. Otherwise the solve falls back to a cold start.
+        /// </summary>
+        bool PersistAccumulatedImpulses = false;
+
+        /// <summary>
+        /// Gets or sets the fraction of the kept accumulated impulses that is carried over into the next solve.
+        /// Values below one decay old impulses, which helps when the goals move quickly between solves.
+        /// </summary>
+        float PersistentImpulseScale = 1;
+
+        /// <summary>
+        /// Gets whether or not the last solve was warm started from the impulses of a previous solve.
+        /// </summary>
+        bool WasLastSolveWarmStarted() const { return lastSolveWarmStarted; }
+
         /// <summary>
         /// Gets or sets whether or not to scale control impulses such that they fit well with the mass of objects.
         /// </summary>
@@ -67,6 +139,73 @@ namespace BEPUik
         /// </summary>
         float AutoscaleControlMaximumForce = FLT_MAX;
 
+        /// <summary>
+        /// Gets or sets whether or not the active joints are compiled into type-sorted constraint batches before solving.
+        /// Batched joints are solved by non-virtual per-type kernels over packed data instead of going through the IKJoint interface.
+        /// The solving order differs slightly from the unbatched solver since joints are permuted within their batch.
+        /// </summary>
+        bool UseConstraintBatches = false;
+
+        /// <summary>
+        /// Gets or sets whether or not the constraint batches are further grouped into SIMD bundles of joints with no shared bones,
+        /// which are solved in lockstep. Only used when UseConstraintBatches is enabled.
+        /// </summary>
+        bool UseSimdBundles = false;
+
+        /// <summary>
+        /// Gets or sets the widest instruction set the SIMD bundles may be solved with.
+        /// The solver uses the narrower of this and the level supported by the running CPU, so the same binary runs everywhere.
+        /// </summary>
+        SimdLevel MaximumSimdLevel = SimdLevel::AVX2;
+
+        /// <summary>
+        /// Gets or sets whether or not the active joints are graph-colored so that the joints of each color can be solved in parallel.
+        /// Joints within a color share no integrated bones, so the result is the same for any thread count.
+        /// Takes precedence over UseConstraintBatches.
+        /// </summary>
+        bool UseParallelColoring = false;
+
+        /// <summary>
+        /// Gets or sets whether or not the islands of the active set are solved independently of each other.
+        /// Each island runs its own control and fixer iterations with its own joint permutation and stops as soon as its own motion falls
+        /// below ConvergenceTolerance, so a converged limb isn't iterated for as long as the slowest island. The iteration counts are the budget of every island.
+        /// The islands are distributed over the solver's threads; see SetParallelThreadCount. The result doesn't depend on the thread count.
+        /// Takes precedence over UseDirectTreeSolve, UseJacobi, UseParallelColoring and UseConstraintBatches; the joints of an island are solved one by one.
+        /// </summary>
+        bool UseIslands = false;
+
+        /// <summary>
+        /// Gets or sets whether or not the equality joints connecting the bones as a tree are solved exactly in every velocity subiteration
+        /// by a linear time sparse factorization, instead of iteratively. Limits and joints closing a loop are still solved by Gauss-Seidel sweeps.
+        /// Long chains, which need many iterations to propagate a correction from one end to the other, reach their pose in far fewer iterations.
+        /// Directly solved joints are not bounded by their maximum force.
+        /// Takes precedence over UseJacobi, UseParallelColoring and UseConstraintBatches; UseIslands takes precedence over it.
+        /// </summary>
+        bool UseDirectTreeSolve = false;
+
+        /// <summary>
+        /// Gets or sets whether or not the joints are solved with relaxed Jacobi iterations instead of sequential Gauss-Seidel sweeps.
+        /// Every joint computes its impulse from the same bone velocities and the impulses are applied together, scaled by JacobiRelaxation,
+        /// so each velocity subiteration is split across the solver's threads without any ordering between joints; see SetParallelThreadCount.
+        /// Jacobi iterations converge more slowly per iteration than Gauss-Seidel, so they need more VelocitySubiterationCount or iterations to reach the same pose,
+        /// and only pay off for large active sets on several threads. The result doesn't depend on the thread count.
+        /// Takes precedence over UseParallelColoring and UseConstraintBatches; UseIslands and UseDirectTreeSolve take precedence over it.
+        /// </summary>
+        bool UseJacobi = false;
+
+        /// <summary>
+        /// Gets or sets the fraction of each joint's impulse that is applied in a Jacobi iteration.
+        /// Joints sharing a bone correct the same velocity error at once, so higher values converge faster until they overshoot and oscillate.
+        /// </summary>
+        float JacobiRelaxation = 0.5f;
+
+        /// <summary>
+        /// Gets or sets the number of threads used when UseParallelColoring, UseJacobi or UseIslands is enabled, including the calling thread.
+        /// Zero uses the hardware concurrency. The threads are created on the first parallel solve.
+        /// </summary>
+        uint32_t GetParallelThreadCount() const { return parallelThreadCount; }
+        void SetParallelThreadCount(uint32_t value);
+
         /// <summary>
         /// Gets or sets the time step duration elapsed by each position iteration.
         /// </summary>
@@ -78,6 +217,18 @@ namespace BEPUik
             timeStepDuration = value;
         }
 
+        /// <summary>
+        /// Gets the phase timings, iteration counts, active set size and residuals recorded during the last solve.
+        /// Statistics are only recorded if the library is built with BEPUIK_ENABLE_STATS; otherwise they remain zero.
+        /// </summary>
+        const SolverStats &GetLastSolveStats() const { return lastSolveStats; }
+
+        /// <summary>
+        /// Sets a callback invoked when the solver enters and leaves each phase of a solve, e.g. to forward the phases to a profiler.
+        /// The callback is only invoked if the library is built with BEPUIK_ENABLE_STATS.
+        /// </summary>
+        void SetPhaseCallback(SolvePhaseCallback callback) { phaseCallback = std::move(callback); }
+
         /// <summary>
         /// Constructs a new IKSolver.
         /// </summary>
@@ -98,10 +249,100 @@ namespace BEPUik
         void Solve(std::vector<Control*> &controls);
 
 
+        /// <summary>
+        /// Accumulated joint impulses kept from the end of a solver phase, together with the active joints they belong to.
+        /// </summary>
+        struct PersistentImpulses
+        {
+            std::vector<IKJoint*> joints;
+            std::vector<Vector3> impulses;
+        };
+
+        /// <summary>
+        /// Joint impulses kept between solves when PersistAccumulatedImpulses is enabled, and the controls they were computed for.
+        /// </summary>
+        struct WarmStartState
+        {
+            PersistentImpulses controlPhase;
+            PersistentImpulses fixerPhase;
+            std::vector<Control*> controls;
+        };
+
+        /// <summary>
+        /// Exchanges the kept joint impulses of the solver with the given state.
+        /// Lets one solver alternate between rigs that share their joints, such as the instances solved by an IKRigWorkspace, without losing the warm start of each.
+        /// The impulses of the controls' motors are not part of the state.
+        /// </summary>
+        /// <param name="state">State to swap with the solver's.</param>
+        void SwapWarmStartState(WarmStartState &state) { std::swap(warmStart, state); }
+
         ~IKSolver();
 
 	private:
         float timeStepDuration = 1.0f;
 		PermutationMapper permutationMapper;
+        JointBatches jointBatches;
+        JointColoring jointColoring;
+        JointJacobi jointJacobi;
+        JointTreeSolver jointTreeSolver;
+        TwoBonePresolver twoBonePresolver;
+        int lastPresolvedLimbCount = 0;
+        //Active set versions the batches, coloring, Jacobi joints and trees were built for. Zero is never a valid version.
+        uint64_t jointBatchesVersion = 0;
+        uint64_t jointColoringVersion = 0;
+        uint64_t jointJacobiVersion = 0;
+        uint64_t jointTreeSolverVersion = 0;
+        std::unique_ptr<WorkerGroup> workerGroup;
+        uint32_t parallelThreadCount = 0;
+        int lastControlIterationCount = 0;
+        int lastFixerIterationCount = 0;
+
+        //Tracks when the effective masses were last recomputed and how far the bones moved since then.
+        struct EffectiveMassSchedule
+        {
+            int lastUpdateIteration = 0;
+            float motion = 0;
+        };
+        EffectiveMassSchedule effectiveMassSchedule;
+
+        //Per island state of a solve with UseIslands.
+        struct IslandState
+        {
+            std::vector<Control*> controls;
+            PermutationMapper permutationMapper;
+            EffectiveMassSchedule effectiveMassSchedule;
+            int controlIterationCount = 0;
+            int fixerIterationCount = 0;
+            float controlResidual = 0;
+            float fixerResidual = 0;
+        };
+        std::vector<IslandState> islandStates;
+
+        WarmStartState warmStart;
+        bool lastSolveWarmStarted = false;
+        SolverStats lastSolveStats;
+        SolvePhaseCallback phaseCallback;
+
+        bool RestoreJointImpulses(const PersistentImpulses &persistent);
+        void EndJointPhase(PersistentImpulses &persistent);
+
+        bool IntegrateBones(int &iterationCount, float &residual);
+        bool ScheduleEffectiveMassUpdate(EffectiveMassSchedule &schedule, int iteration) const;
+        void EndSolveStats(std::chrono::steady_clock::time_point start, size_t controlCount);
+
+        void KeepControlImpulses(std::vector<Control*> &controls);
+        void SolveIslands(const std::vector<Control*> *controls);
+        void SolveIsland(IslandState &state, const ActiveIsland &island, bool solveControls, bool restoreFixerPhase);
+        bool IterateIsland(IslandState &state, const ActiveIsland &island, bool solveControls, int &iterationCount, float &residual);
+        void EndIslandPhase(const ActiveIsland &island, PersistentImpulses &persistent);
+
+        bool IsTreeSolve() const { return UseDirectTreeSolve && !UseIslands; }
+        bool IsJacobi() const { return UseJacobi && !UseDirectTreeSolve && !UseIslands; }
+        bool IsBatched() const { return UseConstraintBatches && !UseParallelColoring && !UseJacobi && !UseDirectTreeSolve && !UseIslands; }
+        void PrepareJointSolve();
+        void PreupdateJoints(float updateRate);
+        void UpdateJoints(bool updateEffectiveMass);
+        void SolveJointVelocities();
+        void ClearJointImpulses();
     };
 }
@@ -0,0 +1,107 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/IKSolver.hpp"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <cinttypes>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// A single solve performed by an IKSolverPool.
+    /// </summary>
+    struct IKSolveTask
+    {
+        IKSolver *solver = nullptr;
+        /// <summary>
+        /// Controls to solve. If null, the task runs a joint-only solve of Joints instead.
+        /// </summary>
+        std::vector<Control*> *controls = nullptr;
+        std::vector<IKJoint*> *joints = nullptr;
+    };
+
+    /// <summary>
+    /// Solves many independent IKSolver instances in parallel on a work-stealing thread pool.
+    /// </summary>
+    /// <remarks>
+    /// Every task of a batch must use a distinct solver, and no two tasks may touch the same bones or joints.
+    /// Solvers hold all of their solving state, so beyond that no state is shared between tasks;
+    /// graph traversal scratch is provided per worker thread instead of per solver.
+    /// </remarks>
+    class IKSolverPool
+    {
+	public:
+        /// <summary>
+        /// Constructs a new solver pool.
+        /// </summary>
+        /// <param name="threadCount">Number of threads solving tasks, including the thread calling Solve. 0 uses the hardware concurrency.</param>
+        explicit IKSolverPool(uint32_t threadCount = 0);
+		IKSolverPool(const IKSolverPool&)=delete;
+		IKSolverPool &operator=(const IKSolverPool&)=delete;
+        ~IKSolverPool();
+
+        /// <summary>
+        /// Gets the number of threads solving tasks, including the thread calling Solve.
+        /// </summary>
+        uint32_t GetThreadCount() const;
+
+        /// <summary>
+        /// Solves all tasks and blocks until they are complete. The calling thread participates in solving.
+        /// If any task throws, the remaining tasks are still solved and the first exception is rethrown afterwards.
+        /// </summary>
+        /// <param name="tasks">Tasks to solve.</param>
+        void Solve(const std::vector<IKSolveTask> &tasks);
+	private:
+        /// <summary>
+        /// Per-thread state. Aligned to its own cache lines so that workers never write to a line another worker reads.
+        /// </summary>
+        struct alignas(64) Worker
+        {
+            std::mutex mutex;
+            //Indices of the tasks owned by the worker. The owner pops from the front, thieves steal from the back.
+            std::deque<size_t> tasks;
+            ActiveSetScratch scratch;
+        };
+
+        bool PopTask(Worker &worker, size_t &taskIndex);
+        bool StealTask(size_t thiefIndex, size_t &taskIndex);
+        void RunTasks(size_t workerIndex);
+        void RunTask(Worker &worker, const IKSolveTask &task);
+        void WorkerMain(size_t workerIndex);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_startCondition;
+        std::condition_variable m_doneCondition;
+        uint64_t m_generation = 0;
+        size_t m_activeThreads = 0;
+        bool m_shutdown = false;
+
+        const std::vector<IKSolveTask> *m_tasks = nullptr;
+        alignas(64) std::atomic<size_t> m_remainingTasks {0};
+        std::exception_ptr m_exception;
+    };
+}
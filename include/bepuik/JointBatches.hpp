@@ -0,0 +1,263 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/BoneStore.hpp"
+#include "bepuik/Simd.hpp"
+#include <array>
+#include <vector>
+#include <cinttypes>
+
+namespace BEPUik
+{
+	class PermutationMapper;
+
+    /// <summary>
+    /// Concrete joint types known to the batched solver.
+    /// Joints of any other type are classified as Custom; they are not batched and are solved entirely through their own virtual interface.
+    /// </summary>
+	enum class JointType : uint8_t
+	{
+		BallSocket = 0,
+		Angular,
+		Distance,
+		PointOnLine,
+		PointOnPlane,
+		Revolute,
+		SwivelHinge,
+		Twist,
+		DistanceLimit,
+		EllipseSwingLimit,
+		LinearAxisLimit,
+		SwingLimit,
+		TwistLimit,
+		Custom,
+
+		Count
+	};
+
+    /// <summary>
+    /// Packed solver state of a single joint within a batch.
+    /// Only the jacobian rows, bias and impulse components for the joint's degrees of freedom are stored.
+    /// </summary>
+    template<int Rows>
+        struct JointBatchEntry
+    {
+        /// <summary>
+        /// Joint which authored the constraint. Used for computing the jacobians and for exchanging accumulated impulses with the joint.
+        /// </summary>
+        IKJoint *joint = nullptr;
+        BoneHandle handleA = InvalidBoneHandle;
+        BoneHandle handleB = InvalidBoneHandle;
+        Vector3 linearJacobianA[Rows];
+        Vector3 angularJacobianA[Rows];
+        Vector3 linearJacobianB[Rows];
+        Vector3 angularJacobianB[Rows];
+        float velocityBias[Rows] = {};
+        float effectiveMass[Rows][Rows] = {};
+        float accumulatedImpulse[Rows] = {};
+        float softness = 0.f;
+        float maximumImpulse = 0.f;
+        float maximumImpulseSquared = 0.f;
+    };
+
+    /// <summary>
+    /// Number of lanes in a joint bundle. This is the widest supported SIMD width; narrower instruction sets solve a bundle in several steps.
+    /// </summary>
+    constexpr int JointBundleWidth = 8;
+
+    /// <summary>
+    /// Transposed (AoSoA) solver state of up to JointBundleWidth joints of the same type and degrees of freedom.
+    /// No two joints in a bundle share an integrated bone, so the lanes can be solved in lockstep.
+    /// Unused lanes have zero jacobians and effective masses and never produce an impulse.
+    /// </summary>
+    template<int Rows>
+        struct alignas(32) JointBundle
+    {
+        /// <summary>
+        /// Velocity jacobian rows, indexed by [row][component][lane].
+        /// </summary>
+        float linearJacobianA[Rows][3][JointBundleWidth] = {};
+        float angularJacobianA[Rows][3][JointBundleWidth] = {};
+        float linearJacobianB[Rows][3][JointBundleWidth] = {};
+        float angularJacobianB[Rows][3][JointBundleWidth] = {};
+        /// <summary>
+        /// Velocity change of each bone per unit of constraint space impulse, J * M^-1, indexed by [row][component][lane].
+        /// These are refreshed together with the jacobians, so applying an impulse doesn't need the bones' inertia.
+        /// </summary>
+        float linearVelocityChangeA[Rows][3][JointBundleWidth] = {};
+        float angularVelocityChangeA[Rows][3][JointBundleWidth] = {};
+        float linearVelocityChangeB[Rows][3][JointBundleWidth] = {};
+        float angularVelocityChangeB[Rows][3][JointBundleWidth] = {};
+        float velocityBias[Rows][JointBundleWidth] = {};
+        float effectiveMass[Rows][Rows][JointBundleWidth] = {};
+        float accumulatedImpulse[Rows][JointBundleWidth] = {};
+        float softness[JointBundleWidth] = {};
+        float maximumImpulse[JointBundleWidth] = {};
+        float maximumImpulseSquared[JointBundleWidth] = {};
+        BoneHandle handleA[JointBundleWidth];
+        BoneHandle handleB[JointBundleWidth];
+        /// <summary>
+        /// Index of each lane's joint within the batch's entry list.
+        /// </summary>
+        uint32_t entryIndex[JointBundleWidth];
+        int count = 0;
+    };
+
+    /// <summary>
+    /// Contiguous set of joints of the same type, split by degrees of freedom.
+    /// Built-in joint types only ever populate one of the entry lists.
+    /// </summary>
+    struct JointBatch
+    {
+        JointType type = JointType::Custom;
+        /// <summary>
+        /// Whether or not the joints in the batch are limits, which can only apply positive impulses.
+        /// </summary>
+        bool isLimit = false;
+        std::vector<JointBatchEntry<1>> entries1;
+        std::vector<JointBatchEntry<2>> entries2;
+        std::vector<JointBatchEntry<3>> entries3;
+
+        /// <summary>
+        /// SIMD bundles of the entries. Only built when the batches are bundled.
+        /// </summary>
+        std::vector<JointBundle<1>> bundles1;
+        std::vector<JointBundle<2>> bundles2;
+        std::vector<JointBundle<3>> bundles3;
+
+        template<int Rows>
+            std::vector<JointBatchEntry<Rows>> &GetEntries()
+        {
+            if constexpr (Rows == 1)
+                return entries1;
+            else if constexpr (Rows == 2)
+                return entries2;
+            else
+                return entries3;
+        }
+        template<int Rows>
+            std::vector<JointBundle<Rows>> &GetBundles()
+        {
+            if constexpr (Rows == 1)
+                return bundles1;
+            else if constexpr (Rows == 2)
+                return bundles2;
+            else
+                return bundles3;
+        }
+        size_t GetCount() const {return entries1.size() +entries2.size() +entries3.size();}
+    };
+
+    /// <summary>
+    /// Compiles the joints of an active set into type-sorted batches and solves them with non-virtual per-type kernels.
+    /// The joint classes remain the authoring API; the batches only hold a packed copy of the state needed by the solver iterations.
+    /// </summary>
+    class JointBatches
+    {
+	public:
+		JointBatches()=default;
+		JointBatches(const JointBatches&)=delete;
+		JointBatches &operator=(const JointBatches&)=delete;
+
+        /// <summary>
+        /// Determines the batch type of a joint.
+        /// </summary>
+        /// <param name="joint">Joint to classify.</param>
+        /// <returns>Type of the joint, or JointType::Custom if the joint is not one of the built-in types.</returns>
+        static JointType Classify(const IKJoint &joint);
+
+        /// <summary>
+        /// Rebuilds the batches from the given joints. The joints must already be bound to the bone store they will be solved against.
+        /// </summary>
+        /// <param name="joints">Joints to batch. Their relative order is preserved within each batch.</param>
+        /// <param name="bones">Store the joints are bound to.</param>
+        /// <param name="bundle">If true, the joints of each batch are additionally grouped into SIMD bundles of joints that share no integrated bones,
+        /// and the velocity iterations are solved bundle by bundle.</param>
+        /// <param name="simdLevel">Instruction set to solve the bundles with. Must be supported by the CPU.</param>
+        void Build(const std::vector<IKJoint*> &joints, const BoneStore &bones, bool bundle = false, SimdLevel simdLevel = SimdLevel::Scalar);
+
+        /// <summary>
+        /// Gets whether or not the batches were built with SIMD bundles.
+        /// </summary>
+        bool IsBundled() const;
+        SimdLevel GetSimdLevel() const;
+
+        /// <summary>
+        /// Removes all joints from the batches.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Gets the number of joints in all batches.
+        /// </summary>
+        size_t GetCount() const;
+
+        /// <summary>
+        /// Gets the batches, indexed by JointType. Batches of types that are not in use are empty, and so is the Custom batch.
+        /// </summary>
+        const std::array<JointBatch, static_cast<size_t>(JointType::Count)> &GetBatches() const;
+
+        /// <summary>
+        /// Copies the softness and maximum impulse from the joints. Must be called after the joints have been preupdated.
+        /// </summary>
+        void Preupdate();
+
+        /// <summary>
+        /// Updates the jacobians, velocity biases and effective masses of all joints for the current bone states.
+        /// </summary>
+        /// <param name="bones">Store containing the bone states.</param>
+        /// <param name="updateEffectiveMass">Whether or not to recompute the effective masses. If false, those of the previous update are reused.</param>
+        void UpdateJacobiansAndEffectiveMass(const BoneStore &bones, bool updateEffectiveMass = true);
+
+        /// <summary>
+        /// Applies the accumulated impulses of all joints to warm up the constraint solving process.
+        /// </summary>
+        /// <param name="bones">Store containing the bone states.</param>
+        void WarmStart(BoneStore &bones);
+
+        /// <summary>
+        /// Applies impulses to satisfy the velocity constraints of all joints.
+        /// Each batch is solved in the permuted order given by the permutation mapper. Custom joints are solved last, one by one.
+        /// </summary>
+        /// <param name="bones">Store containing the bone states.</param>
+        /// <param name="permutationMapper">Permutation used to shuffle the solving order within each batch.</param>
+        void SolveVelocityIteration(BoneStore &bones, PermutationMapper &permutationMapper);
+
+        /// <summary>
+        /// Clears the accumulated impulses of all joints.
+        /// </summary>
+        void ClearAccumulatedImpulses();
+
+        /// <summary>
+        /// Copies the accumulated impulses of the batched joints back into the joints.
+        /// </summary>
+        void StoreAccumulatedImpulses();
+
+        /// <summary>
+        /// Reloads the accumulated impulses from the joints, replacing the batched ones.
+        /// </summary>
+        void LoadAccumulatedImpulses();
+	private:
+        std::array<JointBatch, static_cast<size_t>(JointType::Count)> batches;
+        //Joints of types unknown to the batches. They keep their own solver state and may override any part of the solving process.
+        std::vector<IKJoint*> customJoints;
+        size_t count = 0;
+        bool bundled = false;
+        SimdLevel simdLevel = SimdLevel::Scalar;
+    };
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/BoneStore.hpp"
+#include <vector>
+
+namespace BEPUik
+{
+	class WorkerGroup;
+	class PermutationMapper;
+
+    /// <summary>
+    /// Partitions the joints of an active set into colors such that no two joints of a color share an integrated bone.
+    /// The joints of a color can then be solved concurrently; pinned border bones may be shared since they never receive impulses.
+    /// </summary>
+    class JointColoring
+    {
+	public:
+		JointColoring()=default;
+		JointColoring(const JointColoring&)=delete;
+		JointColoring &operator=(const JointColoring&)=delete;
+
+        /// <summary>
+        /// Minimum number of joints in a color before it is split across threads. Smaller colors are solved on the calling thread.
+        /// </summary>
+        size_t MinimumParallelJoints = 64;
+
+        /// <summary>
+        /// Greedily colors the given joints. The coloring only depends on the order of the joints, so it is deterministic.
+        /// </summary>
+        /// <param name="joints">Joints to color. They must already be bound to the bone store.</param>
+        /// <param name="bones">Store the joints are bound to.</param>
+        void Build(const std::vector<IKJoint*> &joints, const BoneStore &bones);
+
+        /// <summary>
+        /// Removes all joints from the coloring.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Gets the number of colors.
+        /// </summary>
+        size_t GetColorCount() const;
+
+        /// <summary>
+        /// Gets the joints of a color.
+        /// </summary>
+        /// <param name="color">Index of the color.</param>
+        /// <param name="count">Receives the number of joints in the color.</param>
+        /// <returns>Pointer to the first joint of the color.</returns>
+        IKJoint *const *GetColor(size_t color, size_t &count) const;
+
+        /// <summary>
+        /// Updates the jacobians and effective masses of all joints in parallel, then warm starts them color by color.
+        /// If updateEffectiveMass is false, the effective masses of the previous update are reused.
+        /// </summary>
+        void UpdateJoints(WorkerGroup &workers, bool updateEffectiveMass = true);
+
+        /// <summary>
+        /// Runs one velocity iteration over all colors. The colors are visited in the order given by the permutation mapper;
+        /// since the joints within a color are independent, the result does not depend on the thread count.
+        /// </summary>
+        void SolveVelocityIteration(WorkerGroup &workers, PermutationMapper &permutationMapper);
+	private:
+        template<class TFunc>
+            void ForEachInColor(WorkerGroup &workers, size_t color, const TFunc &func);
+
+        //Joints sorted by color; color i occupies [m_colorStarts[i], m_colorStarts[i + 1]).
+        std::vector<IKJoint*> m_joints;
+        std::vector<size_t> m_colorStarts;
+        //Per-bone list of the colors already touching the bone; only used while building.
+        std::vector<std::vector<uint32_t>> m_boneColors;
+    };
+}
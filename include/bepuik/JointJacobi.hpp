@@ -0,0 +1,84 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/BoneStore.hpp"
+#include <vector>
+
+namespace BEPUik
+{
+	class WorkerGroup;
+
+    /// <summary>
+    /// Solves the joints of an active set with relaxed Jacobi iterations instead of sequential Gauss-Seidel sweeps.
+    /// Every joint computes its impulse from the same snapshot of the bone velocities, and each bone then gathers the impulses of its joints.
+    /// Neither pass writes to shared state, so both are split across threads without any coloring, and the result does not depend on the thread count.
+    /// Joints of types other than the built-in ones are solved after each Jacobi pass, one by one on the calling thread and through their own virtual interface.
+    /// </summary>
+    class JointJacobi
+    {
+	public:
+		JointJacobi()=default;
+		JointJacobi(const JointJacobi&)=delete;
+		JointJacobi &operator=(const JointJacobi&)=delete;
+
+        /// <summary>
+        /// Minimum number of joints or bones in a pass before it is split across threads. Smaller passes run on the calling thread.
+        /// </summary>
+        size_t MinimumParallelJoints = 64;
+
+        /// <summary>
+        /// Records the joints and the joints touching each integrated bone.
+        /// </summary>
+        /// <param name="joints">Joints to solve. They must already be bound to the bone store.</param>
+        /// <param name="bones">Store the joints are bound to.</param>
+        void Build(const std::vector<IKJoint*> &joints, BoneStore &bones);
+
+        /// <summary>
+        /// Removes all joints.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Updates the jacobians and effective masses of all joints in parallel, then applies their accumulated impulses.
+        /// If updateEffectiveMass is false, the effective masses of the previous update are reused.
+        /// </summary>
+        void UpdateJoints(WorkerGroup &workers, bool updateEffectiveMass = true);
+
+        /// <summary>
+        /// Runs one Jacobi velocity iteration over all joints.
+        /// </summary>
+        /// <param name="relaxation">Fraction of each joint's impulse that is accumulated and applied.
+        /// Joints sharing a bone all correct the same velocity error, so values below one are needed to keep them from overshooting together.</param>
+        void SolveVelocityIteration(WorkerGroup &workers, float relaxation);
+	private:
+        template<class TFunc>
+            void ParallelFor(WorkerGroup &workers, size_t count, const TFunc &func);
+        void ApplyImpulses(WorkerGroup &workers);
+
+        BoneStore *m_bones = nullptr;
+        //Built-in joints, solved by the Jacobi passes.
+        std::vector<IKJoint*> m_joints;
+        std::vector<IKJoint*> m_customJoints;
+        std::vector<uint8_t> m_isLimit;
+        //World space impulses of the last pass, four per joint: linear and angular on bone A, then linear and angular on bone B.
+        std::vector<Vector3> m_impulses;
+        //Integrated bone i gathers the impulse pairs starting at the offsets in [m_boneStarts[i], m_boneStarts[i + 1]) of m_boneImpulses.
+        std::vector<uint32_t> m_boneStarts;
+        std::vector<uint32_t> m_boneImpulses;
+    };
+}
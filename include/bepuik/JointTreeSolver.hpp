@@ -0,0 +1,118 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/joint/IKJoint.hpp"
+#include "bepuik/BoneStore.hpp"
+#include <vector>
+
+namespace BEPUik
+{
+	class PermutationMapper;
+
+    /// <summary>
+    /// Solves the equality joints of an active set exactly with a linear time sparse factorization wherever they connect the bones as a tree.
+    /// The equality joints between the same pair of bones are merged into one constraint. Together with the movable bones, these constraints form the nodes of
+    /// the sparse system [M J^T; J -S], which is eliminated from the leaves of each tree towards its root without any fill-in (Baraff, "Linear-Time Dynamics using Lagrange Multipliers").
+    /// Limits, custom joints, joints closing a loop and joints between bones that can't move are left to the iterative solver.
+    /// Pinned and border bones have infinite mass, so they split the joint graph instead of adding loops.
+    /// </summary>
+    class JointTreeSolver
+    {
+	public:
+		JointTreeSolver()=default;
+		JointTreeSolver(const JointTreeSolver&)=delete;
+		JointTreeSolver &operator=(const JointTreeSolver&)=delete;
+
+        /// <summary>
+        /// Partitions the joints into those solved directly and those solved iteratively, and builds the elimination order of the trees.
+        /// </summary>
+        /// <param name="joints">Joints to solve. They must already be bound to the bone store.</param>
+        /// <param name="bones">Store the joints are bound to.</param>
+        void Build(const std::vector<IKJoint*> &joints, BoneStore &bones);
+
+        /// <summary>
+        /// Removes all joints.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Gets the number of joints solved directly.
+        /// </summary>
+        size_t GetDirectJointCount() const;
+
+        /// <summary>
+        /// Gets the limits and other joints that are solved iteratively.
+        /// </summary>
+        const std::vector<IKJoint*> &GetIterativeJoints() const;
+
+        /// <summary>
+        /// Updates the jacobians of all joints and the effective masses of the iterative joints, warm starts them, and factorizes the system of the direct joints.
+        /// If updateEffectiveMass is false, the effective masses of the iterative joints are reused; the factorization is always updated.
+        /// </summary>
+        void UpdateJoints(bool updateEffectiveMass = true);
+
+        /// <summary>
+        /// Runs one velocity iteration over the iterative joints in the order given by the permutation mapper,
+        /// then solves the direct joints exactly for the resulting bone velocities.
+        /// The direct joints apply whatever impulse satisfies them; their maximum force is not enforced.
+        /// </summary>
+        void SolveVelocityIteration(PermutationMapper &permutationMapper);
+	private:
+        //Largest number of jacobian rows merged into one constraint; joints beyond it stay iterative.
+        static constexpr int MaximumRows = 6;
+        using Block = float[MaximumRows][MaximumRows];
+
+        struct Constraint
+        {
+            //Joints merged into the constraint; the rows of each joint follow those of the previous one.
+            std::vector<IKJoint*> joints;
+            BoneHandle handleA;
+            BoneHandle handleB;
+            int rowCount = 0;
+        };
+
+        //A movable bone or a constraint of the trees.
+        struct Node
+        {
+            //Index of the parent node, or NoParent for the root of a tree.
+            uint32_t parent;
+            //Bone handle for bone nodes, constraint index for constraint nodes.
+            uint32_t index;
+            bool isBone;
+            int size;
+            //Inverse of the node's pivot block once factorized.
+            Block inverseDiagonal;
+            //Coupling block between this node's rows and its parent's, size x parent size.
+            Block parentCoupling;
+            float y[MaximumRows];
+            float x[MaximumRows];
+        };
+        static constexpr uint32_t NoParent = ~0u;
+
+        void Factorize();
+        void SolveDirect();
+
+        BoneStore *m_bones = nullptr;
+        std::vector<IKJoint*> m_iterativeJoints;
+        std::vector<Constraint> m_constraints;
+        size_t m_directJointCount = 0;
+        //Nodes in breadth first order from the roots; every node comes after its parent, so the reverse order eliminates leaves first.
+        std::vector<Node> m_nodes;
+        //Node of each movable bone, indexed by handle.
+        std::vector<uint32_t> m_boneNodes;
+    };
+}
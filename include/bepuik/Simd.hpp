@@ -0,0 +1,51 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cinttypes>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Instruction set used to solve SIMD joint bundles. Each level is a superset of the previous one.
+    /// </summary>
+	enum class SimdLevel : uint8_t
+	{
+        /// <summary>
+        /// Portable scalar fallback; bundle lanes are solved one at a time.
+        /// </summary>
+		Scalar = 0,
+        /// <summary>
+        /// 4-wide SSE2.
+        /// </summary>
+		SSE,
+        /// <summary>
+        /// 8-wide AVX2.
+        /// </summary>
+		AVX2
+	};
+
+    /// <summary>
+    /// Gets the widest SIMD level supported by both the build and the CPU the process is running on.
+    /// The CPU is only queried once.
+    /// </summary>
+	SimdLevel GetSupportedSimdLevel();
+
+    /// <summary>
+    /// Gets the number of lanes solved in lockstep at the given level.
+    /// </summary>
+	int GetSimdWidth(SimdLevel level);
+}
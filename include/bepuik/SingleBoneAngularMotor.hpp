@@ -28,6 +28,6 @@ namespace BEPUik
         /// </summary>
         Quaternion TargetOrientation;
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const override;
     };
 }
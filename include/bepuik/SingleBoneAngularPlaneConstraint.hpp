@@ -35,7 +35,7 @@ namespace BEPUik
         /// </summary>
         Vector3 BoneLocalAxis;
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const override;
 
 
     };
@@ -21,6 +21,17 @@
 namespace BEPUik
 {
 	class Bone;
+
+    /// <summary>
+    /// Jacobians and velocity bias of a single bone constraint.
+    /// </summary>
+    struct SingleBoneJacobians
+    {
+        Matrix3x3 linear;
+        Matrix3x3 angular;
+        Vector3 velocityBias {0.f,0.f,0.f};
+    };
+
     class SingleBoneConstraint : public IKConstraint
     {
 	public:
@@ -38,7 +49,21 @@ namespace BEPUik
 
         Vector3 accumulatedImpulse;
 
+        /// <summary>
+        /// Computes the jacobians and velocity bias of the constraint for the given pose of the target bone.
+        /// This does not modify the constraint, so the same constraint can be evaluated for the bones of several rig instances.
+        /// </summary>
+        /// <param name="position">Position of the target bone.</param>
+        /// <param name="orientation">Orientation of the target bone.</param>
+        /// <param name="jacobians">Receives the computed jacobians and velocity bias.</param>
+        /// <remarks>
+        /// Custom constraints which only override UpdateJacobiansAndVelocityBias keep working: the default implementation runs that override
+        /// and copies the constraint's jacobians out, so it can only be evaluated for the current pose of the target bone.
+        /// Every constraint must override at least one of the two.
+        /// </remarks>
+        virtual void ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const;
 
+        virtual void UpdateJacobiansAndVelocityBias() override;
 
 
         virtual void ComputeEffectiveMass() override;
@@ -49,5 +74,10 @@ namespace BEPUik
 
         virtual void ClearAccumulatedImpulses() override;
 
+        /// <summary>
+        /// Scales the accumulated impulse. Used to decay impulses that are kept between solves.
+        /// </summary>
+        void ScaleAccumulatedImpulses(float scale);
+
     };
 }
@@ -36,7 +36,7 @@ namespace BEPUik
         Vector3 GetOffset() const;
         void SetOffset(const Vector3 &value);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const override;
 
 
     };
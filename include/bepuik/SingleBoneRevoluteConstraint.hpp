@@ -38,7 +38,7 @@ namespace BEPUik
         /// </summary>
         Vector3 BoneLocalFreeAxis;
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const override;
 
 
     };
@@ -0,0 +1,133 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+
+//Instrumentation of IKSolver is compiled out unless BEPUIK_ENABLE_STATS is defined.
+//The types below are always available so code using them builds either way; without the define the statistics simply stay zeroed and the callback is never invoked.
+#ifdef BEPUIK_ENABLE_STATS
+#define BEPUIK_STATS(statement) statement
+#else
+#define BEPUIK_STATS(statement)
+#endif
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Stage of an IKSolver solve. Apart from the active set update and the preparation, every phase runs once per position iteration.
+    /// </summary>
+	enum class SolvePhase : uint8_t
+	{
+        /// <summary>
+        /// Rebuilding or validating the active set.
+        /// </summary>
+		ActiveSetUpdate = 0,
+        /// <summary>
+        /// Building joint batches or colorings, restoring kept impulses and preupdating joints and controls.
+        /// </summary>
+		Preparation,
+        /// <summary>
+        /// Updating the world inertia tensors of the bones.
+        /// </summary>
+		InertiaTensorUpdate,
+        /// <summary>
+        /// Updating the jacobians and effective masses of the joints and warm starting them.
+        /// </summary>
+		JointUpdate,
+        /// <summary>
+        /// Updating the jacobians and effective masses of the controls and warm starting them.
+        /// </summary>
+		ControlUpdate,
+        /// <summary>
+        /// Velocity subiterations of the joints and controls.
+        /// </summary>
+		VelocitySolve,
+        /// <summary>
+        /// Integrating the bone positions and orientations.
+        /// </summary>
+		Integration,
+        /// <summary>
+        /// Iterations of the islands when UseIslands is enabled. The islands may run concurrently, so their inner phases aren't reported separately.
+        /// </summary>
+		IslandSolve,
+		Count
+	};
+
+    /// <summary>
+    /// Gets a short, stable name for the phase, suitable as a profiler zone name.
+    /// </summary>
+	const char *GetSolvePhaseName(SolvePhase phase);
+
+    /// <summary>
+    /// Invoked when the solver enters (begin is true) and leaves (begin is false) a phase.
+    /// Begin and end events are properly nested and always come in pairs, so they can be forwarded to zone based profilers.
+    /// </summary>
+	using SolvePhaseCallback = std::function<void(SolvePhase phase, bool begin)>;
+
+    /// <summary>
+    /// Statistics recorded by an IKSolver over its last solve.
+    /// </summary>
+	struct SolverStats
+	{
+        /// <summary>
+        /// Accumulated wall clock time spent in each phase, in seconds. Indexed by SolvePhase.
+        /// </summary>
+		double phaseSeconds[static_cast<size_t>(SolvePhase::Count)] = {};
+        /// <summary>
+        /// Wall clock time of the whole solve, in seconds.
+        /// </summary>
+		double totalSeconds = 0;
+		int controlIterationCount = 0;
+		int fixerIterationCount = 0;
+		size_t activeBoneCount = 0;
+		size_t activeJointCount = 0;
+		size_t controlCount = 0;
+		size_t islandCount = 0;
+        /// <summary>
+        /// Largest distance or angle in radians that any bone moved during the last control iteration.
+        /// This approaches zero as the controls and joints converge. With islands, the largest residual of any island.
+        /// </summary>
+		float controlResidual = 0;
+        /// <summary>
+        /// Largest distance or angle in radians that any bone moved during the last fixer iteration.
+        /// </summary>
+		float fixerResidual = 0;
+
+		double GetPhaseSeconds(SolvePhase phase) const {return phaseSeconds[static_cast<size_t>(phase)];}
+		void Reset();
+	};
+
+    /// <summary>
+    /// Scope measuring the time spent in a solver phase and reporting its boundaries to the phase callback.
+    /// </summary>
+	class SolvePhaseScope
+	{
+	public:
+		SolvePhaseScope(SolverStats &stats, const SolvePhaseCallback &callback, SolvePhase phase);
+		SolvePhaseScope(const SolvePhaseScope&)=delete;
+		SolvePhaseScope &operator=(const SolvePhaseScope&)=delete;
+		~SolvePhaseScope();
+	private:
+		SolverStats &m_stats;
+		const SolvePhaseCallback &m_callback;
+		SolvePhase m_phase;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/BoneStore.hpp"
+#include <vector>
+
+namespace BEPUik
+{
+	class Bone;
+	class Control;
+	class SingleBoneLinearMotor;
+
+    /// <summary>
+    /// Places two bone limbs that are pulled on by a control analytically, so that the iterative solve starts close to the goal.
+    /// </summary>
+    /// <remarks>
+    /// A limb is an upper and a lower bone connected to each other by a ball socket joint and a revolute or swivel hinge joint,
+    /// with the upper bone connected to a root bone by a ball socket joint. The control either targets the lower bone, or a leaf bone
+    /// attached to the end of the lower bone by a ball socket joint, which is then carried along without being rotated.
+    /// None of the limb bones may be connected to any other bones. The limb is bent in the plane of its current bend,
+    /// falling back to the hinge axis if the limb is straight, and the root is never moved. Limits are ignored; the iterative solve takes care of them.
+    /// </remarks>
+    class TwoBonePresolver
+    {
+	public:
+        /// <summary>
+        /// Finds the limbs driven by the given controls and rotates them so that the control goals are reached as closely as the limb lengths allow.
+        /// Modifies the poses in the store and of the bones themselves.
+        /// </summary>
+        /// <param name="controls">Controls of the solve.</param>
+        /// <param name="bones">Store of the active set built for the controls.</param>
+        /// <returns>Number of limbs that were placed.</returns>
+        int Apply(const std::vector<Control*> &controls, BoneStore &bones);
+	private:
+        struct Limb
+        {
+            SingleBoneLinearMotor *motor = nullptr;
+            BoneHandle root = InvalidBoneHandle;
+            BoneHandle upper = InvalidBoneHandle;
+            BoneHandle lower = InvalidBoneHandle;
+            //Leaf bone holding the control target, or InvalidBoneHandle if the control targets the lower bone.
+            BoneHandle carried = InvalidBoneHandle;
+            //Joint anchors in the local space of the bone named first.
+            Vector3 rootShoulder;
+            Vector3 upperShoulder;
+            Vector3 upperElbow;
+            Vector3 lowerElbow;
+            //Either the control's target point or the anchor of the carried bone.
+            Vector3 lowerEnd;
+            Vector3 carriedWrist;
+            //Free axis of the elbow hinge in the local space of hingeBone.
+            BoneHandle hingeBone = InvalidBoneHandle;
+            Vector3 hingeAxis;
+        };
+
+        std::vector<BoneHandle> placedLowerBones;
+
+        static bool FindLimb(Control &control, const BoneStore &bones, Limb &limb);
+        static void PlaceLimb(const Limb &limb, BoneStore &bones);
+    };
+}
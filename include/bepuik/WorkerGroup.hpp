@@ -0,0 +1,74 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cinttypes>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Fixed set of threads for data parallel loops within a single solve.
+    /// Work is partitioned statically, so the same index always runs on the same worker for a given thread count.
+    /// </summary>
+    class WorkerGroup
+    {
+	public:
+        /// <summary>
+        /// Constructs a new worker group.
+        /// </summary>
+        /// <param name="threadCount">Number of threads running loop bodies, including the thread calling ParallelFor. 0 uses the hardware concurrency.</param>
+        explicit WorkerGroup(uint32_t threadCount = 0);
+		WorkerGroup(const WorkerGroup&)=delete;
+		WorkerGroup &operator=(const WorkerGroup&)=delete;
+        ~WorkerGroup();
+
+        /// <summary>
+        /// Gets the number of threads running loop bodies, including the thread calling ParallelFor.
+        /// </summary>
+        uint32_t GetThreadCount() const;
+
+        /// <summary>
+        /// Splits [0, count) into one contiguous range per thread and runs the body on each range, blocking until all ranges are done.
+        /// If a body throws, the first exception is rethrown once all threads are done.
+        /// </summary>
+        /// <param name="count">Number of elements to process.</param>
+        /// <param name="body">Called with the begin and end of each range and the index of the worker running it.</param>
+        void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end, uint32_t workerIndex)> &body);
+	private:
+        void RunRange(uint32_t workerIndex);
+        void WorkerMain(uint32_t workerIndex);
+
+        uint32_t m_threadCount = 1;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_startCondition;
+        uint64_t m_generation = 0;
+        bool m_shutdown = false;
+
+        const std::function<void(size_t, size_t, uint32_t)> *m_body = nullptr;
+        size_t m_count = 0;
+        std::exception_ptr m_exception;
+        alignas(64) std::atomic<uint32_t> m_pendingThreads {0};
+    };
+}
@@ -19,6 +19,7 @@
 
 namespace BEPUik
 {
+	class SingleBoneLinearMotor;
 	/// <summary>
 	/// Constrains an individual bone in an attempt to reach some goal.
 	/// Controls act as groups of single bone constraints. They are used
@@ -28,7 +29,7 @@ namespace BEPUik
 	{
 	public:
 		Control() = default;
-		Control(const Control*) = delete;
+		Control(const Control&) = delete;
 		Control& operator=(const Control&) = delete;
 		virtual ~Control() {}
 		/// <summary>
@@ -37,6 +38,11 @@ namespace BEPUik
 		virtual Bone* GetTargetBone() = 0;
 		virtual void SetTargetBone(Bone* bone) = 0;
 
+		/// <summary>
+		/// Gets the motor pulling a point on the target bone towards a goal position, or nullptr if the control has no positional goal.
+		/// </summary>
+		virtual SingleBoneLinearMotor* GetLinearMotor() { return nullptr; }
+
 		virtual void Preupdate(float dt, float updateRate) = 0;
 
 		virtual void UpdateJacobiansAndVelocityBias() = 0;
@@ -49,6 +55,13 @@ namespace BEPUik
 
 		virtual void ClearAccumulatedImpulses() = 0;
 
+		/// <summary>
+		/// Scales the accumulated impulses in place of clearing them when they are kept between solves.
+		/// Controls that don't override this fall back to clearing their impulses.
+		/// </summary>
+		/// <param name="scale">Fraction of the impulses to keep.</param>
+		virtual void ScaleAccumulatedImpulses([[maybe_unused]] float scale) { ClearAccumulatedImpulses(); }
+
 		virtual float GetMaximumForce() const = 0;
 
 		virtual void SetMaximumForce(float value) = 0;
@@ -16,12 +16,12 @@
 #pragma once
 
 #include "bepuik/control/Control.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
 #include <memory>
 #include <optional>
 
 namespace BEPUik
 {
-	class SingleBoneLinearMotor;
 	/// <summary>
 	/// Constrains an individual bone in an attempt to reach some position goal.
 	/// </summary>
@@ -37,9 +37,10 @@ namespace BEPUik
 
 		/// <summary>
 		/// Gets or sets the linear motor used by the control.
+		/// The default motor is embedded in the control so that both are allocated together. SetLinearMotor replaces it with a motor owned by the control.
 		/// </summary>
-		std::unique_ptr<SingleBoneLinearMotor> LinearMotor;
-		SingleBoneLinearMotor* GetLinearMotor();
+		SingleBoneLinearMotor *LinearMotor;
+		SingleBoneLinearMotor* GetLinearMotor() override;
 		void SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value);
 
 		DragControl();
@@ -56,11 +57,16 @@ namespace BEPUik
 
 		virtual void ClearAccumulatedImpulses() override;
 
+		virtual void ScaleAccumulatedImpulses(float scale) override;
+
 		virtual float GetMaximumForce() const override;
 		virtual void SetMaximumForce(float value) override;
 
 		virtual float GetRigidity() const override;
 		virtual void SetRigidity(float rigidity) override;
+	private:
+		SingleBoneLinearMotor m_linearMotor;
+		std::unique_ptr<SingleBoneLinearMotor> m_customLinearMotor;
 	};
 
 	/// <summary>
@@ -71,6 +77,7 @@ namespace BEPUik
 	{
 	public:
 		virtual void ClearAccumulatedImpulses() override;
+		virtual void ScaleAccumulatedImpulses(float scale) override;
 
 		void SetTargetOrientation(const Quaternion& orientation);
 		const Quaternion& GetTargetOrientation() const;
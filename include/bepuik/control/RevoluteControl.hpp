@@ -16,11 +16,11 @@
 #pragma once
 
 #include "bepuik/control/Control.hpp"
+#include "bepuik/SingleBoneRevoluteConstraint.hpp"
 #include <memory>
 
 namespace BEPUik
 {
-	class SingleBoneRevoluteConstraint;
     /// <summary>
     /// Constrains an individual bone in an attempt to keep a bone-attached axis aligned with a specified world axis.
     /// </summary>
@@ -35,9 +35,10 @@ namespace BEPUik
         virtual void SetTargetBone(Bone *value) override;
 
         /// <summary>
-        /// Gets or sets the linear motor used by the control.
+        /// Gets or sets the angular motor used by the control.
+        /// The default motor is embedded in the control so that both are allocated together. SetAngularMotor replaces it with a motor owned by the control.
         /// </summary>
-        std::unique_ptr<SingleBoneRevoluteConstraint> AngularMotor;
+        SingleBoneRevoluteConstraint *AngularMotor;
 		SingleBoneRevoluteConstraint *GetAngularMotor();
 		void SetAngularMotor(std::unique_ptr<SingleBoneRevoluteConstraint> value);
 
@@ -55,7 +56,12 @@ namespace BEPUik
 
         virtual void ClearAccumulatedImpulses() override;
 
+        virtual void ScaleAccumulatedImpulses(float scale) override;
+
         virtual float GetMaximumForce() const override;
         virtual void SetMaximumForce(float value) override;
+	private:
+		SingleBoneRevoluteConstraint m_angularMotor;
+		std::unique_ptr<SingleBoneRevoluteConstraint> m_customAngularMotor;
     };
 }
\ No newline at end of file
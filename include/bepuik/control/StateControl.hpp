@@ -16,13 +16,13 @@
 #pragma once
 
 #include "bepuik/control/Control.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
+#include "bepuik/SingleBoneAngularMotor.hpp"
 #include "bepuik/Bone.hpp"
 #include <memory>
 
 namespace BEPUik
 {
-	class SingleBoneLinearMotor;
-	class SingleBoneAngularMotor;
     /// <summary>
     /// Constrains an individual bone in an attempt to reach some position and orientation goal.
     /// </summary>
@@ -39,15 +39,16 @@ namespace BEPUik
 
         /// <summary>
         /// Gets the linear motor used by the control.
+        /// The default motors are embedded in the control so that they are allocated together. The setters replace them with motors owned by the control.
         /// </summary>
-		std::unique_ptr<SingleBoneLinearMotor> LinearMotor;
-		SingleBoneLinearMotor *GetLinearMotor();
+		SingleBoneLinearMotor *LinearMotor;
+		SingleBoneLinearMotor *GetLinearMotor() override;
 		void SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value);
 
         /// <summary>
         /// Gets the angular motor used by the control.
         /// </summary>
-		std::unique_ptr<SingleBoneAngularMotor> AngularMotor;
+		SingleBoneAngularMotor *AngularMotor;
 		SingleBoneAngularMotor *GetAngularMotor();
 		void SetAngularMotor(std::unique_ptr<SingleBoneAngularMotor> value);
 
@@ -66,10 +67,17 @@ namespace BEPUik
 
         virtual void ClearAccumulatedImpulses() override;
 
+        virtual void ScaleAccumulatedImpulses(float scale) override;
+
 		virtual float GetMaximumForce() const override;
 		virtual void SetMaximumForce(float value) override;
 
 		virtual float GetRigidity() const override;
 		virtual void SetRigidity(float rigidity) override;
+	private:
+		SingleBoneLinearMotor m_linearMotor;
+		SingleBoneAngularMotor m_angularMotor;
+		std::unique_ptr<SingleBoneLinearMotor> m_customLinearMotor;
+		std::unique_ptr<SingleBoneAngularMotor> m_customAngularMotor;
     };
 }
\ No newline at end of file
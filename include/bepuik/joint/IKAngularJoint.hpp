@@ -40,6 +40,6 @@ namespace BEPUik
         /// <param name="connectionB">Second bone to connect to the joint.</param>
         IKAngularJoint(Bone &connectionA, Bone &connectionB);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
@@ -52,7 +52,7 @@ namespace BEPUik
         /// <param name="anchor">World space anchor location used to initialize the local anchors.</param>
         IKBallSocketJoint(Bone &connectionA, Bone &connectionB, const Vector3 &anchor);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
 
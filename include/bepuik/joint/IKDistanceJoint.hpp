@@ -62,6 +62,6 @@ namespace BEPUik
         /// <param name="anchorB">Anchor point on the second bone in world space.</param>
         IKDistanceJoint(Bone &connectionA, Bone &connectionB, const Vector3 &anchorA, const Vector3 &anchorB);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
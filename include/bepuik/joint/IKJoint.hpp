@@ -21,6 +21,18 @@
 
 namespace BEPUik
 {
+    /// <summary>
+    /// Jacobians and velocity bias of a two bone constraint, as computed from the current bone states.
+    /// </summary>
+    struct JointJacobians
+    {
+        Matrix3x3 linearA;
+        Matrix3x3 angularA;
+        Matrix3x3 linearB;
+        Matrix3x3 angularB;
+        Vector3 velocityBias {0.f,0.f,0.f};
+    };
+
     /// <summary>
     /// Connects two bones together.
     /// </summary>
@@ -44,6 +56,7 @@ namespace BEPUik
 		Bone *m_connectionA;
 		Bone *m_connectionB;
         bool m_enabled = false;
+        int m_degreesOfFreedom = 3;
         /// <summary>
         /// Gets or sets whether or not this joint is enabled. If set to true, this joint will be a part of
         /// the joint graph and will undergo solving. If set to false, this joint will be removed from the connected bones and will no longer be traversable.
@@ -51,7 +64,32 @@ namespace BEPUik
 		bool GetEnabled() const;
 		void SetEnabled(bool value);
 
-        IKJoint(Bone &connectionA, Bone &connectionB);
+        /// <summary>
+        /// Constructs a joint between two bones.
+        /// </summary>
+        /// <param name="connectionA">First bone connected by the joint.</param>
+        /// <param name="connectionB">Second bone connected by the joint.</param>
+        /// <param name="degreesOfFreedom">Number of degrees of freedom removed by the joint, between 1 and 3.
+        /// Jacobians of joints with fewer than three degrees of freedom only use the leading rows of their matrices.</param>
+        IKJoint(Bone &connectionA, Bone &connectionB, int degreesOfFreedom = 3);
+
+        /// <summary>
+        /// Gets the number of degrees of freedom removed by the joint. This is the number of jacobian rows the joint fills.
+        /// </summary>
+        int GetDegreesOfFreedom() const;
+
+        /// <summary>
+        /// Store containing the solver state of the connected bones and the handles of the connections within it.
+        /// These are refreshed by the active set whenever it is rebuilt so the solver loops don't have to go through the bones.
+        /// </summary>
+        BoneStore *m_boneStore = nullptr;
+        BoneHandle m_handleA = InvalidBoneHandle;
+        BoneHandle m_handleB = InvalidBoneHandle;
+
+        /// <summary>
+        /// Caches the store and handles of the connected bones. Both connections must be bound to the same store.
+        /// </summary>
+        void BindBoneStore();
 
 
 
@@ -64,9 +102,22 @@ namespace BEPUik
 
 		Vector3 accumulatedImpulse {0.f,0.f,0.f};
 
-
-
-
+        /// <summary>
+        /// Computes the jacobians and velocity bias of the joint from the bone states in the given store.
+        /// This does not modify the joint, so the batched solver can evaluate it for packed constraint data as well.
+        /// </summary>
+        /// <param name="bones">Store containing the states of the connected bones.</param>
+        /// <param name="handleA">Handle of ConnectionA within the store.</param>
+        /// <param name="handleB">Handle of ConnectionB within the store.</param>
+        /// <param name="jacobians">Receives the computed jacobians and velocity bias.</param>
+        /// <remarks>
+        /// Custom joints which only override UpdateJacobiansAndVelocityBias keep working: the default implementation runs that override
+        /// and copies the joint's jacobians out, so it can only be evaluated for the joint's own store and handles.
+        /// Every joint must override at least one of the two.
+        /// </remarks>
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const;
+
+        virtual void UpdateJacobiansAndVelocityBias() override;
 
         virtual void ComputeEffectiveMass() override;
 
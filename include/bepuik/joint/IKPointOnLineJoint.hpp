@@ -76,6 +76,6 @@ namespace BEPUik
         /// <param name="anchorB">Anchor point on the second bone in world space which tries to stay on connection A's line.</param>
         IKPointOnLineJoint(Bone &connectionA, Bone &connectionB, const Vector3 &lineAnchor, const Vector3 &lineDirection, const Vector3 &anchorB);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
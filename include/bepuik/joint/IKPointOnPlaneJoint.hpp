@@ -70,6 +70,6 @@ namespace BEPUik
         /// <param name="anchorB">Anchor point on the second bone in world space which is measured against the other connection's anchor.</param>
         IKPointOnPlaneJoint(Bone &connectionA, Bone &connectionB, const Vector3 &planeAnchor, const Vector3 &planeNormal, const Vector3 &anchorB);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
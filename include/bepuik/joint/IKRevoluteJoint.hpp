@@ -67,6 +67,6 @@ namespace BEPUik
         /// <param name="freeAxis">Axis allowed to rotate freely in world space.</param>
         IKRevoluteJoint(Bone &connectionA, Bone &connectionB, const Vector3 &freeAxis);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
@@ -55,6 +55,6 @@ namespace BEPUik
         /// The connected bones will be able to rotate around this axis relative to each other.</param>
         IKSwivelHingeJoint(Bone &connectionA, Bone &connectionB, const Vector3 &worldHingeAxis, const Vector3 &worldTwistAxis);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
@@ -93,6 +93,6 @@ namespace BEPUik
         /// <param name="axisB">Axis attached to connectionB in world space.</param>
         IKTwistJoint(Bone &connectionA, Bone &connectionB, const Vector3 &axisA, const Vector3 &axisB);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
@@ -71,6 +71,6 @@ namespace BEPUik
         /// <param name="maximumDistance">Maximum distance that the joint connections should be kept from each other.</param>
         IKDistanceLimit(Bone &connectionA, Bone &connectionB, const Vector3 &anchorA, const Vector3 &anchorB, float minimumDistance, float maximumDistance);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
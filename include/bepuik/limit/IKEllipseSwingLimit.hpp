@@ -93,9 +93,10 @@ namespace BEPUik
 
 		IKEllipseSwingLimit(Bone& connectionA, Bone& connectionB, const Vector3& axisA, const Vector3& axisB, const Vector3 &axisBRight, const Vector3 &axisBUp, float maximumAngleX, float maximumAngleY);
 
-		virtual void UpdateJacobiansAndVelocityBias() override;
+		virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
 
 	private:
+		friend class IKRigTemplate;
 		float maximumAngleX;
 		float maximumAngleY;
 		Vector3 xAxis;
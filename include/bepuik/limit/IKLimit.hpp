@@ -25,7 +25,7 @@ namespace BEPUik
     class IKLimit : public IKJoint
     {
 	public:
-        IKLimit(Bone &connectionA, Bone &connectionB);
+        IKLimit(Bone &connectionA, Bone &connectionB, int degreesOfFreedom = 3);
 		virtual ~IKLimit() {};
 
         virtual void SolveVelocityIteration() override;
@@ -101,6 +101,6 @@ namespace BEPUik
         /// <param name="maximumAngle">Maximum angle allowed between connectionA's axis and connectionB's axis.</param>
         IKTwistLimit(Bone &connectionA, Bone &connectionB, const Vector3 &axisA, const Vector3 &axisB, float maximumAngle);
 
-        virtual void UpdateJacobiansAndVelocityBias() override;
+        virtual void ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const override;
     };
 }
@@ -17,10 +17,30 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include <cmath>
 #include <glm/vec3.hpp>
 #include <glm/gtx/norm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
+#ifdef BEPUIK_MATH_USE_GLM
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#endif
+
+// The math helpers below are defined inline in bepuik/math_inline.hpp so that they can be inlined into the solver loops.
+// By default they use the hand-written BEPU formulas. Defining BEPUIK_MATH_USE_GLM routes the matrix and quaternion helpers
+// through the GLM operators instead, which lets GLM's own SIMD code paths (e.g. GLM_FORCE_INTRINSICS) do the work.
+// Results then differ from the BEPU formulas in the last bits of precision.
+// Defining BEPUIK_DETERMINISTIC keeps the normalization helpers on the BEPU formulas even with BEPUIK_MATH_USE_GLM,
+// since GLM may implement them with approximate reciprocal square roots.
+#if defined(_MSC_VER)
+#define BEPUIK_FORCEINLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define BEPUIK_FORCEINLINE inline __attribute__((always_inline))
+#else
+#define BEPUIK_FORCEINLINE inline
+#endif
 
 namespace BEPUik
 {
@@ -54,31 +74,50 @@ namespace BEPUik
 	/// </summary>
 	constexpr float PiOver4 = 0.785398163397448310f;
 
-	float lerp(float x, float y, float f);
+	BEPUIK_FORCEINLINE float lerp(float x, float y, float f);
+
+	/// <summary>
+	/// Computes the square root of a value in single precision.
+	/// IEEE 754 requires the square root to be correctly rounded, so the result is the same on every platform.
+	/// </summary>
+	BEPUIK_FORCEINLINE float Sqrt(float x);
+
+	/// <summary>
+	/// Computes the arc cosine of a value in [-1, 1].
+	/// Forwards to std::acos, unless BEPUIK_DETERMINISTIC is defined, in which case PortableAcos is used.
+	/// </summary>
+	BEPUIK_FORCEINLINE float Acos(float x);
+
+	/// <summary>
+	/// Computes the arc cosine of a value in [-1, 1] using only basic arithmetic and a square root.
+	/// The last bits of std::acos differ between C libraries; this version gives the same result on every platform with IEEE 754 single precision arithmetic.
+	/// Accurate to a few units in the last place.
+	/// </summary>
+	float PortableAcos(float x);
 	Vector2 ellipse_line_intersection(float rx, float ry, Vector2 p2);
 
 	namespace matrix
 	{
-		Matrix3x3 Create(float value);
+		BEPUIK_FORCEINLINE Matrix3x3 Create(float value);
 
 		/// <summary>
 		/// Creates an empty matrix.
 		/// </summary>
 		/// <param name="result">Reference to store the identity matrix in.</param>
-		Matrix3x3 Create();
+		BEPUIK_FORCEINLINE Matrix3x3 Create();
 
 		/// <summary>
 		/// Creates an identity matrix.
 		/// </summary>
 		/// <param name="result">Reference to store the identity matrix in.</param>
-		Matrix3x3 GetIdentity();
+		BEPUIK_FORCEINLINE Matrix3x3 GetIdentity();
 
 		/// <summary>
 		/// Constructs a uniform scaling matrix.
 		/// </summary>
 		/// <param name="scale">Value to use in the diagonal.</param>
 		/// <param name="matrix">Scaling matrix.</param>
-		Matrix3x3 CreateScale(float scale);
+		BEPUIK_FORCEINLINE Matrix3x3 CreateScale(float scale);
 
 		/// <summary>
 		/// Scales the matrix.
@@ -86,7 +125,7 @@ namespace BEPUik
 		/// <param name="matrix">Matrix to scale.</param>
 		/// <param name="scale">Amount to scale.</param>
 		/// <param name="result">Scaled matrix.</param>
-		Matrix3x3 Multiply(const Matrix3x3& a, const Matrix3x3& b);
+		BEPUIK_FORCEINLINE Matrix3x3 Multiply(const Matrix3x3& a, const Matrix3x3& b);
 
 		/// <summary>
 		/// Multiplies a matrix with a transposed matrix.
@@ -94,7 +133,7 @@ namespace BEPUik
 		/// <param name="matrix">Matrix to be multiplied.</param>
 		/// <param name="transpose">Matrix to be transposed and multiplied.</param>
 		/// <param name="result">Product of the multiplication.</param>
-		Matrix3x3 MultiplyByTransposed(const Matrix3x3& matrix, const Matrix3x3& transpose);
+		BEPUIK_FORCEINLINE Matrix3x3 MultiplyByTransposed(const Matrix3x3& matrix, const Matrix3x3& transpose);
 
 		/// <summary>
 		/// Adds the two matrices together on a per-element basis.
@@ -102,7 +141,7 @@ namespace BEPUik
 		/// <param name="a">First matrix to add.</param>
 		/// <param name="b">Second matrix to add.</param>
 		/// <param name="result">Sum of the two matrices.</param>
-		Matrix3x3 Add(const Matrix3x3& a, const Matrix3x3& b);
+		BEPUIK_FORCEINLINE Matrix3x3 Add(const Matrix3x3& a, const Matrix3x3& b);
 
 		/// <summary>
 		/// Inverts the largest nonsingular submatrix in the matrix, excluding 2x2's that involve M13 or M31, and excluding 1x1's that include nondiagonal elements.
@@ -117,7 +156,7 @@ namespace BEPUik
 		/// <param name="v">Vector3 to transform.</param>
 		/// <param name="matrix">Matrix to use as the transformation.</param>
 		/// <param name="result">Product of the transformation.</param>
-		Vector3 Transform(const Vector3& v, const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Vector3 Transform(const Vector3& v, const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Transforms the vector by the matrix's transpose.
@@ -125,42 +164,42 @@ namespace BEPUik
 		/// <param name="v">Vector3 to transform.</param>
 		/// <param name="matrix">Matrix to use as the transformation transpose.</param>
 		/// <param name="result">Product of the transformation.</param>
-		Vector3 TransformTranspose(const Vector3& v, const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Vector3 TransformTranspose(const Vector3& v, const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Creates a skew symmetric matrix M from vector A such that M * B for some other vector B is equivalent to the cross product of A and B.
 		/// </summary>
 		/// <param name="v">Vector to base the matrix on.</param>
 		/// <param name="result">Skew-symmetric matrix result.</param>
-		Matrix3x3 CreateCrossProduct(const Vector3& v);
+		BEPUIK_FORCEINLINE Matrix3x3 CreateCrossProduct(const Vector3& v);
 
 		/// <summary>
 		/// Computes the transposed matrix of a matrix.
 		/// </summary>
 		/// <param name="matrix">Matrix to transpose.</param>
 		/// <param name="result">Transposed matrix.</param>
-		Matrix3x3 Transpose(const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Matrix3x3 Transpose(const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Negates every element in the matrix.
 		/// </summary>
 		/// <param name="matrix">Matrix to negate.</param>
 		/// <param name="result">Negated matrix.</param>
-		Matrix3x3 Negate(const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Matrix3x3 Negate(const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Inverts the given matix.
 		/// </summary>
 		/// <param name="matrix">Matrix to be inverted.</param>
 		/// <param name="result">Inverted matrix.</param>
-		Matrix3x3 Invert(const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Matrix3x3 Invert(const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Creates a 3x3 matrix representing the orientation stored in the quaternion.
 		/// </summary>
 		/// <param name="quaternion">Quaternion to use to create a matrix.</param>
 		/// <param name="result">Matrix representing the quaternion's orientation.</param>
-		Matrix3x3 CreateFromQuaternion(const Quaternion& quaternion);
+		BEPUIK_FORCEINLINE Matrix3x3 CreateFromQuaternion(const Quaternion& quaternion);
 
 		/// <summary>
 		/// Multiplies a transposed matrix with another matrix.
@@ -168,13 +207,13 @@ namespace BEPUik
 		/// <param name="matrix">Matrix to be multiplied.</param>
 		/// <param name="transpose">Matrix to be transposed and multiplied.</param>
 		/// <param name="result">Product of the multiplication.</param>
-		Matrix3x3 MultiplyTransposed(const Matrix3x3& transpose, const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE Matrix3x3 MultiplyTransposed(const Matrix3x3& transpose, const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Calculates the determinant of the matrix.
 		/// </summary>
 		/// <returns>The matrix's determinant.</returns>
-		float Determinant(const Matrix3x3& matrix);
+		BEPUIK_FORCEINLINE float Determinant(const Matrix3x3& matrix);
 
 		/// <summary>
 		/// Calculates the determinant of largest nonsingular submatrix, excluding 2x2's that involve M13 or M31, and excluding all 1x1's that involve nondiagonal elements.
@@ -188,7 +227,7 @@ namespace BEPUik
 
 	namespace vector2
 	{
-		float Length(const Vector2& v);
+		BEPUIK_FORCEINLINE float Length(const Vector2& v);
 	};
 
 	namespace vector3
@@ -199,7 +238,7 @@ namespace BEPUik
 		/// <param name="a">First vector to add.</param>
 		/// <param name="b">Second vector to add.</param>
 		/// <param name="sum">Sum of the two vectors.</param>
-		Vector3 Create();
+		BEPUIK_FORCEINLINE Vector3 Create();
 
 		/// <summary>
 		/// Adds two vectors together.
@@ -207,7 +246,7 @@ namespace BEPUik
 		/// <param name="a">First vector to add.</param>
 		/// <param name="b">Second vector to add.</param>
 		/// <param name="sum">Sum of the two vectors.</param>
-		Vector3 Add(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE Vector3 Add(const Vector3& a, const Vector3& b);
 
 		/// <summary>
 		/// Subtracts two vectors.
@@ -215,7 +254,7 @@ namespace BEPUik
 		/// <param name="a">Vector to subtract from.</param>
 		/// <param name="b">Vector to subtract from the first vector.</param>
 		/// <param name="difference">Result of the subtraction.</param>
-		Vector3 Subtract(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE Vector3 Subtract(const Vector3& a, const Vector3& b);
 
 		/// <summary>
 		/// Scales a vector.
@@ -223,14 +262,14 @@ namespace BEPUik
 		/// <param name="v">Vector to scale.</param>
 		/// <param name="scale">Amount to scale.</param>
 		/// <param name="result">Scaled vector.</param>
-		Vector3 Multiply(const Vector3& v, float scale);
+		BEPUIK_FORCEINLINE Vector3 Multiply(const Vector3& v, float scale);
 
 		/// <summary>
 		/// Negates a vector.
 		/// </summary>
 		/// <param name="v">Vector to negate.</param>
 		/// <param name="negated">Negated vector.</param>
-		Vector3 Negate(const Vector3& v);
+		BEPUIK_FORCEINLINE Vector3 Negate(const Vector3& v);
 
 		/// <summary>
 		/// Computes the cross product between two vectors.
@@ -238,7 +277,7 @@ namespace BEPUik
 		/// <param name="a">First vector.</param>
 		/// <param name="b">Second vector.</param>
 		/// <param name="result">Cross product of the two vectors.</param>
-		Vector3 Cross(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE Vector3 Cross(const Vector3& a, const Vector3& b);
 
 		/// <summary>
 		/// Computes the dot product of two vectors.
@@ -246,7 +285,7 @@ namespace BEPUik
 		/// <param name="a">First vector in the product.</param>
 		/// <param name="b">Second vector in the product.</param>
 		/// <param name="product">Resulting dot product.</param>
-		float Dot(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE float Dot(const Vector3& a, const Vector3& b);
 
 		/// <summary>
 		/// Computes the distance between two two vectors.
@@ -254,7 +293,7 @@ namespace BEPUik
 		/// <param name="a">First vector.</param>
 		/// <param name="b">Second vector.</param>
 		/// <param name="distance">Distance between the two vectors.</param>
-		float Distance(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE float Distance(const Vector3& a, const Vector3& b);
 
 		/// <summary>
 		/// Divides a vector's components by some amount.
@@ -262,14 +301,14 @@ namespace BEPUik
 		/// <param name="v">Vector to divide.</param>
 		/// <param name="divisor">Value to divide the vector's components.</param>
 		/// <param name="result">Result of the division.</param>
-		Vector3 Divide(const Vector3& v, float divisor);
+		BEPUIK_FORCEINLINE Vector3 Divide(const Vector3& v, float divisor);
 
 		/// <summary>
 		/// Normalizes the given vector.
 		/// </summary>
 		/// <param name="v">Vector to normalize.</param>
 		/// <param name="result">Normalized vector.</param>
-		void Normalize(Vector3& v);
+		BEPUIK_FORCEINLINE void Normalize(Vector3& v);
 
 		/// <summary>
 		/// Computes a vector with the maximum components of the given vectors.
@@ -277,12 +316,12 @@ namespace BEPUik
 		/// <param name="a">First vector.</param>
 		/// <param name="b">Second vector.</param>
 		/// <param name="result">Vector with the larger components of each input vector.</param>
-		Vector3 Max(const Vector3& a, const Vector3& b);
+		BEPUIK_FORCEINLINE Vector3 Max(const Vector3& a, const Vector3& b);
 
-		float Length(const Vector3& v);
-		float LengthSqr(const Vector3& v);
+		BEPUIK_FORCEINLINE float Length(const Vector3& v);
+		BEPUIK_FORCEINLINE float LengthSqr(const Vector3& v);
 
-		Vector3 Rotate(const Quaternion& rot, const Vector3& v);
+		BEPUIK_FORCEINLINE Vector3 Rotate(const Quaternion& rot, const Vector3& v);
 
 		/// <summary>
 		/// Vector pointing in the up direction.
@@ -302,7 +341,7 @@ namespace BEPUik
 
 	namespace quaternion
 	{
-		Quaternion Create(float x, float y, float z, float w);
+		BEPUIK_FORCEINLINE Quaternion Create(float x, float y, float z, float w);
 
 		/// <summary>
 		/// Transforms the vector using a quaternion.
@@ -310,14 +349,14 @@ namespace BEPUik
 		/// <param name="v">Vector to transform.</param>
 		/// <param name="rotation">Rotation to apply to the vector.</param>
 		/// <param name="result">Transformed vector.</param>
-		Vector3 Transform(const Vector3& v, const Quaternion& rotation);
+		BEPUIK_FORCEINLINE Vector3 Transform(const Vector3& v, const Quaternion& rotation);
 
 		/// <summary>
 		/// Computes the conjugate of the quaternion.
 		/// </summary>
 		/// <param name="quaternion">Quaternion to conjugate.</param>
 		/// <param name="result">Conjugated quaternion.</param>
-		Quaternion Conjugate(const Quaternion& quaternion);
+		BEPUIK_FORCEINLINE Quaternion Conjugate(const Quaternion& quaternion);
 
 		/// <summary>
 		/// Multiplies two quaternions.
@@ -325,7 +364,7 @@ namespace BEPUik
 		/// <param name="a">First quaternion to multiply.</param>
 		/// <param name="b">Second quaternion to multiply.</param>
 		/// <param name="result">Product of the multiplication.</param>
-		Quaternion Multiply(const Quaternion& a, const Quaternion& b);
+		BEPUIK_FORCEINLINE Quaternion Multiply(const Quaternion& a, const Quaternion& b);
 
 		/// <summary>
 		/// Computes the axis angle representation of a normalized quaternion.
@@ -341,7 +380,7 @@ namespace BEPUik
 		/// <param name="a">First quaternion to multiply.</param>
 		/// <param name="b">Second quaternion to multiply.</param>
 		/// <param name="result">Product of the multiplication.</param>
-		Quaternion Concatenate(const Quaternion& a, const Quaternion& b);
+		BEPUIK_FORCEINLINE Quaternion Concatenate(const Quaternion& a, const Quaternion& b);
 
 		/// <summary>
 		/// Computes the quaternion rotation between two normalized vectors.
@@ -354,7 +393,7 @@ namespace BEPUik
 		/// <summary>
 		/// Scales the quaternion such that it has unit length.
 		/// </summary>
-		void Normalize(Quaternion& q);
+		BEPUIK_FORCEINLINE void Normalize(Quaternion& q);
 
 		/// <summary>
 		/// Adds two quaternions together.
@@ -362,10 +401,12 @@ namespace BEPUik
 		/// <param name="a">First quaternion to add.</param>
 		/// <param name="b">Second quaternion to add.</param>
 		/// <param name="result">Sum of the addition.</param>
-		Quaternion Add(const Quaternion& a, const Quaternion& b);
+		BEPUIK_FORCEINLINE Quaternion Add(const Quaternion& a, const Quaternion& b);
 
-		Quaternion Inverse(const Quaternion& quaternion);
+		BEPUIK_FORCEINLINE Quaternion Inverse(const Quaternion& quaternion);
 	};
 
 	const Quaternion quat_identity = quaternion::Create(1.f, 0.f, 0.f, 0.f);
 };
+
+#include "bepuik/math_inline.hpp"
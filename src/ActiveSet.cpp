@@ -14,6 +14,71 @@
 // limitations under the License.
 
 #include "bepuik/ActiveSet.hpp"
+#include <algorithm>
+
+void BEPUik::ActiveSet::SetScratch(ActiveSetScratch *scratch)
+{
+    m_scratch = scratch != nullptr ? scratch : &m_ownScratch;
+}
+
+void BEPUik::ActiveSet::Invalidate()
+{
+    m_cachedSource = CachedSource::None;
+}
+
+uint64_t BEPUik::ActiveSet::GetVersion() const {return m_version;}
+
+bool BEPUik::ActiveSet::IsCacheValid(CachedSource source) const
+{
+    if (!UseCaching || m_cachedSource != source)
+        return false;
+    if (m_cachedUseAutomass != UseAutomass || m_cachedAutomassUnstressedFalloff != AutomassUnstressedFalloff || m_cachedAutomassTarget != AutomassTarget)
+        return false;
+    //Any change to the graph that could alter the active set touches a bone which is already in it, either active or on its border.
+    for (size_t i = 0; i < boneStore.bones.size(); ++i)
+    {
+        if (boneStore.bones[i]->topologyVersion != m_cachedBoneVersions[i])
+            return false;
+    }
+    return true;
+}
+
+bool BEPUik::ActiveSet::IsCacheValid(const std::vector<IKJoint*> &joints) const
+{
+    if (!IsCacheValid(CachedSource::Joints) || joints != m_cachedJoints)
+        return false;
+    //A disabled joint may not share a bone with the active set, so its enabled state is checked directly.
+    for (size_t i = 0; i < joints.size(); ++i)
+    {
+        if (joints[i]->GetEnabled() != m_cachedJointsEnabled[i])
+            return false;
+    }
+    return true;
+}
+
+bool BEPUik::ActiveSet::IsCacheValid(const std::vector<Control*> &controls) const
+{
+    if (!IsCacheValid(CachedSource::Controls) || controls != m_cachedControls)
+        return false;
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        if (controls[i]->GetTargetBone() != m_cachedTargetBones[i])
+            return false;
+    }
+    return true;
+}
+
+void BEPUik::ActiveSet::CacheInputs(CachedSource source)
+{
+    ++m_version;
+    m_cachedSource = source;
+    m_cachedUseAutomass = UseAutomass;
+    m_cachedAutomassUnstressedFalloff = AutomassUnstressedFalloff;
+    m_cachedAutomassTarget = AutomassTarget;
+    m_cachedBoneVersions.clear();
+	for(auto *bone : boneStore.bones)
+        m_cachedBoneVersions.push_back(bone->topologyVersion);
+}
 
 void BEPUik::ActiveSet::SetAutomassUnstressedFalloff(float value)
 {
@@ -53,8 +118,8 @@ void BEPUik::ActiveSet::FindStressedPaths(std::vector<Control*> &controls)
         {
             bone->traversed = false;
             bone->SetActive(false);
-            bone->predecessors.clear();
         }
+        ClearPredecessors();
         bones.clear();
 
         //Get rid of the targetedByOtherControl markings.
@@ -75,29 +140,143 @@ void BEPUik::ActiveSet::NotifyPredecessorsOfStress(Bone *bone)
     //We don't need to tell already-stressed bones abthe fact that they are stressed.
     //Their predecessors are already stressed either by previous notifications like this or
     //through the predecessors being added on after the fact and seeing that the path was stressed.
-    if (!bone->traversed)
+    //The set of notified bones doesn't depend on the visiting order, so a plain stack is enough.
+    auto &stack = m_scratch->notificationStack;
+    stack.push_back(bone);
+    while (!stack.empty())
     {
+        bone = stack.back();
+        stack.pop_back();
+        if (bone->traversed)
+            continue;
         bone->traversed = true;
         bone->stressCount++;
-		for(auto *predecessor : bone->predecessors)
+        for (auto link = bone->firstPredecessor; link != Bone::InvalidPredecessor; link = m_scratch->predecessorLinks[link].next)
         {
+            stack.push_back(m_scratch->predecessorLinks[link].bone);
+        }
+    }
+}
 
-            NotifyPredecessorsOfStress(predecessor);
+static size_t HashBonePair(const BEPUik::Bone *bone, const BEPUik::Bone *predecessor)
+{
+    auto hash = reinterpret_cast<uintptr_t>(bone) * 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(predecessor) * 0xC2B2AE3D27D4EB4Full;
+    return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+bool BEPUik::ActiveSet::HasPredecessor(const Bone *bone, const Bone *predecessor) const
+{
+    const auto &links = m_scratch->predecessorLinks;
+    if (bone->predecessorCount <= MaximumScannedPredecessors)
+    {
+        for (auto link = bone->firstPredecessor; link != Bone::InvalidPredecessor; link = links[link].next)
+        {
+            if (links[link].bone == predecessor)
+                return true;
         }
+        return false;
+    }
+    //Bones with many predecessors have all of their links in the hash set.
+    const auto &interactions = m_scratch->interactions;
+    auto mask = interactions.size() - 1;
+    for (auto i = HashBonePair(bone, predecessor) & mask;; i = (i + 1) & mask)
+    {
+        const auto &entry = interactions[i];
+        if (entry.generation != m_scratch->interactionGeneration)
+            return false;
+        if (entry.bone == bone && entry.predecessor == predecessor)
+            return true;
     }
 }
+
 bool BEPUik::ActiveSet::BonesHaveInteracted(Bone* bone, Bone* childBone)
 {
 	//Two bones have interacted if one includes the other in its predecessor list.
-	return find(bone->predecessors.begin(), bone->predecessors.end(), childBone) != bone->predecessors.end() ||//childBone is a parent of bone. Don't revisit them, that's where we came from!
-		find(childBone->predecessors.begin(), childBone->predecessors.end(), bone) != childBone->predecessors.end(); //This bone already explored the childBone; don't do it again.
+	return HasPredecessor(bone, childBone) ||//childBone is a parent of bone. Don't revisit them, that's where we came from!
+		HasPredecessor(childBone, bone); //This bone already explored the childBone; don't do it again.
+}
+
+void BEPUik::ActiveSet::AddInteraction(const Bone *bone, const Bone *predecessor)
+{
+    //Keep the table at most half full; it only grows, so steady state updates don't allocate.
+    auto &interactions = m_scratch->interactions;
+    auto generation = m_scratch->interactionGeneration;
+    if ((m_scratch->interactionCount + 1) * 2 > interactions.size())
+    {
+        std::vector<ActiveSetScratch::InteractionEntry> previous(std::max<size_t>(interactions.size() * 2, 64));
+        previous.swap(interactions);
+        m_scratch->interactionCount = 0;
+		for(auto &entry : previous)
+        {
+            if (entry.generation == generation)
+                AddInteraction(entry.bone, entry.predecessor);
+        }
+    }
+    auto mask = interactions.size() - 1;
+    auto i = HashBonePair(bone, predecessor) & mask;
+    while (interactions[i].generation == generation)
+        i = (i + 1) & mask;
+    interactions[i] = {bone, predecessor, generation};
+    ++m_scratch->interactionCount;
+}
+
+void BEPUik::ActiveSet::AddPredecessor(Bone *bone, Bone *predecessor)
+{
+    auto &links = m_scratch->predecessorLinks;
+    links.push_back({predecessor, bone->firstPredecessor});
+    bone->firstPredecessor = static_cast<uint32_t>(links.size() - 1);
+    ++bone->predecessorCount;
+    if (bone->predecessorCount == MaximumScannedPredecessors + 1)
+    {
+        //The list just got too long to scan; move all of it into the hash set.
+        for (auto link = bone->firstPredecessor; link != Bone::InvalidPredecessor; link = links[link].next)
+            AddInteraction(bone, links[link].bone);
+    }
+    else if (bone->predecessorCount > MaximumScannedPredecessors)
+    {
+        AddInteraction(bone, predecessor);
+    }
 }
+
+void BEPUik::ActiveSet::ClearPredecessors()
+{
+    //Every bone that gained a predecessor was also added to the bones list, so dropping all links at once only requires resetting those heads.
+	for(auto *bone : bones)
+    {
+        bone->firstPredecessor = Bone::InvalidPredecessor;
+        bone->predecessorCount = 0;
+    }
+    m_scratch->predecessorLinks.clear();
+    if (m_scratch->interactionCount == 0)
+        return;
+    m_scratch->interactionCount = 0;
+    if (++m_scratch->interactionGeneration == 0)
+    {
+        //The generation wrapped around; stale entries could alias the new generation.
+		for(auto &entry : m_scratch->interactions)
+            entry.generation = 0;
+        m_scratch->interactionGeneration = 1;
+    }
+}
+
 void BEPUik::ActiveSet::FindStressedPaths(Bone *bone)
 {
+    //Depth first search on an explicit stack. Each frame resumes its joint loop where the child traversal interrupted it,
+    //so the visiting order is the same as a recursive traversal.
+    auto &stack = m_scratch->traversalStack;
     bone->SetActive(true); //We must keep track of which bones have been visited
     bones.push_back(bone);
-	for(auto *joint : bone->joints)
+    stack.push_back({bone, 0, 0.f});
+    while (!stack.empty())
     {
+        auto frameIndex = stack.size() - 1;
+        bone = stack[frameIndex].bone;
+        if (stack[frameIndex].jointIndex == bone->joints.size())
+        {
+            stack.pop_back();
+            continue;
+        }
+        auto *joint = bone->joints[stack[frameIndex].jointIndex++];
         Bone *boneToAnalyze = joint->GetConnectionA() == bone ? joint->GetConnectionB() : joint->GetConnectionA();
         if (BonesHaveInteracted(bone, boneToAnalyze)) //This bone already explored the next bone; don't do it again.
             continue;
@@ -106,7 +285,7 @@ void BEPUik::ActiveSet::FindStressedPaths(Bone *bone)
         {
             //The boneToAnalyze is reached by following a path from bone. We record this regardless of whether or not we traverse further.
             //There is one exception: DO NOT create paths to pinned bones!
-            boneToAnalyze->predecessors.push_back(bone);
+            AddPredecessor(boneToAnalyze, bone);
         }
 
         if (boneToAnalyze->Pinned || boneToAnalyze->traversed)
@@ -138,8 +317,10 @@ void BEPUik::ActiveSet::FindStressedPaths(Bone *bone)
 
         //The search hasn't yet found a stressed path or pinned bone yet.
         //Keep on movin' on!
-        FindStressedPaths(boneToAnalyze);
-        //If a child finds a pin, we will be notified of that fact by the above while loop which traverses the parent pointers.
+        boneToAnalyze->SetActive(true);
+        bones.push_back(boneToAnalyze);
+        stack.push_back({boneToAnalyze, 0, 0.f});
+        //If a child finds a pin, we will be notified of that fact by the above notification which traverses the predecessors.
     }
 
 
@@ -148,12 +329,18 @@ void BEPUik::ActiveSet::FindStressedPaths(Bone *bone)
 void BEPUik::ActiveSet::NotifyPredecessorsOfCycle(Bone *bone)
 {
     //Rather than attempting to only mark cycles, this will simply mark all of the cycle elements and any cycle predecessors up to the unstressed root.
-    if (!bone->unstressedCycle && bone->stressCount == 0)
+    auto &stack = m_scratch->notificationStack;
+    stack.push_back(bone);
+    while (!stack.empty())
     {
+        bone = stack.back();
+        stack.pop_back();
+        if (bone->unstressedCycle || bone->stressCount != 0)
+            continue;
         bone->unstressedCycle = true;
-		for(auto *predecessor : bone->predecessors)
+        for (auto link = bone->firstPredecessor; link != Bone::InvalidPredecessor; link = m_scratch->predecessorLinks[link].next)
         {
-            NotifyPredecessorsOfCycle(predecessor);
+            stack.push_back(m_scratch->predecessorLinks[link].bone);
         }
     }
 }
@@ -161,14 +348,24 @@ void BEPUik::ActiveSet::NotifyPredecessorsOfCycle(Bone *bone)
 void BEPUik::ActiveSet::FindCycles(Bone *bone)
 {
     //The current bone is known to not be stressed.
-	for(auto *joint : bone->joints)
+    auto &stack = m_scratch->traversalStack;
+    stack.push_back({bone, 0, 0.f});
+    while (!stack.empty())
     {
+        auto frameIndex = stack.size() - 1;
+        bone = stack[frameIndex].bone;
+        if (stack[frameIndex].jointIndex == bone->joints.size())
+        {
+            stack.pop_back();
+            continue;
+        }
+        auto *joint = bone->joints[stack[frameIndex].jointIndex++];
         Bone *boneToAnalyze = joint->GetConnectionA() == bone ? joint->GetConnectionB() : joint->GetConnectionA();
 
         if (BonesHaveInteracted(bone, boneToAnalyze)) //Do not attempt to traverse a path which was already traversed *from this bone.*
             continue;
         //We found this bone. Regardless of what happens after, make sure that the bone knows abthis path.
-        boneToAnalyze->predecessors.push_back(bone);
+        AddPredecessor(boneToAnalyze, bone);
 
         if (boneToAnalyze->IsActive())
         {
@@ -189,25 +386,29 @@ void BEPUik::ActiveSet::FindCycles(Bone *bone)
         //Children are added to the active set.
         boneToAnalyze->SetActive(true);
         bones.push_back(boneToAnalyze);
-        FindCycles(boneToAnalyze);
+        stack.push_back({boneToAnalyze, 0, 0.f});
     }
 }
 
-void BEPUik::ActiveSet::DistributeMass(Bone *bone)
+float BEPUik::ActiveSet::ComputeMassPerChild(Bone *bone)
 {
     //Accumulate the number of child joints which we are going to distribute mass to.
+    //Counted children are temporarily flagged as traversed so that multiple joints involved with the same pair of bones aren't double counted.
+    auto &uniqueChildren = m_scratch->uniqueChildren;
 	for(auto *joint : bone->joints)
     {
         Bone *boneToAnalyze = joint->GetConnectionA() == bone ? joint->GetConnectionB() : joint->GetConnectionA();
 
-        if (boneToAnalyze->traversed || boneToAnalyze->unstressedCycle ||
-            find(uniqueChildren.begin(), uniqueChildren.end(), boneToAnalyze) != uniqueChildren.end()) //There could exist multiple joints involved with the same pair of bones; don't continually double count.
+        if (boneToAnalyze->traversed || boneToAnalyze->unstressedCycle)
         {
             //The bone was already visited or was a member of the stressed path we branched from. Do not proceed.
             continue;
         }
+        boneToAnalyze->traversed = true;
         uniqueChildren.push_back(boneToAnalyze);
     }
+	for(auto *child : uniqueChildren)
+        child->traversed = false;
     //We distribute a portion of the current bone's total mass to the child bones.
     //By applying a multiplier automassUnstressedFalloff, we guarantee that a chain has a certain maximum weight (excluding cycles).
     //This is thanks to the convergent geometric series sum(automassUnstressedFalloff^n, 1, infinity).
@@ -216,10 +417,25 @@ void BEPUik::ActiveSet::DistributeMass(Bone *bone)
     uniqueChildren.clear();
     //(If the number of children is 0, then the only bones which can exist are either bones which were already traversed and will be skipped
     //or bones which are members of unstressed cycles and will inherit the full parent weight. Don't have to worry abthe 0 mass.)
+    return massPerChild;
+}
 
-    //The current bone is known to not be stressed.
-	for(auto *joint : bone->joints)
+void BEPUik::ActiveSet::DistributeMass(Bone *bone)
+{
+    //Each frame computes its per-child mass when it is entered, exactly when the recursive formulation would have.
+    auto &stack = m_scratch->traversalStack;
+    stack.push_back({bone, 0, ComputeMassPerChild(bone)});
+    while (!stack.empty())
     {
+        auto frameIndex = stack.size() - 1;
+        bone = stack[frameIndex].bone;
+        if (stack[frameIndex].jointIndex == bone->joints.size())
+        {
+            stack.pop_back();
+            continue;
+        }
+        auto *joint = bone->joints[stack[frameIndex].jointIndex++];
+        //The current bone is known to not be stressed.
         Bone *boneToAnalyze = joint->GetConnectionA() == bone ? joint->GetConnectionB() : joint->GetConnectionA();
         //Note that no testing for pinned bones is necessary; based on the previous stressed path searches,
         //any unstressed bone is known to not be a path to any pinned bones.
@@ -238,13 +454,12 @@ void BEPUik::ActiveSet::DistributeMass(Bone *bone)
         else
         {
             //This bone is not a part of a cycle; give it the allotted mass.
-            boneToAnalyze->SetMass(massPerChild);
+            boneToAnalyze->SetMass(stack[frameIndex].massPerChild);
         }
         //The root bone is already added to the traversal set; add the children.
         boneToAnalyze->traversed = true;
         //Note that we do not need to add anything to the bones list here; the previous FindCycles DFS on this unstressed part of the graph did it for us.
-        DistributeMass(boneToAnalyze);
-
+        stack.push_back({boneToAnalyze, 0, ComputeMassPerChild(boneToAnalyze)});
     }
 
 }
@@ -273,7 +488,7 @@ void BEPUik::ActiveSet::DistributeMass(std::vector<Control*> &controls)
     //Perform a breadth-first search through the graph starting at the bones targeted by each control.
 	for(auto *control : controls)
     {
-        bonesToVisit.push(control->GetTargetBone());
+        m_scratch->bonesToVisit.push_back(control->GetTargetBone());
         //Note that a bone is added to the visited bone set before it is actually processed.
         //This prevents a bone from being put in the queue redundantly.
         control->GetTargetBone()->SetActive(true);
@@ -284,10 +499,9 @@ void BEPUik::ActiveSet::DistributeMass(std::vector<Control*> &controls)
 
     //Note that it's technically possible for multiple controls to affect the same bone.
     //The containment tests will stop it from adding in any redundant constraints as a result.
-    while (bonesToVisit.size() > 0)
+    while (m_scratch->bonesToVisitStart < m_scratch->bonesToVisit.size())
     {
-        auto *bone = bonesToVisit.front();
-		bonesToVisit.pop();
+        auto *bone = m_scratch->bonesToVisit[m_scratch->bonesToVisitStart++];
         if (bone->stressCount == 0)
         {
             bone->SetMass(AutomassUnstressedFalloff);
@@ -313,15 +527,17 @@ void BEPUik::ActiveSet::DistributeMass(std::vector<Control*> &controls)
                 boneToAdd->SetActive(true);
                 //A second traversal flag is required for the mass distribution phase on each unstressed part to work efficiently.
                 boneToAdd->traversed = true;
-                boneToAdd->predecessors.push_back(bone);
+                AddPredecessor(boneToAdd, bone);
                 //The bone was not already present in the active set. We should visit it!
                 //Note that a bone is added to the visited bone set before it is actually processed.
                 //This prevents a bone from being put in the queue redundantly.
-                bonesToVisit.push(boneToAdd);
+                m_scratch->bonesToVisit.push_back(boneToAdd);
                 bones.push_back(boneToAdd);
             }
         }
     }
+    m_scratch->bonesToVisit.clear();
+    m_scratch->bonesToVisitStart = 0;
 
     //Normalize the masses of objects so that the heaviest bones have AutomassTarget mass.
     float lowestInverseMass = std::numeric_limits<float>::max();
@@ -343,19 +559,103 @@ void BEPUik::ActiveSet::DistributeMass(std::vector<Control*> &controls)
         bone->traversed = false;
         bone->stressCount = 0;
         bone->unstressedCycle = false;
-        bone->predecessors.clear();
     }
 
+    ClearPredecessors();
     bones.clear();
 }
 
+void BEPUik::ActiveSet::UpdateBoneStore()
+{
+    boneStore.Clear();
+	for(auto *bone : bones)
+    {
+        boneStore.Add(*bone, true);
+    }
+    //Joints on the border of the active set connect to pinned bones which are not integrated, but the joints still need to be able to look them up.
+	for(auto *joint : joints)
+    {
+        if (joint->m_connectionA->store == nullptr)
+            boneStore.Add(*joint->m_connectionA, false);
+        if (joint->m_connectionB->store == nullptr)
+            boneStore.Add(*joint->m_connectionB, false);
+        joint->BindBoneStore();
+    }
+    BuildIslands();
+}
+
+void BEPUik::ActiveSet::BuildIslands()
+{
+    islands.clear();
+    auto boneCount = boneStore.GetIntegratedCount();
+    auto isMoving = [this](BoneHandle handle) {
+        return boneStore.IsIntegrated(handle) && !boneStore.bones[handle]->Pinned;
+    };
+
+    //Union-find over the moving bones. The root of a set is always its lowest handle, so the result doesn't depend on the joint order.
+    auto &parents = m_scratch->islandParents;
+    parents.resize(boneCount);
+    for (size_t i = 0; i < boneCount; ++i)
+        parents[i] = static_cast<uint32_t>(i);
+    auto find = [&parents](uint32_t handle) {
+        while (parents[handle] != handle)
+        {
+            parents[handle] = parents[parents[handle]];
+            handle = parents[handle];
+        }
+        return handle;
+    };
+	for(auto *joint : joints)
+    {
+        if (!isMoving(joint->m_handleA) || !isMoving(joint->m_handleB))
+            continue;
+        auto rootA = find(joint->m_handleA);
+        auto rootB = find(joint->m_handleB);
+        if (rootA != rootB)
+            parents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+    }
+
+    //Roots come before the other bones of their sets, so the islands can be numbered in a single pass.
+    boneIslands.resize(boneCount);
+    for (size_t i = 0; i < boneCount; ++i)
+    {
+        auto handle = static_cast<BoneHandle>(i);
+        if (!isMoving(handle))
+        {
+            boneIslands[i] = NoIsland;
+            continue;
+        }
+        auto root = find(handle);
+        if (root == handle)
+        {
+            boneIslands[i] = static_cast<uint32_t>(islands.size());
+            islands.emplace_back();
+        }
+        else
+            boneIslands[i] = boneIslands[root];
+        islands[boneIslands[i]].bones.push_back(handle);
+    }
+
+    //Joints between two fixed bones can't do anything and belong to no island.
+    for (size_t i = 0; i < joints.size(); ++i)
+    {
+        auto *joint = joints[i];
+        auto handle = isMoving(joint->m_handleA) ? joint->m_handleA : joint->m_handleB;
+        if (isMoving(handle))
+            islands[boneIslands[handle]].joints.push_back(static_cast<uint32_t>(i));
+    }
+}
+
 void BEPUik::ActiveSet::Clear()
 {
+    m_cachedSource = CachedSource::None;
+    boneStore.Clear();
     for (int i = 0; i < bones.size(); i++)
     {
         bones[i]->SetActive(false);
         bones[i]->stressCount = 0;
-        bones[i]->predecessors.clear();
+        bones[i]->firstPredecessor = Bone::InvalidPredecessor;
+        bones[i]->predecessorCount = 0;
         bones[i]->SetMass(.01f);
     }
     for (int i = 0; i < joints.size(); i++)
@@ -364,10 +664,18 @@ void BEPUik::ActiveSet::Clear()
     }
     bones.clear();
     joints.clear();
+    islands.clear();
+    boneIslands.clear();
 }
 
 void BEPUik::ActiveSet::UpdateActiveSet(std::vector<IKJoint*> &joints)
 {
+    if (IsCacheValid(joints))
+    {
+        boneStore.Refresh();
+        return;
+    }
+
     //Clear the previous active set to make way for the new active set.   
     //Note that the below flag clearing and usage creates a requirement.
     //Two IKSolvers cannot operate on the same graph; the active set flags could be corrupted.
@@ -389,7 +697,7 @@ void BEPUik::ActiveSet::UpdateActiveSet(std::vector<IKJoint*> &joints)
                 bones.push_back(joints[i]->GetConnectionB());
             }
 
-            joints.push_back(joints[i]);
+            this->joints.push_back(joints[i]);
         }
     }
 
@@ -403,13 +711,26 @@ void BEPUik::ActiveSet::UpdateActiveSet(std::vector<IKJoint*> &joints)
         }
     }
 
+    UpdateBoneStore();
 
-
-
+    CacheInputs(CachedSource::Joints);
+    m_cachedJoints = joints;
+    m_cachedJointsEnabled.clear();
+	for(auto *joint : joints)
+        m_cachedJointsEnabled.push_back(joint->GetEnabled());
+    m_cachedControls.clear();
+    m_cachedTargetBones.clear();
 }
 
 void BEPUik::ActiveSet::UpdateActiveSet(std::vector<Control*> &controls)
 {
+    //The traversals below are deterministic, so the same inputs on the same graph produce the same active set and masses.
+    if (IsCacheValid(controls))
+    {
+        boneStore.Refresh();
+        return;
+    }
+
     //Clear the previous active set to make way for the new active set.
     //Note that the below flag clearing and usage creates a requirement.
     //Two IKSolvers cannot operate on the same graph; the active set flags could be corrupted.
@@ -429,7 +750,7 @@ void BEPUik::ActiveSet::UpdateActiveSet(std::vector<Control*> &controls)
     //Perform a breadth-first search through the graph starting at the bones targeted by each control.
 	for(auto *control : controls)
     {
-        bonesToVisit.push(control->GetTargetBone());
+        m_scratch->bonesToVisit.push_back(control->GetTargetBone());
         //Note that a bone is added to the visited bone set before it is actually processed.
         //This prevents a bone from being put in the queue redundantly.
         control->GetTargetBone()->SetActive(true);
@@ -438,10 +759,9 @@ void BEPUik::ActiveSet::UpdateActiveSet(std::vector<Control*> &controls)
 
     //Note that it's technically possible for multiple controls to affect the same bone.
     //The containment tests will stop it from adding in any redundant constraints as a result.
-    while (bonesToVisit.size() > 0)
+    while (m_scratch->bonesToVisitStart < m_scratch->bonesToVisit.size())
     {
-        auto *bone = bonesToVisit.front();
-		bonesToVisit.pop();
+        auto *bone = m_scratch->bonesToVisit[m_scratch->bonesToVisitStart++];
 		for(auto *joint : bone->joints)
         {
             if (!joint->IsActive)
@@ -458,12 +778,23 @@ void BEPUik::ActiveSet::UpdateActiveSet(std::vector<Control*> &controls)
                 //The bone was not already present in the active set. We should visit it!
                 //Note that a bone is added to the visited bone set before it is actually processed.
                 //This prevents a bone from being put in the queue redundantly.
-                bonesToVisit.push(boneToAdd);
+                m_scratch->bonesToVisit.push_back(boneToAdd);
                 bones.push_back(boneToAdd);
             }
         }
     }
+    m_scratch->bonesToVisit.clear();
+    m_scratch->bonesToVisitStart = 0;
+
+    UpdateBoneStore();
 
+    CacheInputs(CachedSource::Controls);
+    m_cachedControls = controls;
+    m_cachedTargetBones.clear();
+	for(auto *control : controls)
+        m_cachedTargetBones.push_back(control->GetTargetBone());
+    m_cachedJoints.clear();
+    m_cachedJointsEnabled.clear();
 }
 
 BEPUik::ActiveSet::~ActiveSet()
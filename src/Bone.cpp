@@ -31,7 +31,12 @@ void BEPUik::Bone::SetMass(float value)
 const std::vector<BEPUik::IKJoint*> &BEPUik::Bone::GetJoints() {return joints;}
 
 bool BEPUik::Bone::GetPinned() const {return Pinned;}
-void BEPUik::Bone::SetPinned(bool value) {Pinned = value;}
+void BEPUik::Bone::SetPinned(bool value)
+{
+    if (Pinned != value)
+        ++topologyVersion;
+    Pinned = value;
+}
 
 bool BEPUik::Bone::IsActive() const {return Active;}
 void BEPUik::Bone::SetActive(bool value) {Active = value;}
@@ -89,53 +94,3 @@ void BEPUik::Bone::ComputeLocalInertiaTensor()
     localInertiaTensor[2][2] = diagValue;
     localInertiaTensorInverse = matrix::Invert(localInertiaTensor);
 }
-
-void BEPUik::Bone::UpdateInertiaTensor()
-{
-    //This is separate from the position update because the orientation can change outside of our iteration loop, so this has to run first.
-    //Iworld^-1 = RT * Ilocal^1 * R
-    Matrix3x3 orientationMatrix;
-    orientationMatrix = matrix::CreateFromQuaternion(Orientation);
-    inertiaTensorInverse = matrix::MultiplyTransposed(orientationMatrix, localInertiaTensorInverse);
-    inertiaTensorInverse = matrix::Multiply(inertiaTensorInverse, orientationMatrix);
-}
-
-void BEPUik::Bone::UpdatePosition()
-{
-    //Update the position based on the linear velocity.
-    Position = vector3::Add(Position, linearVelocity);
-
-    //Update the orientation based on the angular velocity.
-    Vector3 increment;
-    increment = vector3::Multiply(angularVelocity, .5f);
-    Quaternion multiplier = quaternion::Create(increment.x, increment.y, increment.z,0.f);
-    multiplier = BEPUik::quaternion::Multiply(multiplier, Orientation);
-    Orientation = quaternion::Add(Orientation, multiplier);
-    quaternion::Normalize(Orientation);
-
-    //Eliminate any latent velocity in the bone to prevent unwanted simulation feedback.
-    //This is the only thing conceptually separating this "IK" solver from the regular dynamics loop in BEPUphysics.
-    //(Well, that and the whole lack of collision detection...)
-    linearVelocity = vector3::Create();
-    angularVelocity = vector3::Create();
-
-    //Note: Unlike a regular dynamics simulation, we do not include any 'dt' parameter in the above integration.
-    //Setting the velocity to 0 every update means that no more than a single iteration's worth of velocity accumulates.
-    //Since the softness of constraints already varies with the time step and bones never accelerate for more than one frame,
-    //scaling the velocity for position integration actually turns generally worse.
-    //This is not a rigorously justifiable approach, but this isn't a regular dynamic simulation anyway.
-}
-
-void BEPUik::Bone::ApplyLinearImpulse(Vector3 &impulse)
-{
-    Vector3 velocityChange;
-    velocityChange = vector3::Multiply(impulse, inverseMass);
-    linearVelocity = vector3::Add(linearVelocity, velocityChange);
-}
-
-void BEPUik::Bone::ApplyAngularImpulse(Vector3 &impulse)
-{
-    Vector3 velocityChange;
-    velocityChange = matrix::Transform(impulse, inertiaTensorInverse);
-    angularVelocity = vector3::Add(velocityChange, angularVelocity);
-}
@@ -0,0 +1,267 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/BoneStore.hpp"
+#include "bepuik/Bone.hpp"
+#include <algorithm>
+#include <cmath>
+
+BEPUik::BoneStore::~BoneStore()
+{
+    Clear();
+}
+
+size_t BEPUik::BoneStore::GetCount() const {return bones.size();}
+size_t BEPUik::BoneStore::GetIntegratedCount() const {return integratedCount;}
+
+BEPUik::BoneHandle BEPUik::BoneStore::Add(Bone &bone, bool integrated)
+{
+    auto handle = static_cast<BoneHandle>(bones.size());
+    bones.push_back(&bone);
+    positions.emplace_back();
+    orientations.emplace_back();
+    rotations.emplace_back();
+    linearVelocities.emplace_back();
+    angularVelocities.emplace_back();
+    inverseMasses.push_back(0.f);
+    localInertiaTensorInverses.emplace_back();
+    inertiaTensorInverses.push_back(matrix::Create());
+    inertiaTensorsStale.push_back(1);
+    axisymmetricInertias.push_back(0);
+    radialInertiaTensorInverses.push_back(0.f);
+    axialInertiaTensorInverseOffsets.push_back(0.f);
+    CopyState(handle);
+    if (integrated)
+        integratedCount = bones.size();
+
+    bone.store = this;
+    bone.handle = handle;
+    return handle;
+}
+
+BEPUik::BoneHandle BEPUik::BoneStore::AddUnbound(float inverseMass, const Matrix3x3 &localInertiaTensorInverse, bool integrated)
+{
+    auto handle = static_cast<BoneHandle>(bones.size());
+    bones.push_back(nullptr);
+    positions.push_back(vector3::Create());
+    orientations.push_back(quat_identity);
+    rotations.push_back(matrix::CreateFromQuaternion(quat_identity));
+    linearVelocities.push_back(vector3::Create());
+    angularVelocities.push_back(vector3::Create());
+    inverseMasses.push_back(inverseMass);
+    localInertiaTensorInverses.emplace_back();
+    inertiaTensorInverses.push_back(matrix::Create());
+    inertiaTensorsStale.push_back(1);
+    axisymmetricInertias.push_back(0);
+    radialInertiaTensorInverses.push_back(0.f);
+    axialInertiaTensorInverseOffsets.push_back(0.f);
+    SetLocalInertiaTensorInverse(handle, localInertiaTensorInverse);
+    if (integrated)
+        integratedCount = bones.size();
+    return handle;
+}
+
+void BEPUik::BoneStore::Refresh()
+{
+    for (size_t i = 0; i < bones.size(); ++i)
+    {
+        if (bones[i])
+            CopyState(static_cast<BoneHandle>(i));
+    }
+}
+
+void BEPUik::BoneStore::CopyState(BoneHandle handle)
+{
+    auto &bone = *bones[handle];
+    positions[handle] = bone.Position;
+    SetOrientation(handle, bone.Orientation);
+    linearVelocities[handle] = vector3::Create();
+    angularVelocities[handle] = vector3::Create();
+    //Treat pinned bones as if they have infinite inertia.
+    //With zero inverse mass and inertia, the constraints can skip the pinned checks entirely; any impulse applied to a pinned bone is a no-op.
+    if (bone.Pinned)
+    {
+        inverseMasses[handle] = 0.f;
+        SetLocalInertiaTensorInverse(handle, matrix::Create());
+    }
+    else
+    {
+        inverseMasses[handle] = bone.inverseMass;
+        SetLocalInertiaTensorInverse(handle, bone.localInertiaTensorInverse);
+    }
+}
+
+void BEPUik::BoneStore::SetLocalInertiaTensorInverse(BoneHandle handle, const Matrix3x3 &localInertiaTensorInverse)
+{
+    localInertiaTensorInverses[handle] = localInertiaTensorInverse;
+    const auto &tensor = localInertiaTensorInverse;
+    bool axisymmetric = tensor[0][1] == 0 && tensor[0][2] == 0 && tensor[1][0] == 0 && tensor[1][2] == 0 && tensor[2][0] == 0 && tensor[2][1] == 0 &&
+        tensor[0][0] == tensor[2][2];
+    axisymmetricInertias[handle] = axisymmetric;
+    radialInertiaTensorInverses[handle] = axisymmetric ? tensor[0][0] : 0.f;
+    axialInertiaTensorInverseOffsets[handle] = axisymmetric ? tensor[1][1] - tensor[0][0] : 0.f;
+    inertiaTensorsStale[handle] = 1;
+}
+
+void BEPUik::BoneStore::Clear()
+{
+	for(auto *bone : bones)
+    {
+        if (!bone)
+            continue;
+        bone->store = nullptr;
+        bone->handle = InvalidBoneHandle;
+    }
+    bones.clear();
+    positions.clear();
+    orientations.clear();
+    rotations.clear();
+    linearVelocities.clear();
+    angularVelocities.clear();
+    inverseMasses.clear();
+    inertiaTensorInverses.clear();
+    localInertiaTensorInverses.clear();
+    inertiaTensorsStale.clear();
+    axisymmetricInertias.clear();
+    radialInertiaTensorInverses.clear();
+    axialInertiaTensorInverseOffsets.clear();
+    integratedCount = 0;
+}
+
+void BEPUik::BoneStore::UpdateInertiaTensors()
+{
+    for (size_t i = 0; i < integratedCount; ++i)
+    {
+        UpdateInertiaTensor(static_cast<BoneHandle>(i));
+    }
+}
+
+float BEPUik::BoneStore::UpdatePositions()
+{
+    //Velocities are not scaled by a time step, so they are exactly the motion of this iteration.
+    float maximumMotionSquared = 0;
+    for (size_t i = 0; i < integratedCount; ++i)
+    {
+        maximumMotionSquared = std::max(maximumMotionSquared, vector3::Dot(linearVelocities[i], linearVelocities[i]));
+        maximumMotionSquared = std::max(maximumMotionSquared, vector3::Dot(angularVelocities[i], angularVelocities[i]));
+        UpdatePosition(static_cast<BoneHandle>(i));
+    }
+    return std::sqrt(maximumMotionSquared);
+}
+
+void BEPUik::BoneStore::UpdateInertiaTensors(std::span<const BoneHandle> handles)
+{
+    for (auto handle : handles)
+    {
+        UpdateInertiaTensor(handle);
+    }
+}
+
+float BEPUik::BoneStore::UpdatePositions(std::span<const BoneHandle> handles)
+{
+    float maximumMotionSquared = 0;
+    for (auto handle : handles)
+    {
+        maximumMotionSquared = std::max(maximumMotionSquared, vector3::Dot(linearVelocities[handle], linearVelocities[handle]));
+        maximumMotionSquared = std::max(maximumMotionSquared, vector3::Dot(angularVelocities[handle], angularVelocities[handle]));
+        UpdatePosition(handle);
+    }
+    return std::sqrt(maximumMotionSquared);
+}
+
+void BEPUik::BoneStore::UpdateInertiaTensor(BoneHandle handle)
+{
+    //This is separate from the position update because the orientation can change outside of our iteration loop, so this has to run first.
+    //Bones that did not rotate since the last update still have a valid world inertia tensor.
+    //Axisymmetric bones never need one; their tensor is applied through the rotation directly.
+    if (!inertiaTensorsStale[handle] || axisymmetricInertias[handle])
+        return;
+    inertiaTensorsStale[handle] = 0;
+    //Iworld^-1 = RT * Ilocal^1 * R
+    const auto &orientationMatrix = rotations[handle];
+    auto &inertiaTensorInverse = inertiaTensorInverses[handle];
+    inertiaTensorInverse = matrix::MultiplyTransposed(orientationMatrix, localInertiaTensorInverses[handle]);
+    inertiaTensorInverse = matrix::Multiply(inertiaTensorInverse, orientationMatrix);
+}
+
+void BEPUik::BoneStore::UpdatePosition(BoneHandle handle)
+{
+    auto &position = positions[handle];
+    auto &orientation = orientations[handle];
+    auto &linearVelocity = linearVelocities[handle];
+    auto &angularVelocity = angularVelocities[handle];
+
+    //Update the position based on the linear velocity.
+    position = vector3::Add(position, linearVelocity);
+
+    //Update the orientation based on the angular velocity.
+    //Bones that received no angular impulse keep their orientation, rotation matrix and world inertia tensor.
+    if (angularVelocity.x != 0.f || angularVelocity.y != 0.f || angularVelocity.z != 0.f)
+    {
+        Vector3 increment;
+        increment = vector3::Multiply(angularVelocity, .5f);
+        Quaternion multiplier = quaternion::Create(increment.x, increment.y, increment.z,0.f);
+        multiplier = BEPUik::quaternion::Multiply(multiplier, orientation);
+        orientation = quaternion::Add(orientation, multiplier);
+        quaternion::Normalize(orientation);
+        rotations[handle] = matrix::CreateFromQuaternion(orientation);
+        inertiaTensorsStale[handle] = 1;
+    }
+
+    //Eliminate any latent velocity in the bone to prevent unwanted simulation feedback.
+    //This is the only thing conceptually separating this "IK" solver from the regular dynamics loop in BEPUphysics.
+    //(Well, that and the whole lack of collision detection...)
+    linearVelocity = vector3::Create();
+    angularVelocity = vector3::Create();
+
+    //Note: Unlike a regular dynamics simulation, we do not include any 'dt' parameter in the above integration.
+    //Setting the velocity to 0 every update means that no more than a single iteration's worth of velocity accumulates.
+    //Since the softness of constraints already varies with the time step and bones never accelerate for more than one frame,
+    //scaling the velocity for position integration actually turns generally worse.
+    //This is not a rigorously justifiable approach, but this isn't a regular dynamic simulation anyway.
+
+    //The joints measure their error from the bone's pose, so keep it in sync with the store.
+    if (auto *bone = bones[handle])
+    {
+        bone->Position = position;
+        bone->Orientation = orientation;
+    }
+}
+
+void BEPUik::BoneStore::SetOrientation(BoneHandle handle, const Quaternion &orientation)
+{
+    orientations[handle] = orientation;
+    rotations[handle] = matrix::CreateFromQuaternion(orientation);
+    inertiaTensorsStale[handle] = 1;
+}
+
+void BEPUik::BoneStore::ApplyLinearImpulse(BoneHandle handle, const Vector3 &impulse)
+{
+    //Border bones and pinned bones never move. Skipping them also means that joints solved concurrently may share them.
+    if (handle >= integratedCount || inverseMasses[handle] == 0.f)
+        return;
+    Vector3 velocityChange;
+    velocityChange = vector3::Multiply(impulse, inverseMasses[handle]);
+    linearVelocities[handle] = vector3::Add(linearVelocities[handle], velocityChange);
+}
+
+void BEPUik::BoneStore::ApplyAngularImpulse(BoneHandle handle, const Vector3 &impulse)
+{
+    if (handle >= integratedCount || inverseMasses[handle] == 0.f)
+        return;
+    Vector3 velocityChange;
+    velocityChange = TransformByInertiaTensorInverse(handle, impulse);
+    angularVelocities[handle] = vector3::Add(velocityChange, angularVelocities[handle]);
+}
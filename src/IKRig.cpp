@@ -0,0 +1,76 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKRig.hpp"
+#include <algorithm>
+
+BEPUik::IKRig::IKRig(size_t blockSize)
+    : blockSize(blockSize)
+{}
+
+BEPUik::IKRig::~IKRig()
+{
+    DestroyObjects();
+    for (auto &block : blocks)
+        ::operator delete(block.memory, std::align_val_t {BlockAlignment});
+}
+
+void BEPUik::IKRig::DestroyObjects()
+{
+    //Objects may refer to objects created before them, such as joints to their bones, so they are destroyed in the reverse order of their creation.
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+        it->destroy(it->object);
+    destructors.clear();
+    bones.clear();
+    joints.clear();
+    controls.clear();
+}
+
+void BEPUik::IKRig::Clear()
+{
+    DestroyObjects();
+    for (size_t i = 1; i < blocks.size(); ++i)
+        ::operator delete(blocks[i].memory, std::align_val_t {BlockAlignment});
+    if (blocks.size() > 1)
+        blocks.erase(blocks.begin() + 1, blocks.end());
+    blockOffset = 0;
+}
+
+size_t BEPUik::IKRig::GetReservedBytes() const
+{
+    size_t bytes = 0;
+    for (auto &block : blocks)
+        bytes += block.size;
+    return bytes;
+}
+
+void *BEPUik::IKRig::Allocate(size_t size, size_t alignment)
+{
+    //Bump allocation within the current block; the blocks themselves are aligned to BlockAlignment.
+    if (!blocks.empty())
+    {
+        auto offset = (blockOffset + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= blocks.back().size)
+        {
+            blockOffset = offset + size;
+            return blocks.back().memory + offset;
+        }
+    }
+    auto newBlockSize = std::max(blockSize, size);
+    auto *memory = static_cast<std::byte*>(::operator new(newBlockSize, std::align_val_t {BlockAlignment}));
+    blocks.push_back({memory, newBlockSize});
+    blockOffset = size;
+    return memory;
+}
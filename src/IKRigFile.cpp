@@ -0,0 +1,225 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKRigFile.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using namespace BEPUik;
+
+    constexpr char Magic[4] = {'B', 'I', 'K', 'R'};
+    //Written in native byte order; reads back differently on a machine of the other order.
+    constexpr uint32_t ByteOrderMark = 0x01020304;
+    constexpr size_t SectionAlignment = 16;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        //Sizes of the descriptions, which differ between incompatible math configurations.
+        uint32_t boneDescriptionSize;
+        uint32_t jointDescriptionSize;
+        uint32_t controlDescriptionSize;
+        uint32_t boneCount;
+        uint32_t jointCount;
+        uint32_t controlCount;
+        uint32_t reserved;
+        uint64_t boneOffset;
+        uint64_t jointOffset;
+        uint64_t controlOffset;
+    };
+    static_assert(sizeof(FileHeader) % SectionAlignment == 0);
+
+    uint64_t AlignOffset(uint64_t offset)
+    {
+        return (offset + SectionAlignment - 1) & ~static_cast<uint64_t>(SectionAlignment - 1);
+    }
+
+    void CheckSection(uint64_t offset, uint64_t count, uint64_t elementSize, size_t dataSize)
+    {
+        if (offset % SectionAlignment != 0 || offset < sizeof(FileHeader) || offset > dataSize || count > (dataSize - offset) / elementSize)
+            throw std::runtime_error("Rig file sections are out of bounds.");
+    }
+
+    template<typename T>
+    std::span<const T> GetSection(std::span<const std::byte> data, uint64_t offset, uint32_t count)
+    {
+        return {reinterpret_cast<const T*>(data.data() + offset), count};
+    }
+}
+
+BEPUik::IKRigFile::IKRigFile(const std::string &path)
+{
+#ifdef _WIN32
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open rig file " + path + ".");
+    LARGE_INTEGER size;
+    HANDLE fileMapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (fileMapping)
+    {
+        mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        mappingSize = static_cast<size_t>(size.QuadPart);
+        //The view keeps the mapping alive.
+        CloseHandle(fileMapping);
+    }
+    CloseHandle(file);
+#else
+    auto file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Failed to open rig file " + path + ".");
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED)
+            mapping = nullptr;
+        else
+            mappingSize = static_cast<size_t>(status.st_size);
+    }
+    //The mapping stays valid after the descriptor is closed.
+    close(file);
+#endif
+    if (!mapping)
+        throw std::runtime_error("Failed to map rig file " + path + ".");
+    try
+    {
+        Load({static_cast<const std::byte*>(mapping), mappingSize});
+    }
+    catch (...)
+    {
+        Unmap();
+        throw;
+    }
+}
+
+BEPUik::IKRigFile::IKRigFile(std::span<const std::byte> data)
+{
+    Load(data);
+}
+
+BEPUik::IKRigFile::~IKRigFile()
+{
+    rigTemplate.reset();
+    Unmap();
+}
+
+void BEPUik::IKRigFile::Load(std::span<const std::byte> data)
+{
+    if (reinterpret_cast<uintptr_t>(data.data()) % SectionAlignment != 0)
+        throw std::runtime_error("Rig file data must be aligned to 16 bytes.");
+    if (data.size() < sizeof(FileHeader))
+        throw std::runtime_error("Rig file is truncated.");
+    FileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+        throw std::runtime_error("Not a rig file.");
+    if (header.byteOrderMark != ByteOrderMark)
+        throw std::runtime_error("Rig file was written with a different byte order.");
+    if (header.version != Version)
+        throw std::runtime_error("Unsupported rig file version " + std::to_string(header.version) + ".");
+    if (header.boneDescriptionSize != sizeof(BoneDescription) || header.jointDescriptionSize != sizeof(JointDescription) || header.controlDescriptionSize != sizeof(ControlDescription))
+        throw std::runtime_error("Rig file was written with a different description layout.");
+    CheckSection(header.boneOffset, header.boneCount, sizeof(BoneDescription), data.size());
+    CheckSection(header.jointOffset, header.jointCount, sizeof(JointDescription), data.size());
+    CheckSection(header.controlOffset, header.controlCount, sizeof(ControlDescription), data.size());
+
+    auto bones = GetSection<BoneDescription>(data, header.boneOffset, header.boneCount);
+    auto joints = GetSection<JointDescription>(data, header.jointOffset, header.jointCount);
+    auto controls = GetSection<ControlDescription>(data, header.controlOffset, header.controlCount);
+    //The descriptions are used in place, but the indices and types must be valid before anything is instantiated from them.
+	for(auto &joint : joints)
+    {
+        if (joint.type >= JointType::Custom || joint.boneA >= header.boneCount || joint.boneB >= header.boneCount)
+            throw std::runtime_error("Rig file contains an invalid joint.");
+    }
+	for(auto &control : controls)
+    {
+        if (control.type > ControlType::AngularPlane || control.bone >= header.boneCount)
+            throw std::runtime_error("Rig file contains an invalid control.");
+    }
+    rigTemplate.emplace(bones, joints, controls);
+}
+
+void BEPUik::IKRigFile::Unmap()
+{
+    if (!mapping)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+void BEPUik::IKRigFile::Write(const IKRigTemplate &rigTemplate, std::ostream &stream)
+{
+    auto bones = rigTemplate.GetBones();
+    auto joints = rigTemplate.GetJoints();
+    auto controls = rigTemplate.GetControls();
+    FileHeader header {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrderMark = ByteOrderMark;
+    header.boneDescriptionSize = sizeof(BoneDescription);
+    header.jointDescriptionSize = sizeof(JointDescription);
+    header.controlDescriptionSize = sizeof(ControlDescription);
+    header.boneCount = static_cast<uint32_t>(bones.size());
+    header.jointCount = static_cast<uint32_t>(joints.size());
+    header.controlCount = static_cast<uint32_t>(controls.size());
+    header.boneOffset = sizeof(FileHeader);
+    header.jointOffset = AlignOffset(header.boneOffset + bones.size_bytes());
+    header.controlOffset = AlignOffset(header.jointOffset + joints.size_bytes());
+
+    uint64_t position = 0;
+    auto writeSection = [&stream, &position](uint64_t offset, const void *data, size_t size) {
+        static constexpr char padding[SectionAlignment] = {};
+        stream.write(padding, static_cast<std::streamsize>(offset - position));
+        stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position = offset + size;
+    };
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.boneOffset, bones.data(), bones.size_bytes());
+    writeSection(header.jointOffset, joints.data(), joints.size_bytes());
+    writeSection(header.controlOffset, controls.data(), controls.size_bytes());
+}
+
+void BEPUik::IKRigFile::Write(const IKRigTemplate &rigTemplate, const std::string &path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (file)
+        Write(rigTemplate, file);
+    if (!file || !file.flush())
+        throw std::runtime_error("Failed to write rig file " + path + ".");
+}
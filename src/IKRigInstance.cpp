@@ -0,0 +1,43 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKRigInstance.hpp"
+#include <algorithm>
+
+BEPUik::IKRigInstance::IKRigInstance(const IKRigTemplate &rigTemplate)
+    : rigTemplate(&rigTemplate)
+{
+    auto bones = rigTemplate.GetBones();
+    Positions.reserve(bones.size());
+    Orientations.reserve(bones.size());
+	for(auto &bone : bones)
+    {
+        Positions.push_back(bone.position);
+        Orientations.push_back(bone.orientation);
+    }
+    auto controls = rigTemplate.GetControls();
+    Goals.reserve(controls.size());
+	for(auto &control : controls)
+    {
+        Goals.push_back(control.goal);
+    }
+    controlImpulses.resize(controls.size() * 2);
+}
+
+void BEPUik::IKRigInstance::ClearAccumulatedImpulses()
+{
+    warmStart = {};
+    std::fill(controlImpulses.begin(), controlImpulses.end(), Vector3{});
+}
@@ -0,0 +1,458 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKRigTemplate.hpp"
+#include "bepuik/IKRig.hpp"
+#include "bepuik/joint/IKAngularJoint.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKDistanceJoint.hpp"
+#include "bepuik/joint/IKPointOnLineJoint.hpp"
+#include "bepuik/joint/IKPointOnPlaneJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/joint/IKSwivelHingeJoint.hpp"
+#include "bepuik/joint/IKTwistJoint.hpp"
+#include "bepuik/limit/IKDistanceLimit.hpp"
+#include "bepuik/limit/IKEllipseSwingLimit.hpp"
+#include "bepuik/limit/IKLinearAxisLimit.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/limit/IKTwistLimit.hpp"
+#include "bepuik/control/AngularPlaneControl.hpp"
+#include "bepuik/control/DragControl.hpp"
+#include "bepuik/control/RevoluteControl.hpp"
+#include "bepuik/control/StateControl.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+BEPUik::IKRigTemplate::IKRigTemplate(const std::vector<Bone*> &bones, const std::vector<IKJoint*> &joints, const std::vector<Control*> &controls)
+{
+    std::unordered_map<const Bone*, uint32_t> boneIndices;
+    ownedBones.reserve(bones.size());
+	for(auto *bone : bones)
+    {
+        boneIndices[bone] = static_cast<uint32_t>(ownedBones.size());
+        ownedBones.push_back({bone->Position, bone->Orientation, bone->GetRadius(), bone->GetHeight(), bone->GetMass(), bone->InertiaTensorScaling, static_cast<uint8_t>(bone->Pinned), {}});
+    }
+    auto getBoneIndex = [&boneIndices](const Bone *bone) {
+        auto it = boneIndices.find(bone);
+        if (it == boneIndices.end())
+            throw std::invalid_argument("Rig templates can only reference their own bones.");
+        return it->second;
+    };
+
+    ownedJoints.reserve(joints.size());
+	for(auto *joint : joints)
+    {
+        ownedJoints.push_back(Describe(*joint, getBoneIndex(joint->m_connectionA), getBoneIndex(joint->m_connectionB)));
+    }
+
+    ownedControls.reserve(controls.size());
+	for(auto *control : controls)
+    {
+        ControlDescription description {};
+        description.bone = getBoneIndex(control->GetTargetBone());
+        description.maximumForce = control->GetMaximumForce();
+        description.goal.orientation = quat_identity;
+        //OrientedDragControl is a DragControl as far as the solver is concerned, so it is captured as one.
+        if (auto *stateControl = dynamic_cast<StateControl*>(control))
+        {
+            description.type = ControlType::State;
+            description.localOffset = stateControl->LinearMotor->LocalOffset;
+            description.linearRigidity = stateControl->LinearMotor->Rigidity;
+            description.angularRigidity = stateControl->AngularMotor->Rigidity;
+            description.goal.position = stateControl->LinearMotor->TargetPosition;
+            description.goal.orientation = stateControl->AngularMotor->TargetOrientation;
+        }
+        else if (auto *dragControl = dynamic_cast<DragControl*>(control))
+        {
+            description.type = ControlType::Drag;
+            description.localOffset = dragControl->LinearMotor->LocalOffset;
+            description.linearRigidity = dragControl->LinearMotor->Rigidity;
+            description.goal.position = dragControl->LinearMotor->TargetPosition;
+        }
+        else if (auto *revoluteControl = dynamic_cast<RevoluteControl*>(control))
+        {
+            description.type = ControlType::Revolute;
+            description.localAxis = revoluteControl->AngularMotor->BoneLocalFreeAxis;
+            description.angularRigidity = revoluteControl->AngularMotor->Rigidity;
+            description.goal.axis = revoluteControl->AngularMotor->GetFreeAxis();
+        }
+        else if (auto *planeControl = dynamic_cast<AngularPlaneControl*>(control))
+        {
+            description.type = ControlType::AngularPlane;
+            description.localAxis = planeControl->AngularMotor->BoneLocalAxis;
+            description.angularRigidity = planeControl->AngularMotor->Rigidity;
+            description.goal.axis = planeControl->AngularMotor->PlaneNormal;
+        }
+        else
+            throw std::invalid_argument("Rig templates cannot contain custom control types.");
+        ownedControls.push_back(description);
+    }
+    this->bones = ownedBones;
+    this->joints = ownedJoints;
+    this->controls = ownedControls;
+}
+
+BEPUik::IKRigTemplate::IKRigTemplate(IKRig &rig)
+    : IKRigTemplate(rig.GetBones(), rig.GetJoints(), rig.GetControls())
+{}
+
+BEPUik::IKRigTemplate::IKRigTemplate(std::span<const BoneDescription> bones, std::span<const JointDescription> joints, std::span<const ControlDescription> controls)
+    : bones(bones), joints(joints), controls(controls)
+{}
+
+BEPUik::JointDescription BEPUik::IKRigTemplate::Describe(const IKJoint &joint, uint32_t boneA, uint32_t boneB)
+{
+    JointDescription description {};
+    description.type = JointBatches::Classify(joint);
+    description.enabled = joint.GetEnabled();
+    description.boneA = boneA;
+    description.boneB = boneB;
+    description.rigidity = joint.Rigidity;
+    description.maximumForce = joint.MaximumForce;
+    description.orientation = quat_identity;
+    auto &v = description.vectors;
+    auto &s = description.scalars;
+    switch (description.type)
+    {
+    case JointType::BallSocket:
+    {
+        auto &j = static_cast<const IKBallSocketJoint&>(joint);
+        v[0] = j.LocalOffsetA;
+        v[1] = j.LocalOffsetB;
+        break;
+    }
+    case JointType::Angular:
+        description.orientation = static_cast<const IKAngularJoint&>(joint).GoalRelativeOrientation;
+        break;
+    case JointType::Distance:
+    {
+        auto &j = static_cast<const IKDistanceJoint&>(joint);
+        v[0] = j.LocalAnchorA;
+        v[1] = j.LocalAnchorB;
+        s[0] = j.distance;
+        break;
+    }
+    case JointType::PointOnLine:
+    {
+        auto &j = static_cast<const IKPointOnLineJoint&>(joint);
+        v[0] = j.LocalLineAnchor;
+        v[1] = j.localLineDirection;
+        v[2] = j.LocalAnchorB;
+        v[3] = j.localRestrictedAxis1;
+        v[4] = j.localRestrictedAxis2;
+        break;
+    }
+    case JointType::PointOnPlane:
+    {
+        auto &j = static_cast<const IKPointOnPlaneJoint&>(joint);
+        v[0] = j.LocalPlaneAnchor;
+        v[1] = j.LocalPlaneNormal;
+        v[2] = j.LocalAnchorB;
+        break;
+    }
+    case JointType::Revolute:
+    {
+        //The constrained axes depend on the bone orientations at the time they were computed, so they are captured rather than recomputed.
+        auto &j = static_cast<const IKRevoluteJoint&>(joint);
+        v[0] = j.localFreeAxisA;
+        v[1] = j.localFreeAxisB;
+        v[2] = j.localConstrainedAxis1;
+        v[3] = j.localConstrainedAxis2;
+        break;
+    }
+    case JointType::SwivelHinge:
+    {
+        auto &j = static_cast<const IKSwivelHingeJoint&>(joint);
+        v[0] = j.LocalHingeAxis;
+        v[1] = j.LocalTwistAxis;
+        break;
+    }
+    case JointType::Twist:
+    {
+        auto &j = static_cast<const IKTwistJoint&>(joint);
+        v[0] = j.LocalAxisA;
+        v[1] = j.LocalAxisB;
+        v[2] = j.LocalMeasurementAxisA;
+        v[3] = j.LocalMeasurementAxisB;
+        break;
+    }
+    case JointType::DistanceLimit:
+    {
+        auto &j = static_cast<const IKDistanceLimit&>(joint);
+        v[0] = j.LocalAnchorA;
+        v[1] = j.LocalAnchorB;
+        s[0] = j.MinimumDistance;
+        s[1] = j.MaximumDistance;
+        break;
+    }
+    case JointType::EllipseSwingLimit:
+    {
+        auto &j = static_cast<const IKEllipseSwingLimit&>(joint);
+        v[0] = j.LocalAxisA;
+        v[1] = j.LocalAxisB;
+        v[2] = j.LocalXAxis;
+        v[3] = j.LocalAxisBRelToA;
+        v[4] = j.xAxis;
+        v[5] = j.yAxis;
+        s[0] = j.maximumAngleX;
+        s[1] = j.maximumAngleY;
+        break;
+    }
+    case JointType::LinearAxisLimit:
+    {
+        auto &j = static_cast<const IKLinearAxisLimit&>(joint);
+        v[0] = j.LocalLineAnchor;
+        v[1] = j.LocalLineDirection;
+        v[2] = j.LocalAnchorB;
+        s[0] = j.minimumDistance;
+        s[1] = j.maximumDistance;
+        break;
+    }
+    case JointType::SwingLimit:
+    {
+        auto &j = static_cast<const IKSwingLimit&>(joint);
+        v[0] = j.LocalAxisA;
+        v[1] = j.LocalAxisB;
+        s[0] = j.maximumAngle;
+        break;
+    }
+    case JointType::TwistLimit:
+    {
+        auto &j = static_cast<const IKTwistLimit&>(joint);
+        v[0] = j.LocalAxisA;
+        v[1] = j.LocalAxisB;
+        v[2] = j.LocalMeasurementAxisA;
+        v[3] = j.LocalMeasurementAxisB;
+        s[0] = j.maximumAngle;
+        break;
+    }
+    default:
+        throw std::invalid_argument("Rig templates cannot contain custom joint types.");
+    }
+    return description;
+}
+
+BEPUik::IKJoint &BEPUik::IKRigTemplate::CreateJoint(IKRig &rig, const JointDescription &description, Bone &connectionA, Bone &connectionB)
+{
+    //The joints are constructed with placeholder geometry, which is then replaced by the captured local space values.
+    auto &v = description.vectors;
+    auto &s = description.scalars;
+    auto &zero = vector3::Zero;
+    auto &up = vector3::Up;
+    IKJoint *joint;
+    switch (description.type)
+    {
+    case JointType::BallSocket:
+    {
+        auto &j = rig.Create<IKBallSocketJoint>(connectionA, connectionB, zero);
+        j.LocalOffsetA = v[0];
+        j.LocalOffsetB = v[1];
+        joint = &j;
+        break;
+    }
+    case JointType::Angular:
+    {
+        auto &j = rig.Create<IKAngularJoint>(connectionA, connectionB);
+        j.GoalRelativeOrientation = description.orientation;
+        joint = &j;
+        break;
+    }
+    case JointType::Distance:
+    {
+        auto &j = rig.Create<IKDistanceJoint>(connectionA, connectionB, zero, zero);
+        j.LocalAnchorA = v[0];
+        j.LocalAnchorB = v[1];
+        j.distance = s[0];
+        joint = &j;
+        break;
+    }
+    case JointType::PointOnLine:
+    {
+        auto &j = rig.Create<IKPointOnLineJoint>(connectionA, connectionB, zero, up, zero);
+        j.LocalLineAnchor = v[0];
+        j.localLineDirection = v[1];
+        j.LocalAnchorB = v[2];
+        j.localRestrictedAxis1 = v[3];
+        j.localRestrictedAxis2 = v[4];
+        joint = &j;
+        break;
+    }
+    case JointType::PointOnPlane:
+    {
+        auto &j = rig.Create<IKPointOnPlaneJoint>(connectionA, connectionB, zero, up, zero);
+        j.LocalPlaneAnchor = v[0];
+        j.LocalPlaneNormal = v[1];
+        j.LocalAnchorB = v[2];
+        joint = &j;
+        break;
+    }
+    case JointType::Revolute:
+    {
+        auto &j = rig.Create<IKRevoluteJoint>(connectionA, connectionB, up);
+        j.localFreeAxisA = v[0];
+        j.localFreeAxisB = v[1];
+        j.localConstrainedAxis1 = v[2];
+        j.localConstrainedAxis2 = v[3];
+        joint = &j;
+        break;
+    }
+    case JointType::SwivelHinge:
+    {
+        auto &j = rig.Create<IKSwivelHingeJoint>(connectionA, connectionB, up, up);
+        j.LocalHingeAxis = v[0];
+        j.LocalTwistAxis = v[1];
+        joint = &j;
+        break;
+    }
+    case JointType::Twist:
+    {
+        auto &j = rig.Create<IKTwistJoint>(connectionA, connectionB, up, up);
+        j.LocalAxisA = v[0];
+        j.LocalAxisB = v[1];
+        j.LocalMeasurementAxisA = v[2];
+        j.LocalMeasurementAxisB = v[3];
+        joint = &j;
+        break;
+    }
+    case JointType::DistanceLimit:
+    {
+        auto &j = rig.Create<IKDistanceLimit>(connectionA, connectionB, zero, zero, s[0], s[1]);
+        j.LocalAnchorA = v[0];
+        j.LocalAnchorB = v[1];
+        j.MinimumDistance = s[0];
+        j.MaximumDistance = s[1];
+        joint = &j;
+        break;
+    }
+    case JointType::EllipseSwingLimit:
+    {
+        auto &j = rig.Create<IKEllipseSwingLimit>(connectionA, connectionB, up, up, s[0], s[1]);
+        j.LocalAxisA = v[0];
+        j.LocalAxisB = v[1];
+        j.LocalXAxis = v[2];
+        j.LocalAxisBRelToA = v[3];
+        j.xAxis = v[4];
+        j.yAxis = v[5];
+        j.maximumAngleX = s[0];
+        j.maximumAngleY = s[1];
+        joint = &j;
+        break;
+    }
+    case JointType::LinearAxisLimit:
+    {
+        auto &j = rig.Create<IKLinearAxisLimit>(connectionA, connectionB, zero, up, zero, s[0], s[1]);
+        j.LocalLineAnchor = v[0];
+        j.LocalLineDirection = v[1];
+        j.LocalAnchorB = v[2];
+        j.minimumDistance = s[0];
+        j.maximumDistance = s[1];
+        joint = &j;
+        break;
+    }
+    case JointType::SwingLimit:
+    {
+        auto &j = rig.Create<IKSwingLimit>(connectionA, connectionB, up, up, s[0]);
+        j.LocalAxisA = v[0];
+        j.LocalAxisB = v[1];
+        j.maximumAngle = s[0];
+        joint = &j;
+        break;
+    }
+    case JointType::TwistLimit:
+    {
+        auto &j = rig.Create<IKTwistLimit>(connectionA, connectionB, up, up, s[0]);
+        j.LocalAxisA = v[0];
+        j.LocalAxisB = v[1];
+        j.LocalMeasurementAxisA = v[2];
+        j.LocalMeasurementAxisB = v[3];
+        j.maximumAngle = s[0];
+        joint = &j;
+        break;
+    }
+    default:
+        throw std::invalid_argument("Unknown joint type in rig template.");
+    }
+    joint->Rigidity = description.rigidity;
+    joint->MaximumForce = description.maximumForce;
+    joint->SetEnabled(description.enabled != 0);
+    return *joint;
+}
+
+void BEPUik::IKRigTemplate::Instantiate(IKRig &rig) const
+{
+    auto firstBone = rig.GetBones().size();
+	for(auto &description : bones)
+    {
+        auto &bone = rig.Create<Bone>(description.position, description.orientation, description.radius, description.height);
+        bone.InertiaTensorScaling = description.inertiaTensorScaling;
+        bone.SetMass(description.mass);
+        bone.SetPinned(description.pinned != 0);
+    }
+    auto *templateBones = rig.GetBones().data() + firstBone;
+	for(auto &description : joints)
+    {
+        CreateJoint(rig, description, *templateBones[description.boneA], *templateBones[description.boneB]);
+    }
+	for(auto &description : controls)
+    {
+        auto *bone = templateBones[description.bone];
+        switch (description.type)
+        {
+        case ControlType::Drag:
+        {
+            auto &control = rig.Create<DragControl>();
+            control.SetTargetBone(bone);
+            control.LinearMotor->LocalOffset = description.localOffset;
+            control.LinearMotor->Rigidity = description.linearRigidity;
+            control.LinearMotor->TargetPosition = description.goal.position;
+            control.SetMaximumForce(description.maximumForce);
+            break;
+        }
+        case ControlType::State:
+        {
+            auto &control = rig.Create<StateControl>();
+            control.SetTargetBone(bone);
+            control.LinearMotor->LocalOffset = description.localOffset;
+            control.LinearMotor->Rigidity = description.linearRigidity;
+            control.AngularMotor->Rigidity = description.angularRigidity;
+            control.LinearMotor->TargetPosition = description.goal.position;
+            control.AngularMotor->TargetOrientation = description.goal.orientation;
+            control.SetMaximumForce(description.maximumForce);
+            break;
+        }
+        case ControlType::Revolute:
+        {
+            auto &control = rig.Create<RevoluteControl>();
+            control.SetTargetBone(bone);
+            control.AngularMotor->BoneLocalFreeAxis = description.localAxis;
+            control.AngularMotor->Rigidity = description.angularRigidity;
+            control.AngularMotor->SetFreeAxis(description.goal.axis);
+            control.SetMaximumForce(description.maximumForce);
+            break;
+        }
+        case ControlType::AngularPlane:
+        {
+            auto &control = rig.Create<AngularPlaneControl>();
+            control.SetTargetBone(bone);
+            control.AngularMotor->BoneLocalAxis = description.localAxis;
+            control.AngularMotor->Rigidity = description.angularRigidity;
+            control.AngularMotor->PlaneNormal = description.goal.axis;
+            control.SetMaximumForce(description.maximumForce);
+            break;
+        }
+        }
+    }
+}
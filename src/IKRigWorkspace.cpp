@@ -0,0 +1,513 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKRigWorkspace.hpp"
+#include "bepuik/control/AngularPlaneControl.hpp"
+#include "bepuik/control/DragControl.hpp"
+#include "bepuik/control/RevoluteControl.hpp"
+#include "bepuik/control/StateControl.hpp"
+#include "bepuik/limit/IKLimit.hpp"
+#include "JointBundles.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    using namespace BEPUik;
+
+    void ApplyGoal(Control &control, ControlType type, const ControlGoal &goal)
+    {
+        switch (type)
+        {
+        case ControlType::Drag:
+            static_cast<DragControl&>(control).LinearMotor->TargetPosition = goal.position;
+            break;
+        case ControlType::State:
+            static_cast<StateControl&>(control).LinearMotor->TargetPosition = goal.position;
+            static_cast<StateControl&>(control).AngularMotor->TargetOrientation = goal.orientation;
+            break;
+        case ControlType::Revolute:
+            static_cast<RevoluteControl&>(control).AngularMotor->SetFreeAxis(goal.axis);
+            break;
+        case ControlType::AngularPlane:
+            static_cast<AngularPlaneControl&>(control).AngularMotor->PlaneNormal = goal.axis;
+            break;
+        }
+    }
+
+    //Adds a bundle solving a constraint between the same two bones in every lane.
+    template<int Rows>
+        uint32_t AddLaneBundle(std::vector<JointBundle<Rows>> &bundles, BoneHandle handleA, BoneHandle handleB)
+    {
+        auto &bundle = bundles.emplace_back();
+        for (int lane = 0; lane < JointBundleWidth; ++lane)
+        {
+            bundle.handleA[lane] = handleA * JointBundleWidth + lane;
+            bundle.handleB[lane] = handleB * JointBundleWidth + lane;
+            bundle.entryIndex[lane] = 0;
+        }
+        return static_cast<uint32_t>(bundles.size() - 1);
+    }
+
+    //Sets the number of used lanes. Lanes beyond it are cleared so that they stay inert.
+    template<int Rows>
+        void SetLaneCount(std::vector<JointBundle<Rows>> &bundles, int laneCount)
+    {
+		for(auto &bundle : bundles)
+        {
+            if (bundle.count == laneCount)
+                continue;
+            auto cleared = JointBundle<Rows>{};
+            std::copy(std::begin(bundle.handleA), std::end(bundle.handleA), std::begin(cleared.handleA));
+            std::copy(std::begin(bundle.handleB), std::end(bundle.handleB), std::begin(cleared.handleB));
+            std::copy(std::begin(bundle.entryIndex), std::end(bundle.entryIndex), std::begin(cleared.entryIndex));
+            cleared.count = laneCount;
+            bundle = cleared;
+        }
+    }
+
+    template<int Rows>
+        void ClearLaneImpulses(std::vector<JointBundle<Rows>> &bundles)
+    {
+		for(auto &bundle : bundles)
+        {
+            for (int i = 0; i < Rows; ++i)
+                std::fill(std::begin(bundle.accumulatedImpulse[i]), std::end(bundle.accumulatedImpulse[i]), 0.f);
+        }
+    }
+
+    //Evaluates a joint for the bones of every used lane and warm starts the bundle.
+    template<int Rows>
+        void UpdateLaneBundle(JointBundle<Rows> &bundle, const IKJoint &joint, BoneStore &bones)
+    {
+        JointJacobians jacobians;
+        for (int lane = 0; lane < bundle.count; ++lane)
+        {
+            auto handleA = bundle.handleA[lane];
+            auto handleB = bundle.handleB[lane];
+            joint.ComputeJacobians(bones, handleA, handleB, jacobians);
+            jointkernels::JacobianRows<Rows> rows {&jacobians.linearA[0], &jacobians.angularA[0], &jacobians.linearB[0], &jacobians.angularB[0]};
+            float velocityBias[Rows];
+            for (int i = 0; i < Rows; ++i)
+                velocityBias[i] = jacobians.velocityBias[i];
+            float effectiveMass[Rows][Rows];
+            jointkernels::ComputeEffectiveMass<Rows>(rows, bones, handleA, handleB, joint.softness, effectiveMass);
+            jointbundles::PackLane<Rows>(bundle, lane, rows, velocityBias, effectiveMass, joint.softness, joint.MaximumImpulse, joint.MaximumImpulseSquared, bones, handleA, handleB);
+        }
+        jointbundles::WarmStart(bundle, bones);
+    }
+}
+
+BEPUik::IKRigWorkspace::IKRigWorkspace(const IKRigTemplate &rigTemplate)
+    : rigTemplate(&rigTemplate)
+{
+    rigTemplate.Instantiate(rig);
+    //The rig is private to the workspace and its topology never changes, so the active set can be built once and reused.
+    Solver.activeSet.UseCaching = true;
+    auto descriptions = rigTemplate.GetControls();
+    auto &controls = rig.GetControls();
+    motors.reserve(controls.size() * 2);
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        SingleBoneConstraint *linearMotor = nullptr;
+        SingleBoneConstraint *angularMotor = nullptr;
+        switch (descriptions[i].type)
+        {
+        case ControlType::Drag:
+            linearMotor = static_cast<DragControl*>(controls[i])->LinearMotor;
+            break;
+        case ControlType::State:
+            linearMotor = static_cast<StateControl*>(controls[i])->LinearMotor;
+            angularMotor = static_cast<StateControl*>(controls[i])->AngularMotor;
+            break;
+        case ControlType::Revolute:
+            angularMotor = static_cast<RevoluteControl*>(controls[i])->AngularMotor;
+            break;
+        case ControlType::AngularPlane:
+            angularMotor = static_cast<AngularPlaneControl*>(controls[i])->AngularMotor;
+            break;
+        }
+        motors.push_back(linearMotor);
+        motors.push_back(angularMotor);
+    }
+}
+
+void BEPUik::IKRigWorkspace::CheckInstance(const IKRigInstance &instance) const
+{
+    if (instance.rigTemplate != rigTemplate)
+        throw std::invalid_argument("The instance belongs to a different rig template.");
+    auto boneCount = rig.GetBones().size();
+    if (instance.Positions.size() != boneCount || instance.Orientations.size() != boneCount || instance.Goals.size() != rigTemplate->GetControls().size())
+        throw std::invalid_argument("The instance's pose and goals must match the bones and controls of its template.");
+}
+
+void BEPUik::IKRigWorkspace::Solve(IKRigInstance &instance)
+{
+    CheckInstance(instance);
+
+    //Load the instance into the workspace rig.
+    auto &bones = rig.GetBones();
+    for (size_t i = 0; i < bones.size(); ++i)
+    {
+        bones[i]->Position = instance.Positions[i];
+        bones[i]->Orientation = instance.Orientations[i];
+    }
+    auto descriptions = rigTemplate->GetControls();
+    auto &controls = rig.GetControls();
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        ApplyGoal(*controls[i], descriptions[i].type, instance.Goals[i]);
+    }
+    for (size_t i = 0; i < motors.size(); ++i)
+    {
+        if (motors[i])
+            motors[i]->accumulatedImpulse = instance.controlImpulses[i];
+    }
+    Solver.SwapWarmStartState(instance.warmStart);
+
+    Solver.Solve(controls);
+
+    //Write the results back.
+    Solver.SwapWarmStartState(instance.warmStart);
+    for (size_t i = 0; i < motors.size(); ++i)
+    {
+        if (motors[i])
+            instance.controlImpulses[i] = motors[i]->accumulatedImpulse;
+    }
+    for (size_t i = 0; i < bones.size(); ++i)
+    {
+        instance.Positions[i] = bones[i]->Position;
+        instance.Orientations[i] = bones[i]->Orientation;
+    }
+}
+
+void BEPUik::IKRigWorkspace::Solve(std::span<IKRigInstance* const> instances)
+{
+	for(auto *instance : instances)
+        CheckInstance(*instance);
+
+    //The instances share the topology and controls of the workspace rig, so its active set describes all of them.
+    Solver.activeSet.UpdateActiveSet(rig.GetControls());
+    if (laneVersion != Solver.activeSet.GetVersion())
+        BuildLanes();
+    for (size_t first = 0; first < instances.size(); first += JointBundleWidth)
+        SolveLanes(instances.subspan(first, std::min<size_t>(JointBundleWidth, instances.size() - first)));
+}
+
+void BEPUik::IKRigWorkspace::BuildLanes()
+{
+    auto &activeSet = Solver.activeSet;
+    auto &store = activeSet.boneStore;
+    std::unordered_map<const Bone*, uint32_t> boneIndices;
+    for (size_t i = 0; i < rig.GetBones().size(); ++i)
+        boneIndices[rig.GetBones()[i]] = static_cast<uint32_t>(i);
+
+    laneBones.Clear();
+    laneBoneIndices.clear();
+    for (size_t handle = 0; handle < store.GetCount(); ++handle)
+    {
+        laneBoneIndices.push_back(boneIndices.at(store.bones[handle]));
+        for (int lane = 0; lane < JointBundleWidth; ++lane)
+            laneBones.AddUnbound(store.inverseMasses[handle], store.localInertiaTensorInverses[handle], store.IsIntegrated(static_cast<BoneHandle>(handle)));
+    }
+
+    laneJoints.clear();
+    laneBundles1.clear();
+    laneBundles2.clear();
+    laneBundles3.clear();
+	for(auto *joint : activeSet.joints)
+    {
+        LaneJoint laneJoint {joint, joint->GetDegreesOfFreedom(), 0, dynamic_cast<IKLimit*>(joint) != nullptr};
+        switch (laneJoint.rows)
+        {
+        case 1:
+            laneJoint.bundle = AddLaneBundle(laneBundles1, joint->m_handleA, joint->m_handleB);
+            break;
+        case 2:
+            laneJoint.bundle = AddLaneBundle(laneBundles2, joint->m_handleA, joint->m_handleB);
+            break;
+        default:
+            laneJoint.bundle = AddLaneBundle(laneBundles3, joint->m_handleA, joint->m_handleB);
+            break;
+        }
+        laneJoints.push_back(laneJoint);
+    }
+
+    //Motors only act on their target bone; the second bone of the bundle is the same bone with zero jacobians.
+    laneMotors.clear();
+    laneMotorBundles.clear();
+    for (size_t i = 0; i < motors.size(); ++i)
+    {
+        if (!motors[i])
+            continue;
+        auto handle = motors[i]->TargetBone->handle;
+        AddLaneBundle(laneMotorBundles, handle, handle);
+        laneMotors.push_back({static_cast<uint32_t>(i / 2), static_cast<uint32_t>(i)});
+    }
+    laneVersion = activeSet.GetVersion();
+}
+
+void BEPUik::IKRigWorkspace::SolveLanes(std::span<IKRigInstance* const> instances)
+{
+    auto laneCount = static_cast<int>(instances.size());
+    auto &activeSet = Solver.activeSet;
+    auto &controls = rig.GetControls();
+
+    //Load the poses. Unused lanes get a copy of the first instance so that their bone state stays valid.
+    for (size_t handle = 0; handle < laneBoneIndices.size(); ++handle)
+    {
+        auto boneIndex = laneBoneIndices[handle];
+        for (int lane = 0; lane < JointBundleWidth; ++lane)
+        {
+            auto &instance = *instances[lane < laneCount ? lane : 0];
+            auto laneHandle = handle * JointBundleWidth + lane;
+            laneBones.positions[laneHandle] = instance.Positions[boneIndex];
+            laneBones.SetOrientation(static_cast<BoneHandle>(laneHandle), instance.Orientations[boneIndex]);
+            laneBones.linearVelocities[laneHandle] = vector3::Create();
+            laneBones.angularVelocities[laneHandle] = vector3::Create();
+        }
+    }
+    SetLaneCount(laneBundles1, laneCount);
+    SetLaneCount(laneBundles2, laneCount);
+    SetLaneCount(laneBundles3, laneCount);
+    SetLaneCount(laneMotorBundles, laneCount);
+
+    if (Solver.AutoscaleControlImpulses)
+    {
+        //The instances share the masses of the workspace bones.
+		for(auto *control : controls)
+        {
+            control->SetMaximumForce(control->GetTargetBone()->GetMass() * Solver.AutoscaleControlMaximumForce);
+        }
+    }
+    lanePermutationMapper.SetPermutationIndex(0);
+    float updateRate = 1 / Solver.GetTimeStepDuration();
+	for(auto *joint : activeSet.joints)
+    {
+        joint->Preupdate(Solver.GetTimeStepDuration(), updateRate);
+    }
+	for(auto *control : controls)
+    {
+        control->Preupdate(Solver.GetTimeStepDuration(), updateRate);
+    }
+
+    //Kept impulses follow the same rules as in Solve(IKRigInstance&), per instance.
+    LoadLaneImpulses(instances, false);
+    bool keepControlImpulses[JointBundleWidth];
+    for (int lane = 0; lane < laneCount; ++lane)
+    {
+        auto &warmStart = instances[lane]->warmStart;
+        keepControlImpulses[lane] = Solver.PersistAccumulatedImpulses && warmStart.controls == controls && warmStart.controlPhase.joints == Solver.activeSet.joints;
+    }
+    for (size_t i = 0; i < laneMotors.size(); ++i)
+    {
+        auto &bundle = laneMotorBundles[i];
+        for (int lane = 0; lane < laneCount; ++lane)
+        {
+            auto &instance = *instances[lane];
+            auto impulse = keepControlImpulses[lane] ? instance.controlImpulses[laneMotors[i].motor] : vector3::Create();
+            for (int k = 0; k < 3; ++k)
+                bundle.accumulatedImpulse[k][lane] = impulse[k];
+        }
+    }
+
+    for (int i = 0; i < Solver.ControlIterationCount; i++)
+    {
+        laneBones.UpdateInertiaTensors();
+        UpdateLaneJoints();
+        UpdateLaneMotors(instances);
+        for (int j = 0; j < Solver.VelocitySubiterationCount; j++)
+        {
+            SolveLaneVelocities(true);
+            lanePermutationMapper.SetPermutationIndex(lanePermutationMapper.GetPermutationIndex() +1);
+        }
+        float motion = laneBones.UpdatePositions();
+        if (Solver.ConvergenceTolerance > 0 && motion < Solver.ConvergenceTolerance)
+            break;
+    }
+
+    StoreLaneImpulses(instances, false);
+    LoadLaneImpulses(instances, true);
+    for (int i = 0; i < Solver.FixerIterationCount; i++)
+    {
+        laneBones.UpdateInertiaTensors();
+        UpdateLaneJoints();
+        for (int j = 0; j < Solver.VelocitySubiterationCount; j++)
+        {
+            SolveLaneVelocities(false);
+            lanePermutationMapper.SetPermutationIndex(lanePermutationMapper.GetPermutationIndex() +1);
+        }
+        float motion = laneBones.UpdatePositions();
+        if (Solver.ConvergenceTolerance > 0 && motion < Solver.ConvergenceTolerance)
+            break;
+    }
+    StoreLaneImpulses(instances, true);
+
+    for (int lane = 0; lane < laneCount; ++lane)
+    {
+        auto &instance = *instances[lane];
+        for (size_t i = 0; i < laneMotors.size(); ++i)
+        {
+            Vector3 impulse = vector3::Create();
+            if (Solver.PersistAccumulatedImpulses)
+            {
+                for (int k = 0; k < 3; ++k)
+                    impulse[k] = laneMotorBundles[i].accumulatedImpulse[k][lane] * Solver.PersistentImpulseScale;
+            }
+            instance.controlImpulses[laneMotors[i].motor] = impulse;
+        }
+        if (Solver.PersistAccumulatedImpulses)
+            instance.warmStart.controls = controls;
+        else
+            instance.warmStart.controls.clear();
+        for (size_t handle = 0; handle < laneBoneIndices.size(); ++handle)
+        {
+            auto laneHandle = handle * JointBundleWidth + lane;
+            instance.Positions[laneBoneIndices[handle]] = laneBones.positions[laneHandle];
+            instance.Orientations[laneBoneIndices[handle]] = laneBones.orientations[laneHandle];
+        }
+    }
+}
+
+void BEPUik::IKRigWorkspace::UpdateLaneJoints()
+{
+	for(auto &laneJoint : laneJoints)
+    {
+        switch (laneJoint.rows)
+        {
+        case 1:
+            UpdateLaneBundle(laneBundles1[laneJoint.bundle], *laneJoint.joint, laneBones);
+            break;
+        case 2:
+            UpdateLaneBundle(laneBundles2[laneJoint.bundle], *laneJoint.joint, laneBones);
+            break;
+        default:
+            UpdateLaneBundle(laneBundles3[laneJoint.bundle], *laneJoint.joint, laneBones);
+            break;
+        }
+    }
+}
+
+void BEPUik::IKRigWorkspace::UpdateLaneMotors(std::span<IKRigInstance* const> instances)
+{
+    static const Vector3 noJacobian[3] {vector3::Create(), vector3::Create(), vector3::Create()};
+    auto descriptions = rigTemplate->GetControls();
+    auto &controls = rig.GetControls();
+    SingleBoneJacobians jacobians;
+    for (size_t lane = 0; lane < instances.size(); ++lane)
+    {
+        //The motors are shared by all lanes, so they are pointed at each instance's goals in turn.
+        for (size_t i = 0; i < controls.size(); ++i)
+            ApplyGoal(*controls[i], descriptions[i].type, instances[lane]->Goals[i]);
+        for (size_t i = 0; i < laneMotors.size(); ++i)
+        {
+            auto &bundle = laneMotorBundles[i];
+            auto *motor = motors[laneMotors[i].motor];
+            auto handle = bundle.handleA[lane];
+            motor->ComputeJacobians(laneBones.positions[handle], laneBones.orientations[handle], jacobians);
+            jointkernels::JacobianRows<3> rows {&jacobians.linear[0], &jacobians.angular[0], noJacobian, noJacobian};
+            float velocityBias[3] {jacobians.velocityBias[0], jacobians.velocityBias[1], jacobians.velocityBias[2]};
+            float effectiveMass[3][3];
+            jointkernels::ComputeEffectiveMass<3>(rows, laneBones, handle, handle, motor->softness, effectiveMass);
+            jointbundles::PackLane<3>(bundle, static_cast<int>(lane), rows, velocityBias, effectiveMass, motor->softness, motor->MaximumImpulse, motor->MaximumImpulseSquared, laneBones, handle, handle);
+        }
+    }
+	for(auto &bundle : laneMotorBundles)
+        jointbundles::WarmStart(bundle, laneBones);
+}
+
+void BEPUik::IKRigWorkspace::SolveLaneVelocities(bool includeMotors)
+{
+    auto simdLevel = std::min(Solver.MaximumSimdLevel, GetSupportedSimdLevel());
+    //Like the sequential solver, the controls go first and the joints follow in permuted order.
+    if (includeMotors)
+    {
+		for(auto &bundle : laneMotorBundles)
+            jointbundles::Solve(bundle, false, simdLevel, laneBones);
+    }
+    auto count = static_cast<int>(laneJoints.size());
+    for (int i = 0; i < count; ++i)
+    {
+        auto &laneJoint = laneJoints[lanePermutationMapper.GetMappedIndex(i, count)];
+        switch (laneJoint.rows)
+        {
+        case 1:
+            jointbundles::Solve(laneBundles1[laneJoint.bundle], laneJoint.isLimit, simdLevel, laneBones);
+            break;
+        case 2:
+            jointbundles::Solve(laneBundles2[laneJoint.bundle], laneJoint.isLimit, simdLevel, laneBones);
+            break;
+        default:
+            jointbundles::Solve(laneBundles3[laneJoint.bundle], laneJoint.isLimit, simdLevel, laneBones);
+            break;
+        }
+    }
+}
+
+float &BEPUik::IKRigWorkspace::LaneImpulse(const LaneJoint &joint, int row, int lane)
+{
+    switch (joint.rows)
+    {
+    case 1:
+        return laneBundles1[joint.bundle].accumulatedImpulse[row][lane];
+    case 2:
+        return laneBundles2[joint.bundle].accumulatedImpulse[row][lane];
+    default:
+        return laneBundles3[joint.bundle].accumulatedImpulse[row][lane];
+    }
+}
+
+void BEPUik::IKRigWorkspace::LoadLaneImpulses(std::span<IKRigInstance* const> instances, bool fixerPhase)
+{
+    auto &activeJoints = Solver.activeSet.joints;
+    for (size_t lane = 0; lane < instances.size(); ++lane)
+    {
+        auto &warmStart = instances[lane]->warmStart;
+        auto &persistent = fixerPhase ? warmStart.fixerPhase : warmStart.controlPhase;
+        //The control phase impulses are only meaningful if the same controls are pulling on the same joints.
+        bool restore = Solver.PersistAccumulatedImpulses && persistent.joints == activeJoints && (fixerPhase || warmStart.controls == rig.GetControls());
+        for (size_t i = 0; i < laneJoints.size(); ++i)
+        {
+            for (int row = 0; row < laneJoints[i].rows; ++row)
+                LaneImpulse(laneJoints[i], row, static_cast<int>(lane)) = restore ? persistent.impulses[i][row] * Solver.PersistentImpulseScale : 0.f;
+        }
+    }
+}
+
+void BEPUik::IKRigWorkspace::StoreLaneImpulses(std::span<IKRigInstance* const> instances, bool fixerPhase)
+{
+    for (size_t lane = 0; lane < instances.size(); ++lane)
+    {
+        auto &warmStart = instances[lane]->warmStart;
+        auto &persistent = fixerPhase ? warmStart.fixerPhase : warmStart.controlPhase;
+        persistent.joints.clear();
+        persistent.impulses.clear();
+        if (!Solver.PersistAccumulatedImpulses)
+            continue;
+        persistent.joints = Solver.activeSet.joints;
+        persistent.impulses.reserve(laneJoints.size());
+		for(auto &laneJoint : laneJoints)
+        {
+            Vector3 impulse = vector3::Create();
+            for (int row = 0; row < laneJoint.rows; ++row)
+                impulse[row] = LaneImpulse(laneJoint, row, static_cast<int>(lane));
+            persistent.impulses.push_back(impulse);
+        }
+    }
+    ClearLaneImpulses(laneBundles1);
+    ClearLaneImpulses(laneBundles2);
+    ClearLaneImpulses(laneBundles3);
+}
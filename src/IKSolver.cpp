@@ -14,154 +14,197 @@
 // limitations under the License.
 
 #include "bepuik/IKSolver.hpp"
+#include <algorithm>
 #include <cassert>
 
+//Times the remainder of the enclosing scope as the given phase of the current solve.
+#define BEPUIK_SOLVE_PHASE(phase) BEPUIK_STATS(SolvePhaseScope phaseScope(lastSolveStats, phaseCallback, SolvePhase::phase))
+
 BEPUik::IKSolver::IKSolver()
 {}
 
 void BEPUik::IKSolver::Solve(std::vector<IKJoint*> &joints)
 {
-    activeSet.UpdateActiveSet(joints);
+    BEPUIK_STATS(lastSolveStats.Reset());
+    BEPUIK_STATS(auto solveStart = std::chrono::steady_clock::now());
+    {
+        BEPUIK_SOLVE_PHASE(ActiveSetUpdate);
+        activeSet.UpdateActiveSet(joints);
+    }
+    {
+        BEPUIK_SOLVE_PHASE(Preparation);
+        PrepareJointSolve();
+        lastSolveWarmStarted = RestoreJointImpulses(warmStart.fixerPhase);
+        lastPresolvedLimbCount = 0;
 
-    //Reset the permutation index; every solve should proceed in exactly the same order.
-    permutationMapper.SetPermutationIndex(0);
+        //Reset the permutation index; every solve should proceed in exactly the same order.
+        permutationMapper.SetPermutationIndex(0);
 
-    float updateRate = 1 / GetTimeStepDuration();
-	for(auto *joint : activeSet.joints)
+        float updateRate = 1 / GetTimeStepDuration();
+        PreupdateJoints(updateRate);
+    }
+
+    if (UseIslands)
     {
-        joint->Preupdate(GetTimeStepDuration(), updateRate);
+        SolveIslands(nullptr);
+        BEPUIK_STATS(EndSolveStats(solveStart, 0));
+        return;
     }
 
+    lastControlIterationCount = 0;
+    lastFixerIterationCount = 0;
     for (int i = 0; i < FixerIterationCount; i++)
     {
-        //Update the world inertia tensors of objects for the latest position.
-		for(auto *bone : activeSet.bones)
         {
-            bone->UpdateInertiaTensor();
+            //Update the world inertia tensors of objects for the latest position.
+            BEPUIK_SOLVE_PHASE(InertiaTensorUpdate);
+            activeSet.boneStore.UpdateInertiaTensors();
         }
 
-        //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
-		for(auto *joint : activeSet.joints)
+        //Reused effective masses skip the most expensive part of the update.
+        bool updateEffectiveMass = ScheduleEffectiveMassUpdate(effectiveMassSchedule, i);
         {
-            joint->UpdateJacobiansAndVelocityBias();
-            joint->ComputeEffectiveMass();
-            joint->WarmStart();
+            //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
+            BEPUIK_SOLVE_PHASE(JointUpdate);
+            UpdateJoints(updateEffectiveMass);
         }
 
-        for (int j = 0; j < VelocitySubiterationCount; j++)
         {
-            //A permuted version of the indices is used. The randomization tends to avoid issues with solving order in corner cases.
-            for (int jointIndex = 0; jointIndex < activeSet.joints.size(); ++jointIndex)
+            BEPUIK_SOLVE_PHASE(VelocitySolve);
+            for (int j = 0; j < VelocitySubiterationCount; j++)
             {
-                auto remappedIndex = permutationMapper.GetMappedIndex(jointIndex, static_cast<int>(activeSet.joints.size()));
-                activeSet.joints[remappedIndex]->SolveVelocityIteration();
+                SolveJointVelocities();
+                //Increment to use the next permutation.
+                permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
             }
-            //Increment to use the next permutation.
-            permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
         }
 
         //Integrate the positions of the bones forward.
-		for(auto *bone : activeSet.bones)
-        {
-            bone->UpdatePosition();
-        }
+        if (IntegrateBones(lastFixerIterationCount, lastSolveStats.fixerResidual))
+            break;
     }
 
     //Clear accumulated impulses; they should not persist through to another solving round because the state could be arbitrarily different.
-    for (int j = 0; j < activeSet.joints.size(); j++)
-    {
-        activeSet.joints[j]->ClearAccumulatedImpulses();
-    }
+    //The exception is the opt-in persistent mode, where the next solve starts from them if the active set is unchanged.
+    EndJointPhase(warmStart.fixerPhase);
+    BEPUIK_STATS(EndSolveStats(solveStart, 0));
 }
 
 void BEPUik::IKSolver::Solve(std::vector<Control*> &controls)
 {
-    //Update the list of active joints.
-    activeSet.UpdateActiveSet(controls);
-
-    if (AutoscaleControlImpulses)
+    BEPUIK_STATS(lastSolveStats.Reset());
+    BEPUIK_STATS(auto solveStart = std::chrono::steady_clock::now());
     {
-        //Update the control strengths to match the mass of the target bones and the desired maximum force.
-		for(auto *control : controls)
+        //Update the list of active joints.
+        BEPUIK_SOLVE_PHASE(ActiveSetUpdate);
+        activeSet.UpdateActiveSet(controls);
+    }
+    {
+        BEPUIK_SOLVE_PHASE(Preparation);
+        PrepareJointSolve();
+
+        //Kept impulses are only meaningful if the same controls are pulling on the same joints.
+        lastSolveWarmStarted = PersistAccumulatedImpulses && controls == warmStart.controls && RestoreJointImpulses(warmStart.controlPhase);
+        if (PersistAccumulatedImpulses && !lastSolveWarmStarted)
         {
-            control->SetMaximumForce(control->GetTargetBone()->GetMass() * AutoscaleControlMaximumForce);
+            //Cold start everything; the controls may still hold impulses from an older solve or a different active set.
+			for(auto *control : controls)
+            {
+                control->ScaleAccumulatedImpulses(0);
+            }
+        }
+
+        if (AutoscaleControlImpulses)
+        {
+            //Update the control strengths to match the mass of the target bones and the desired maximum force.
+			for(auto *control : controls)
+            {
+                control->SetMaximumForce(control->GetTargetBone()->GetMass() * AutoscaleControlMaximumForce);
+            }
         }
-    }
 
-    //Reset the permutation index; every solve should proceed in exactly the same order.
-	permutationMapper.SetPermutationIndex(0);
+        //Place simple limbs close to their goals so the control iterations only have to polish them.
+        lastPresolvedLimbCount = UseTwoBonePresolve ? twoBonePresolver.Apply(controls, activeSet.boneStore) : 0;
 
-    float updateRate = 1 / GetTimeStepDuration();
-	for(auto *joint : activeSet.joints)
-    {
-        joint->Preupdate(GetTimeStepDuration(), updateRate);
+        //Reset the permutation index; every solve should proceed in exactly the same order.
+		permutationMapper.SetPermutationIndex(0);
+
+        float updateRate = 1 / GetTimeStepDuration();
+        PreupdateJoints(updateRate);
+		for(auto *control : controls)
+        {
+            control->Preupdate(GetTimeStepDuration(), updateRate);
+        }
     }
-	for(auto *control : controls)
+
+    if (UseIslands)
     {
-        control->Preupdate(GetTimeStepDuration(), updateRate);
+        SolveIslands(&controls);
+        KeepControlImpulses(controls);
+        BEPUIK_STATS(EndSolveStats(solveStart, controls.size()));
+        return;
     }
 	
     //Go through the set of controls and active joints, updating the state of bones.
+    lastControlIterationCount = 0;
     for (int i = 0; i < ControlIterationCount; i++)
     {
-        //Update the world inertia tensors of objects for the latest position.
-		for(auto *bone : activeSet.bones)
         {
-            bone->UpdateInertiaTensor();
+            //Update the world inertia tensors of objects for the latest position.
+            BEPUIK_SOLVE_PHASE(InertiaTensorUpdate);
+            activeSet.boneStore.UpdateInertiaTensors();
         }
 
-        //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
-		for(auto *joint : activeSet.joints)
+        //Reused effective masses skip the most expensive part of the update.
+        bool updateEffectiveMass = ScheduleEffectiveMassUpdate(effectiveMassSchedule, i);
         {
-            joint->UpdateJacobiansAndVelocityBias();
-            joint->ComputeEffectiveMass();
-            joint->WarmStart();
+            //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
+            BEPUIK_SOLVE_PHASE(JointUpdate);
+            UpdateJoints(updateEffectiveMass);
         }
 
-		for(auto *control : controls)
         {
-			assert(!control->GetTargetBone()->Pinned);
-            //if (control->GetTargetBone()->Pinned)
-            //    throw std::runtime_error("Pinned objects cannot be moved by controls.");
-            control->UpdateJacobiansAndVelocityBias();
-            control->ComputeEffectiveMass();
-            control->WarmStart();
-        }
-
-        for (int j = 0; j < VelocitySubiterationCount; j++)
-        {
-            //Controls are updated first.
+            BEPUIK_SOLVE_PHASE(ControlUpdate);
 			for(auto *control : controls)
             {
-                control->SolveVelocityIteration();
+				assert(!control->GetTargetBone()->Pinned);
+                //if (control->GetTargetBone()->Pinned)
+                //    throw std::runtime_error("Pinned objects cannot be moved by controls.");
+                control->UpdateJacobiansAndVelocityBias();
+                if (updateEffectiveMass)
+                    control->ComputeEffectiveMass();
+                control->WarmStart();
             }
+        }
 
-            //A permuted version of the indices is used. The randomization tends to avoid issues with solving order in corner cases.
-            for (int jointIndex = 0; jointIndex < activeSet.joints.size(); ++jointIndex)
+        {
+            BEPUIK_SOLVE_PHASE(VelocitySolve);
+            for (int j = 0; j < VelocitySubiterationCount; j++)
             {
-                auto remappedIndex = permutationMapper.GetMappedIndex(jointIndex, static_cast<int>(activeSet.joints.size()));
-                activeSet.joints[remappedIndex]->SolveVelocityIteration();
-            }
-            //Increment to use the next permutation.
-            permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
+                //Controls are updated first.
+				for(auto *control : controls)
+                {
+                    control->SolveVelocityIteration();
+                }
+
+                SolveJointVelocities();
+                //Increment to use the next permutation.
+                permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
 
 
+            }
         }
 
         //Integrate the positions of the bones forward.
-		for(auto *bone : activeSet.bones)
-        {
-            bone->UpdatePosition();
-        }
+        if (IntegrateBones(lastControlIterationCount, lastSolveStats.controlResidual))
+            break;
     }
 
     //Clear the control iteration accumulated impulses; they should not persist through to the fixer iterations since the stresses are (potentially) totally different.
     //This just helps stability in some corner cases. Withclearing this, previous high stress would prime the fixer iterations with bad guesses,
     //making the system harder to solve (i.e. introducing instability and requiring more iterations).
-    for (int j = 0; j < activeSet.joints.size(); j++)
-    {
-        activeSet.joints[j]->ClearAccumulatedImpulses();
-    }
+    EndJointPhase(warmStart.controlPhase);
+    RestoreJointImpulses(warmStart.fixerPhase);
 
 
     //The previous loop may still have significant errors in the active joints due to 
@@ -169,51 +212,415 @@ void BEPUik::IKSolver::Solve(std::vector<Control*> &controls)
     //fix the errors withinterference from impossible goals
     //This can potentially cause the bones to move away from the control targets, but with a sufficient
     //number of control iterations, the result is generally a good approximation.
+    lastFixerIterationCount = 0;
     for (int i = 0; i < FixerIterationCount; i++)
     {
-        //Update the world inertia tensors of objects for the latest position.
-		for(auto *bone : activeSet.bones)
         {
-            bone->UpdateInertiaTensor();
+            //Update the world inertia tensors of objects for the latest position.
+            BEPUIK_SOLVE_PHASE(InertiaTensorUpdate);
+            activeSet.boneStore.UpdateInertiaTensors();
         }
 
-        //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
-		for(auto *joint : activeSet.joints)
+        //Reused effective masses skip the most expensive part of the update.
+        bool updateEffectiveMass = ScheduleEffectiveMassUpdate(effectiveMassSchedule, i);
         {
-            joint->UpdateJacobiansAndVelocityBias();
-            joint->ComputeEffectiveMass();
-            joint->WarmStart();
+            //Update the per-constraint jacobians and effective mass for the current bone orientations and positions.
+            BEPUIK_SOLVE_PHASE(JointUpdate);
+            UpdateJoints(updateEffectiveMass);
         }
 
-        for (int j = 0; j < VelocitySubiterationCount; j++)
         {
-            //A permuted version of the indices is used. The randomization tends to avoid issues with solving order in corner cases.
-            for (int jointIndex = 0; jointIndex < activeSet.joints.size(); ++jointIndex)
+            BEPUIK_SOLVE_PHASE(VelocitySolve);
+            for (int j = 0; j < VelocitySubiterationCount; j++)
             {
-                auto remappedIndex = permutationMapper.GetMappedIndex(jointIndex, static_cast<int>(activeSet.joints.size()));
-                activeSet.joints[remappedIndex]->SolveVelocityIteration();
+                SolveJointVelocities();
+                //Increment to use the next permutation.
+                permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
             }
-            //Increment to use the next permutation.
-            permutationMapper.SetPermutationIndex(permutationMapper.GetPermutationIndex() +1);
-
         }
 
         //Integrate the positions of the bones forward.
-		for(auto *bone : activeSet.bones)
+        if (IntegrateBones(lastFixerIterationCount, lastSolveStats.fixerResidual))
+            break;
+    }
+
+    //Clear accumulated impulses; they should not persist through to another solving round because the state could be arbitrarily different.
+    //The exception is the opt-in persistent mode, where the next solve starts from them if the active set is unchanged.
+    EndJointPhase(warmStart.fixerPhase);
+
+    KeepControlImpulses(controls);
+    BEPUIK_STATS(EndSolveStats(solveStart, controls.size()));
+}
+
+void BEPUik::IKSolver::KeepControlImpulses(std::vector<Control*> &controls)
+{
+    if (PersistAccumulatedImpulses)
+    {
+        warmStart.controls = controls;
+		for(auto *control : controls)
         {
-            bone->UpdatePosition();
+            control->ScaleAccumulatedImpulses(PersistentImpulseScale);
         }
     }
+    else
+    {
+        warmStart.controls.clear();
+		for(auto *control : controls)
+        {
+            control->ClearAccumulatedImpulses();
+        }
+    }
+}
 
-    //Clear accumulated impulses; they should not persist through to another solving round because the state could be arbitrarily different.
-    for (int j = 0; j < activeSet.joints.size(); j++)
+void BEPUik::IKSolver::SolveIslands(const std::vector<Control*> *controls)
+{
+    BEPUIK_SOLVE_PHASE(IslandSolve);
+    auto &islands = activeSet.islands;
+    islandStates.resize(islands.size());
+	for(auto &state : islandStates)
+        state.controls.clear();
+    if (controls)
     {
-        activeSet.joints[j]->ClearAccumulatedImpulses();
+		for(auto *control : *controls)
+        {
+            islandStates[activeSet.boneIslands[control->GetTargetBone()->handle]].controls.push_back(control);
+        }
     }
 
-	for(auto *control : controls)
+    //The islands keep their impulses in place, so the kept fixer impulses have to be checked against the active set before any island overwrites them.
+    //Without controls, they were already restored during the preparation.
+    bool restoreFixerPhase = controls && PersistAccumulatedImpulses && warmStart.fixerPhase.joints == activeSet.joints;
+    for (auto *persistent : {&warmStart.controlPhase, &warmStart.fixerPhase})
+    {
+        if (!controls && persistent == &warmStart.controlPhase)
+            continue;
+        if (PersistAccumulatedImpulses)
+        {
+            persistent->joints = activeSet.joints;
+            persistent->impulses.resize(activeSet.joints.size());
+        }
+        else
+        {
+            persistent->joints.clear();
+            persistent->impulses.clear();
+        }
+    }
+
+    //Islands share no moving bones, so they can run concurrently; joints on their borders only read the pinned bones.
+    workerGroup->ParallelFor(islands.size(), [&](size_t begin, size_t end, uint32_t) {
+        for (size_t i = begin; i < end; ++i)
+            SolveIsland(islandStates[i], islands[i], controls != nullptr, restoreFixerPhase);
+    });
+
+    lastControlIterationCount = 0;
+    lastFixerIterationCount = 0;
+	for(auto &state : islandStates)
+    {
+        lastControlIterationCount = std::max(lastControlIterationCount, state.controlIterationCount);
+        lastFixerIterationCount = std::max(lastFixerIterationCount, state.fixerIterationCount);
+        BEPUIK_STATS(lastSolveStats.controlResidual = std::max(lastSolveStats.controlResidual, state.controlResidual));
+        BEPUIK_STATS(lastSolveStats.fixerResidual = std::max(lastSolveStats.fixerResidual, state.fixerResidual));
+    }
+}
+
+void BEPUik::IKSolver::SolveIsland(IslandState &state, const ActiveIsland &island, bool solveControls, bool restoreFixerPhase)
+{
+    //Each island proceeds through the same permutations as if it was solved alone.
+    state.permutationMapper.SetPermutationIndex(0);
+    state.controlIterationCount = 0;
+    state.fixerIterationCount = 0;
+    state.controlResidual = 0;
+    state.fixerResidual = 0;
+    if (solveControls)
+    {
+        for (int i = 0; i < ControlIterationCount; i++)
+        {
+            if (IterateIsland(state, island, true, state.controlIterationCount, state.controlResidual))
+                break;
+        }
+        EndIslandPhase(island, warmStart.controlPhase);
+        if (restoreFixerPhase)
+        {
+			for(auto index : island.joints)
+            {
+                activeSet.joints[index]->accumulatedImpulse = vector3::Multiply(warmStart.fixerPhase.impulses[index], PersistentImpulseScale);
+            }
+        }
+    }
+    for (int i = 0; i < FixerIterationCount; i++)
+    {
+        if (IterateIsland(state, island, false, state.fixerIterationCount, state.fixerResidual))
+            break;
+    }
+    EndIslandPhase(island, warmStart.fixerPhase);
+}
+
+bool BEPUik::IKSolver::IterateIsland(IslandState &state, const ActiveIsland &island, bool solveControls, int &iterationCount, float &residual)
+{
+    auto &bones = activeSet.boneStore;
+    bones.UpdateInertiaTensors(island.bones);
+    bool updateEffectiveMass = ScheduleEffectiveMassUpdate(state.effectiveMassSchedule, iterationCount);
+	for(auto index : island.joints)
+    {
+        auto *joint = activeSet.joints[index];
+        joint->UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint->ComputeEffectiveMass();
+        joint->WarmStart();
+    }
+    if (solveControls)
+    {
+		for(auto *control : state.controls)
+        {
+            control->UpdateJacobiansAndVelocityBias();
+            if (updateEffectiveMass)
+                control->ComputeEffectiveMass();
+            control->WarmStart();
+        }
+    }
+
+    auto jointCount = static_cast<int>(island.joints.size());
+    for (int j = 0; j < VelocitySubiterationCount; j++)
+    {
+        if (solveControls)
+        {
+			for(auto *control : state.controls)
+            {
+                control->SolveVelocityIteration();
+            }
+        }
+        for (int jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+        {
+            auto remappedIndex = state.permutationMapper.GetMappedIndex(jointIndex, jointCount);
+            activeSet.joints[island.joints[remappedIndex]]->SolveVelocityIteration();
+        }
+        state.permutationMapper.SetPermutationIndex(state.permutationMapper.GetPermutationIndex() +1);
+    }
+
+    ++iterationCount;
+    residual = bones.UpdatePositions(island.bones);
+    state.effectiveMassSchedule.motion += residual;
+    return ConvergenceTolerance > 0 && residual < ConvergenceTolerance;
+}
+
+void BEPUik::IKSolver::EndIslandPhase(const ActiveIsland &island, PersistentImpulses &persistent)
+{
+	for(auto index : island.joints)
+    {
+        auto *joint = activeSet.joints[index];
+        if (PersistAccumulatedImpulses)
+            persistent.impulses[index] = joint->accumulatedImpulse;
+        joint->ClearAccumulatedImpulses();
+    }
+}
+
+bool BEPUik::IKSolver::IntegrateBones(int &iterationCount, float &residual)
+{
+    BEPUIK_SOLVE_PHASE(Integration);
+    ++iterationCount;
+    float motion = activeSet.boneStore.UpdatePositions();
+    residual = motion;
+    effectiveMassSchedule.motion += motion;
+    //Once the bones stop moving, further iterations can't improve the pose.
+    return ConvergenceTolerance > 0 && motion < ConvergenceTolerance;
+}
+
+bool BEPUik::IKSolver::ScheduleEffectiveMassUpdate(EffectiveMassSchedule &schedule, int iteration) const
+{
+    //No bone can have rotated further than the sum of the largest motions since the last update.
+    if (iteration == 0 || iteration - schedule.lastUpdateIteration >= EffectiveMassUpdateInterval ||
+        (EffectiveMassRotationThreshold > 0 && schedule.motion > EffectiveMassRotationThreshold))
+    {
+        schedule.lastUpdateIteration = iteration;
+        schedule.motion = 0;
+        return true;
+    }
+    return false;
+}
+
+void BEPUik::IKSolver::EndSolveStats(std::chrono::steady_clock::time_point start, size_t controlCount)
+{
+    lastSolveStats.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lastSolveStats.controlIterationCount = lastControlIterationCount;
+    lastSolveStats.fixerIterationCount = lastFixerIterationCount;
+    lastSolveStats.activeBoneCount = activeSet.bones.size();
+    lastSolveStats.activeJointCount = activeSet.joints.size();
+    lastSolveStats.controlCount = controlCount;
+    lastSolveStats.islandCount = activeSet.islands.size();
+}
+
+void BEPUik::IKSolver::SetParallelThreadCount(uint32_t value)
+{
+    if (value != parallelThreadCount)
+        workerGroup = nullptr;
+    parallelThreadCount = value;
+}
+
+void BEPUik::IKSolver::PrepareJointSolve()
+{
+    if (UseIslands)
+    {
+        //The islands come with the active set; they only need the threads.
+        if (!workerGroup)
+            workerGroup = std::make_unique<WorkerGroup>(parallelThreadCount);
+        return;
+    }
+    if (UseDirectTreeSolve)
+    {
+        if (jointTreeSolverVersion != activeSet.GetVersion())
+        {
+            jointTreeSolver.Build(activeSet.joints, activeSet.boneStore);
+            jointTreeSolverVersion = activeSet.GetVersion();
+        }
+        return;
+    }
+    if (UseJacobi)
+    {
+        if (!workerGroup)
+            workerGroup = std::make_unique<WorkerGroup>(parallelThreadCount);
+        if (jointJacobiVersion != activeSet.GetVersion())
+        {
+            jointJacobi.Build(activeSet.joints, activeSet.boneStore);
+            jointJacobiVersion = activeSet.GetVersion();
+        }
+        return;
+    }
+    if (UseParallelColoring)
+    {
+        if (!workerGroup)
+            workerGroup = std::make_unique<WorkerGroup>(parallelThreadCount);
+        //The coloring and batches only depend on the active joints and their handles, so they survive as long as the active set does.
+        if (jointColoringVersion != activeSet.GetVersion())
+        {
+            jointColoring.Build(activeSet.joints, activeSet.boneStore);
+            jointColoringVersion = activeSet.GetVersion();
+        }
+        return;
+    }
+    if (!UseConstraintBatches)
+        return;
+    auto simdLevel = std::min(MaximumSimdLevel, GetSupportedSimdLevel());
+    if (jointBatchesVersion == activeSet.GetVersion() && jointBatches.IsBundled() == UseSimdBundles && (!UseSimdBundles || jointBatches.GetSimdLevel() == simdLevel))
+        return;
+    jointBatches.Build(activeSet.joints, activeSet.boneStore, UseSimdBundles, simdLevel);
+    jointBatchesVersion = activeSet.GetVersion();
+}
+
+void BEPUik::IKSolver::PreupdateJoints(float updateRate)
+{
+	for(auto *joint : activeSet.joints)
+    {
+        joint->Preupdate(GetTimeStepDuration(), updateRate);
+    }
+    if (IsBatched())
+        jointBatches.Preupdate();
+}
+
+void BEPUik::IKSolver::UpdateJoints(bool updateEffectiveMass)
+{
+    if (IsTreeSolve())
+    {
+        jointTreeSolver.UpdateJoints(updateEffectiveMass);
+        return;
+    }
+    if (IsJacobi())
+    {
+        jointJacobi.UpdateJoints(*workerGroup, updateEffectiveMass);
+        return;
+    }
+    if (UseParallelColoring)
+    {
+        jointColoring.UpdateJoints(*workerGroup, updateEffectiveMass);
+        return;
+    }
+    if (IsBatched())
+    {
+        jointBatches.UpdateJacobiansAndEffectiveMass(activeSet.boneStore, updateEffectiveMass);
+        jointBatches.WarmStart(activeSet.boneStore);
+        return;
+    }
+	for(auto *joint : activeSet.joints)
+    {
+        joint->UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint->ComputeEffectiveMass();
+        joint->WarmStart();
+    }
+}
+
+void BEPUik::IKSolver::SolveJointVelocities()
+{
+    if (IsTreeSolve())
+    {
+        jointTreeSolver.SolveVelocityIteration(permutationMapper);
+        return;
+    }
+    if (IsJacobi())
+    {
+        //The Jacobi iterations have no order to permute.
+        jointJacobi.SolveVelocityIteration(*workerGroup, JacobiRelaxation);
+        return;
+    }
+    //A permuted version of the indices is used. The randomization tends to avoid issues with solving order in corner cases.
+    if (UseParallelColoring)
+    {
+        jointColoring.SolveVelocityIteration(*workerGroup, permutationMapper);
+        return;
+    }
+    if (IsBatched())
+    {
+        jointBatches.SolveVelocityIteration(activeSet.boneStore, permutationMapper);
+        return;
+    }
+    for (int jointIndex = 0; jointIndex < activeSet.joints.size(); ++jointIndex)
+    {
+        auto remappedIndex = permutationMapper.GetMappedIndex(jointIndex, static_cast<int>(activeSet.joints.size()));
+        activeSet.joints[remappedIndex]->SolveVelocityIteration();
+    }
+}
+
+bool BEPUik::IKSolver::RestoreJointImpulses(const PersistentImpulses &persistent)
+{
+    if (!PersistAccumulatedImpulses || persistent.joints != activeSet.joints)
+        return false;
+    for (size_t i = 0; i < activeSet.joints.size(); ++i)
+    {
+        activeSet.joints[i]->accumulatedImpulse = vector3::Multiply(persistent.impulses[i], PersistentImpulseScale);
+    }
+    if (IsBatched())
+        jointBatches.LoadAccumulatedImpulses();
+    return true;
+}
+
+void BEPUik::IKSolver::EndJointPhase(PersistentImpulses &persistent)
+{
+    persistent.joints.clear();
+    persistent.impulses.clear();
+    if (PersistAccumulatedImpulses)
+    {
+        if (IsBatched())
+            jointBatches.StoreAccumulatedImpulses();
+        persistent.joints = activeSet.joints;
+        persistent.impulses.reserve(activeSet.joints.size());
+		for(auto *joint : activeSet.joints)
+        {
+            persistent.impulses.push_back(joint->accumulatedImpulse);
+        }
+    }
+    ClearJointImpulses();
+}
+
+void BEPUik::IKSolver::ClearJointImpulses()
+{
+    if (IsBatched())
+    {
+        jointBatches.ClearAccumulatedImpulses();
+    }
+    //The joints are cleared in every mode; the batches copy their impulses back into the joints when they are stored,
+    //so batched joints hold a copy that would otherwise be restored by the next solve.
+    for(auto *joint : activeSet.joints)
     {
-        control->ClearAccumulatedImpulses();
+        joint->ClearAccumulatedImpulses();
     }
 }
 
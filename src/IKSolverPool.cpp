@@ -0,0 +1,172 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/IKSolverPool.hpp"
+#include <algorithm>
+
+BEPUik::IKSolverPool::IKSolverPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    m_workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    //Worker 0 is the thread calling Solve.
+    m_threads.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i)
+        m_threads.emplace_back(&IKSolverPool::WorkerMain, this, static_cast<size_t>(i));
+}
+
+BEPUik::IKSolverPool::~IKSolverPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_startCondition.notify_all();
+	for(auto &thread : m_threads)
+        thread.join();
+}
+
+uint32_t BEPUik::IKSolverPool::GetThreadCount() const {return static_cast<uint32_t>(m_workers.size());}
+
+void BEPUik::IKSolverPool::Solve(const std::vector<IKSolveTask> &tasks)
+{
+    if (tasks.empty())
+        return;
+
+    //Deal the tasks out in contiguous chunks; stealing evens out any imbalance in solve cost.
+    auto workerCount = m_workers.size();
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        auto &worker = *m_workers[i];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto begin = tasks.size() * i / workerCount;
+        auto end = tasks.size() * (i + 1) / workerCount;
+        for (auto taskIndex = begin; taskIndex < end; ++taskIndex)
+            worker.tasks.push_back(taskIndex);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks = &tasks;
+        m_remainingTasks.store(tasks.size(), std::memory_order_relaxed);
+        m_exception = nullptr;
+        m_activeThreads = m_threads.size();
+        ++m_generation;
+    }
+    m_startCondition.notify_all();
+
+    RunTasks(0);
+
+    std::exception_ptr exception;
+    {
+        //Wait for the other threads to run out of work so that none of them still references the task list.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this]() {return m_activeThreads == 0;});
+        m_tasks = nullptr;
+        exception = m_exception;
+        m_exception = nullptr;
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+bool BEPUik::IKSolverPool::PopTask(Worker &worker, size_t &taskIndex)
+{
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty())
+        return false;
+    taskIndex = worker.tasks.front();
+    worker.tasks.pop_front();
+    return true;
+}
+
+bool BEPUik::IKSolverPool::StealTask(size_t thiefIndex, size_t &taskIndex)
+{
+    auto workerCount = m_workers.size();
+    for (size_t offset = 1; offset < workerCount; ++offset)
+    {
+        auto &victim = *m_workers[(thiefIndex + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+            continue;
+        taskIndex = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void BEPUik::IKSolverPool::RunTasks(size_t workerIndex)
+{
+    auto &worker = *m_workers[workerIndex];
+    const auto &tasks = *m_tasks;
+    size_t taskIndex;
+    while (m_remainingTasks.load(std::memory_order_acquire) > 0)
+    {
+        if (!PopTask(worker, taskIndex) && !StealTask(workerIndex, taskIndex))
+            break;
+        try
+        {
+            RunTask(worker, tasks[taskIndex]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception)
+                m_exception = std::current_exception();
+        }
+        m_remainingTasks.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void BEPUik::IKSolverPool::RunTask(Worker &worker, const IKSolveTask &task)
+{
+    struct ScratchBinding
+    {
+        ActiveSet &activeSet;
+        ~ScratchBinding() {activeSet.SetScratch(nullptr);}
+    } binding {task.solver->activeSet};
+    task.solver->activeSet.SetScratch(&worker.scratch);
+
+    if (task.controls != nullptr)
+        task.solver->Solve(*task.controls);
+    else if (task.joints != nullptr)
+        task.solver->Solve(*task.joints);
+}
+
+void BEPUik::IKSolverPool::WorkerMain(size_t workerIndex)
+{
+    uint64_t generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, generation]() {return m_shutdown || m_generation != generation;});
+            if (m_shutdown)
+                return;
+            generation = m_generation;
+        }
+
+        RunTasks(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeThreads;
+        }
+        m_doneCondition.notify_one();
+    }
+}
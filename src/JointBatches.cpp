@@ -0,0 +1,544 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/PermutationMapper.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKAngularJoint.hpp"
+#include "bepuik/joint/IKDistanceJoint.hpp"
+#include "bepuik/joint/IKPointOnLineJoint.hpp"
+#include "bepuik/joint/IKPointOnPlaneJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/joint/IKSwivelHingeJoint.hpp"
+#include "bepuik/joint/IKTwistJoint.hpp"
+#include "bepuik/limit/IKDistanceLimit.hpp"
+#include "bepuik/limit/IKEllipseSwingLimit.hpp"
+#include "bepuik/limit/IKLinearAxisLimit.hpp"
+#include "bepuik/limit/IKSwingLimit.hpp"
+#include "bepuik/limit/IKTwistLimit.hpp"
+#include "JointBundles.hpp"
+#include "JointKernels.hpp"
+#include <typeinfo>
+
+namespace BEPUik
+{
+    template<int Rows>
+        static jointkernels::JacobianRows<Rows> GetJacobianRows(const JointBatchEntry<Rows> &entry)
+    {
+        return {entry.linearJacobianA, entry.angularJacobianA, entry.linearJacobianB, entry.angularJacobianB};
+    }
+
+    //Copies the rows used by the constraint out of the full jacobians and computes the effective mass unless the previous one is reused.
+    template<int Rows>
+        static void StoreJacobians(JointBatchEntry<Rows> &entry, const JointJacobians &jacobians, const BoneStore &bones, bool updateEffectiveMass)
+    {
+        for (int i = 0; i < Rows; ++i)
+        {
+            entry.linearJacobianA[i] = jacobians.linearA[i];
+            entry.angularJacobianA[i] = jacobians.angularA[i];
+            entry.linearJacobianB[i] = jacobians.linearB[i];
+            entry.angularJacobianB[i] = jacobians.angularB[i];
+            entry.velocityBias[i] = jacobians.velocityBias[i];
+        }
+        if (updateEffectiveMass)
+            jointkernels::ComputeEffectiveMass<Rows>(GetJacobianRows(entry), bones, entry.handleA, entry.handleB, entry.softness, entry.effectiveMass);
+    }
+
+    //Evaluates the jacobians with a qualified call, so the compiler can bind (and inline) the concrete implementation instead of going through the vtable.
+    template<class TJoint, int Rows>
+        static void UpdateEntries(std::vector<JointBatchEntry<Rows>> &entries, const BoneStore &bones, bool updateEffectiveMass)
+    {
+        JointJacobians jacobians;
+        for (auto &entry : entries)
+        {
+            static_cast<const TJoint*>(entry.joint)->TJoint::ComputeJacobians(bones, entry.handleA, entry.handleB, jacobians);
+            StoreJacobians(entry, jacobians, bones, updateEffectiveMass);
+        }
+    }
+
+    template<class TJoint>
+        static void UpdateBatch(JointBatch &batch, const BoneStore &bones, bool updateEffectiveMass)
+    {
+        UpdateEntries<TJoint>(batch.entries1, bones, updateEffectiveMass);
+        UpdateEntries<TJoint>(batch.entries2, bones, updateEffectiveMass);
+        UpdateEntries<TJoint>(batch.entries3, bones, updateEffectiveMass);
+    }
+
+    template<int Rows>
+        static void WarmStartEntries(const std::vector<JointBatchEntry<Rows>> &entries, BoneStore &bones)
+    {
+		for(auto &entry : entries)
+            jointkernels::ApplyImpulse<Rows>(GetJacobianRows(entry), entry.accumulatedImpulse, bones, entry.handleA, entry.handleB);
+    }
+
+    template<int Rows, bool IsLimit>
+        static void SolveEntries(std::vector<JointBatchEntry<Rows>> &entries, BoneStore &bones, PermutationMapper &permutationMapper)
+    {
+        auto size = static_cast<int>(entries.size());
+        for (int i = 0; i < size; ++i)
+        {
+            auto &entry = entries[permutationMapper.GetMappedIndex(i, size)];
+            jointkernels::SolveVelocityIteration<Rows, IsLimit>(GetJacobianRows(entry), entry.velocityBias, entry.effectiveMass,
+                entry.softness, entry.maximumImpulse, entry.maximumImpulseSquared, entry.accumulatedImpulse, bones, entry.handleA, entry.handleB);
+        }
+    }
+
+    template<bool IsLimit>
+        static void SolveBatch(JointBatch &batch, BoneStore &bones, PermutationMapper &permutationMapper)
+    {
+        SolveEntries<1, IsLimit>(batch.entries1, bones, permutationMapper);
+        SolveEntries<2, IsLimit>(batch.entries2, bones, permutationMapper);
+        SolveEntries<3, IsLimit>(batch.entries3, bones, permutationMapper);
+    }
+
+    template<int Rows>
+        static void AddEntry(JointBatch &batch, IKJoint &joint)
+    {
+        JointBatchEntry<Rows> entry;
+        entry.joint = &joint;
+        entry.handleA = joint.m_handleA;
+        entry.handleB = joint.m_handleB;
+        for (int i = 0; i < Rows; ++i)
+            entry.accumulatedImpulse[i] = joint.accumulatedImpulse[i];
+        batch.GetEntries<Rows>().push_back(entry);
+    }
+
+    template<int Rows>
+        static void PreupdateEntries(std::vector<JointBatchEntry<Rows>> &entries)
+    {
+		for(auto &entry : entries)
+        {
+            entry.softness = entry.joint->softness;
+            entry.maximumImpulse = entry.joint->MaximumImpulse;
+            entry.maximumImpulseSquared = entry.joint->MaximumImpulseSquared;
+        }
+    }
+
+    template<int Rows>
+        static void ClearEntryImpulses(std::vector<JointBatchEntry<Rows>> &entries)
+    {
+		for(auto &entry : entries)
+        {
+            for (int i = 0; i < Rows; ++i)
+                entry.accumulatedImpulse[i] = 0.f;
+        }
+    }
+
+    template<int Rows>
+        static void StoreEntryImpulses(std::vector<JointBatchEntry<Rows>> &entries, const std::vector<JointBundle<Rows>> &bundles)
+    {
+        //Bundled joints accumulate their impulses in the bundles; bring the entries up to date first.
+		for(auto &bundle : bundles)
+        {
+            for (int lane = 0; lane < bundle.count; ++lane)
+            {
+                for (int i = 0; i < Rows; ++i)
+                    entries[bundle.entryIndex[lane]].accumulatedImpulse[i] = bundle.accumulatedImpulse[i][lane];
+            }
+        }
+		for(auto &entry : entries)
+        {
+            for (int i = 0; i < Rows; ++i)
+                entry.joint->accumulatedImpulse[i] = entry.accumulatedImpulse[i];
+        }
+    }
+
+    template<int Rows>
+        static void LoadEntryImpulses(std::vector<JointBatchEntry<Rows>> &entries, std::vector<JointBundle<Rows>> &bundles)
+    {
+		for(auto &entry : entries)
+        {
+            for (int i = 0; i < Rows; ++i)
+                entry.accumulatedImpulse[i] = entry.joint->accumulatedImpulse[i];
+        }
+		for(auto &bundle : bundles)
+        {
+            for (int lane = 0; lane < bundle.count; ++lane)
+            {
+                for (int i = 0; i < Rows; ++i)
+                    bundle.accumulatedImpulse[i][lane] = entries[bundle.entryIndex[lane]].accumulatedImpulse[i];
+            }
+        }
+    }
+
+    //Open bundles considered when placing a joint. Bounding the search keeps bundling linear in the number of joints.
+    static constexpr size_t MaximumOpenBundleSearch = 64;
+
+    template<int Rows>
+        static bool SharesIntegratedBone(const JointBundle<Rows> &bundle, BoneHandle handleA, BoneHandle handleB, size_t integratedCount)
+    {
+        //Pinned bones never receive a velocity change, so any number of lanes may reference them.
+        for (int lane = 0; lane < bundle.count; ++lane)
+        {
+            for (auto handle : {bundle.handleA[lane], bundle.handleB[lane]})
+            {
+                if (handle < integratedCount && (handle == handleA || handle == handleB))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    //Greedily colors the entries into bundles of joints that share no integrated bones.
+    template<int Rows>
+        static void BuildBundles(const std::vector<JointBatchEntry<Rows>> &entries, std::vector<JointBundle<Rows>> &bundles, size_t integratedCount)
+    {
+        bundles.clear();
+        std::vector<size_t> openBundles;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto &entry = entries[i];
+            size_t bundleIndex = bundles.size();
+            size_t searchStart = openBundles.size() > MaximumOpenBundleSearch ? openBundles.size() - MaximumOpenBundleSearch : 0;
+            for (size_t j = searchStart; j < openBundles.size(); ++j)
+            {
+                if (!SharesIntegratedBone(bundles[openBundles[j]], entry.handleA, entry.handleB, integratedCount))
+                {
+                    bundleIndex = openBundles[j];
+                    if (bundles[bundleIndex].count + 1 == JointBundleWidth)
+                        openBundles.erase(openBundles.begin() + j);
+                    break;
+                }
+            }
+            if (bundleIndex == bundles.size())
+            {
+                bundles.emplace_back();
+                openBundles.push_back(bundleIndex);
+            }
+            auto &bundle = bundles[bundleIndex];
+            auto lane = bundle.count++;
+            bundle.handleA[lane] = entry.handleA;
+            bundle.handleB[lane] = entry.handleB;
+            bundle.entryIndex[lane] = static_cast<uint32_t>(i);
+            for (int r = 0; r < Rows; ++r)
+                bundle.accumulatedImpulse[r][lane] = entry.accumulatedImpulse[r];
+        }
+        //Unused lanes still get solved by the wide kernels; point them at a valid bone. Their zero jacobians keep them inert.
+        for (auto &bundle : bundles)
+        {
+            for (int lane = bundle.count; lane < JointBundleWidth; ++lane)
+            {
+                bundle.handleA[lane] = bundle.handleA[0];
+                bundle.handleB[lane] = bundle.handleB[0];
+                bundle.entryIndex[lane] = bundle.entryIndex[0];
+            }
+        }
+    }
+
+    //Transposes the freshly computed entry state into the bundles and precomputes J * M^-1 for applying impulses.
+    template<int Rows>
+        static void PackBundles(std::vector<JointBundle<Rows>> &bundles, const std::vector<JointBatchEntry<Rows>> &entries, const BoneStore &bones)
+    {
+        for (auto &bundle : bundles)
+        {
+            for (int lane = 0; lane < bundle.count; ++lane)
+            {
+                const auto &entry = entries[bundle.entryIndex[lane]];
+                jointbundles::PackLane<Rows>(bundle, lane, GetJacobianRows(entry), entry.velocityBias, entry.effectiveMass,
+                    entry.softness, entry.maximumImpulse, entry.maximumImpulseSquared, bones, entry.handleA, entry.handleB);
+            }
+        }
+    }
+
+    template<int Rows>
+        static void WarmStartBundles(const std::vector<JointBundle<Rows>> &bundles, BoneStore &bones)
+    {
+        for (auto &bundle : bundles)
+            jointbundles::WarmStart(bundle, bones);
+    }
+
+    template<int Rows>
+        static void SolveBundles(std::vector<JointBundle<Rows>> &bundles, bool isLimit, SimdLevel simdLevel, BoneStore &bones, PermutationMapper &permutationMapper)
+    {
+        auto size = static_cast<int>(bundles.size());
+        for (int i = 0; i < size; ++i)
+            jointbundles::Solve(bundles[permutationMapper.GetMappedIndex(i, size)], isLimit, simdLevel, bones);
+    }
+
+    template<int Rows>
+        static void ClearBundleImpulses(std::vector<JointBundle<Rows>> &bundles)
+    {
+		for(auto &bundle : bundles)
+        {
+            for (int i = 0; i < Rows; ++i)
+            {
+                for (int lane = 0; lane < JointBundleWidth; ++lane)
+                    bundle.accumulatedImpulse[i][lane] = 0.f;
+            }
+        }
+    }
+
+    static bool IsLimitType(JointType type)
+    {
+        switch (type)
+        {
+        case JointType::DistanceLimit:
+        case JointType::EllipseSwingLimit:
+        case JointType::LinearAxisLimit:
+        case JointType::SwingLimit:
+        case JointType::TwistLimit:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+BEPUik::JointType BEPUik::JointBatches::Classify(const IKJoint &joint)
+{
+    //Only exact type matches are batched; subclasses may override the jacobians, so they have to go through the virtual interface.
+    const auto &type = typeid(joint);
+    if (type == typeid(IKBallSocketJoint))
+        return JointType::BallSocket;
+    if (type == typeid(IKAngularJoint))
+        return JointType::Angular;
+    if (type == typeid(IKDistanceJoint))
+        return JointType::Distance;
+    if (type == typeid(IKPointOnLineJoint))
+        return JointType::PointOnLine;
+    if (type == typeid(IKPointOnPlaneJoint))
+        return JointType::PointOnPlane;
+    if (type == typeid(IKRevoluteJoint))
+        return JointType::Revolute;
+    if (type == typeid(IKSwivelHingeJoint))
+        return JointType::SwivelHinge;
+    if (type == typeid(IKTwistJoint))
+        return JointType::Twist;
+    if (type == typeid(IKDistanceLimit))
+        return JointType::DistanceLimit;
+    if (type == typeid(IKEllipseSwingLimit))
+        return JointType::EllipseSwingLimit;
+    if (type == typeid(IKLinearAxisLimit))
+        return JointType::LinearAxisLimit;
+    if (type == typeid(IKSwingLimit))
+        return JointType::SwingLimit;
+    if (type == typeid(IKTwistLimit))
+        return JointType::TwistLimit;
+    return JointType::Custom;
+}
+
+void BEPUik::JointBatches::Build(const std::vector<IKJoint*> &joints, const BoneStore &bones, bool bundle, SimdLevel simdLevel)
+{
+    Clear();
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        batches[i].type = static_cast<JointType>(i);
+        batches[i].isLimit = IsLimitType(batches[i].type);
+    }
+	for(auto *joint : joints)
+    {
+        auto type = Classify(*joint);
+        //The kernels can't know how a custom joint clamps its impulse or whether it overrides the solve, so it stays on its virtual interface.
+        if (type == JointType::Custom)
+        {
+            customJoints.push_back(joint);
+            continue;
+        }
+        auto &batch = batches[static_cast<size_t>(type)];
+        switch (joint->GetDegreesOfFreedom())
+        {
+        case 1:
+            AddEntry<1>(batch, *joint);
+            break;
+        case 2:
+            AddEntry<2>(batch, *joint);
+            break;
+        default:
+            AddEntry<3>(batch, *joint);
+            break;
+        }
+    }
+    count = joints.size();
+
+    bundled = bundle;
+    this->simdLevel = simdLevel;
+    if (bundled)
+    {
+		for(auto &batch : batches)
+        {
+            BuildBundles(batch.entries1, batch.bundles1, bones.GetIntegratedCount());
+            BuildBundles(batch.entries2, batch.bundles2, bones.GetIntegratedCount());
+            BuildBundles(batch.entries3, batch.bundles3, bones.GetIntegratedCount());
+        }
+    }
+}
+
+void BEPUik::JointBatches::Clear()
+{
+	for(auto &batch : batches)
+    {
+        batch.entries1.clear();
+        batch.entries2.clear();
+        batch.entries3.clear();
+        batch.bundles1.clear();
+        batch.bundles2.clear();
+        batch.bundles3.clear();
+    }
+    customJoints.clear();
+    count = 0;
+    bundled = false;
+}
+
+size_t BEPUik::JointBatches::GetCount() const {return count;}
+bool BEPUik::JointBatches::IsBundled() const {return bundled;}
+BEPUik::SimdLevel BEPUik::JointBatches::GetSimdLevel() const {return simdLevel;}
+const std::array<BEPUik::JointBatch, static_cast<size_t>(BEPUik::JointType::Count)> &BEPUik::JointBatches::GetBatches() const {return batches;}
+
+void BEPUik::JointBatches::Preupdate()
+{
+	for(auto &batch : batches)
+    {
+        PreupdateEntries(batch.entries1);
+        PreupdateEntries(batch.entries2);
+        PreupdateEntries(batch.entries3);
+    }
+}
+
+void BEPUik::JointBatches::UpdateJacobiansAndEffectiveMass(const BoneStore &bones, bool updateEffectiveMass)
+{
+	for(auto &batch : batches)
+    {
+        if (batch.GetCount() == 0)
+            continue;
+        switch (batch.type)
+        {
+        case JointType::BallSocket:
+            UpdateBatch<IKBallSocketJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::Angular:
+            UpdateBatch<IKAngularJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::Distance:
+            UpdateBatch<IKDistanceJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::PointOnLine:
+            UpdateBatch<IKPointOnLineJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::PointOnPlane:
+            UpdateBatch<IKPointOnPlaneJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::Revolute:
+            UpdateBatch<IKRevoluteJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::SwivelHinge:
+            UpdateBatch<IKSwivelHingeJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::Twist:
+            UpdateBatch<IKTwistJoint>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::DistanceLimit:
+            UpdateBatch<IKDistanceLimit>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::EllipseSwingLimit:
+            UpdateBatch<IKEllipseSwingLimit>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::LinearAxisLimit:
+            UpdateBatch<IKLinearAxisLimit>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::SwingLimit:
+            UpdateBatch<IKSwingLimit>(batch, bones, updateEffectiveMass);
+            break;
+        case JointType::TwistLimit:
+            UpdateBatch<IKTwistLimit>(batch, bones, updateEffectiveMass);
+            break;
+        default:
+            //The custom batch is always empty.
+            break;
+        }
+        if (bundled)
+        {
+            PackBundles(batch.bundles1, batch.entries1, bones);
+            PackBundles(batch.bundles2, batch.entries2, bones);
+            PackBundles(batch.bundles3, batch.entries3, bones);
+        }
+    }	for(auto *joint : customJoints)
+    {
+        joint->UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint->ComputeEffectiveMass();
+    }
+}
+
+void BEPUik::JointBatches::WarmStart(BoneStore &bones)
+{
+	for(auto &batch : batches)
+    {
+        if (bundled)
+        {
+            WarmStartBundles(batch.bundles1, bones);
+            WarmStartBundles(batch.bundles2, bones);
+            WarmStartBundles(batch.bundles3, bones);
+            continue;
+        }
+        WarmStartEntries(batch.entries1, bones);
+        WarmStartEntries(batch.entries2, bones);
+        WarmStartEntries(batch.entries3, bones);
+    }	for(auto *joint : customJoints)
+        joint->WarmStart();
+}
+
+void BEPUik::JointBatches::SolveVelocityIteration(BoneStore &bones, PermutationMapper &permutationMapper)
+{
+	for(auto &batch : batches)
+    {
+        if (bundled)
+        {
+            SolveBundles(batch.bundles1, batch.isLimit, simdLevel, bones, permutationMapper);
+            SolveBundles(batch.bundles2, batch.isLimit, simdLevel, bones, permutationMapper);
+            SolveBundles(batch.bundles3, batch.isLimit, simdLevel, bones, permutationMapper);
+            continue;
+        }
+        if (batch.isLimit)
+            SolveBatch<true>(batch, bones, permutationMapper);
+        else
+            SolveBatch<false>(batch, bones, permutationMapper);
+    }    auto customCount = static_cast<int>(customJoints.size());
+    for (int i = 0; i < customCount; ++i)
+        customJoints[permutationMapper.GetMappedIndex(i, customCount)]->SolveVelocityIteration();
+}
+
+void BEPUik::JointBatches::ClearAccumulatedImpulses()
+{
+	for(auto &batch : batches)
+    {
+        ClearEntryImpulses(batch.entries1);
+        ClearEntryImpulses(batch.entries2);
+        ClearEntryImpulses(batch.entries3);
+        ClearBundleImpulses(batch.bundles1);
+        ClearBundleImpulses(batch.bundles2);
+        ClearBundleImpulses(batch.bundles3);
+    }	for(auto *joint : customJoints)
+        joint->ClearAccumulatedImpulses();
+}
+
+void BEPUik::JointBatches::StoreAccumulatedImpulses()
+{
+	for(auto &batch : batches)
+    {
+        StoreEntryImpulses(batch.entries1, batch.bundles1);
+        StoreEntryImpulses(batch.entries2, batch.bundles2);
+        StoreEntryImpulses(batch.entries3, batch.bundles3);
+    }
+}
+
+void BEPUik::JointBatches::LoadAccumulatedImpulses()
+{
+	for(auto &batch : batches)
+    {
+        LoadEntryImpulses(batch.entries1, batch.bundles1);
+        LoadEntryImpulses(batch.entries2, batch.bundles2);
+        LoadEntryImpulses(batch.entries3, batch.bundles3);
+    }
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/JointBatches.hpp"
+#include "JointKernels.hpp"
+#include "simd/JointBundleKernels.hpp"
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Steps of the bundled solver operating on a single JointBundle.
+    /// Shared by the joint batches, which bundle independent joints of one rig, and the instance lanes, which bundle the same joint of several rig instances.
+    /// </summary>
+	namespace jointbundles
+	{
+        /// <summary>
+        /// Transposes the state of one constraint into a lane of a bundle and precomputes J * M^-1 for applying impulses.
+        /// </summary>
+        template<int Rows>
+            inline void PackLane(JointBundle<Rows> &bundle, int lane, const jointkernels::JacobianRows<Rows> &jacobians, const float (&velocityBias)[Rows], const float (&effectiveMass)[Rows][Rows],
+                float softness, float maximumImpulse, float maximumImpulseSquared, const BoneStore &bones, BoneHandle handleA, BoneHandle handleB)
+        {
+            float inverseMassA = bones.inverseMasses[handleA];
+            float inverseMassB = bones.inverseMasses[handleB];
+            for (int i = 0; i < Rows; ++i)
+            {
+                Vector3 angularVelocityChangeA = bones.TransformByInertiaTensorInverse(handleA, jacobians.angularA[i]);
+                Vector3 angularVelocityChangeB = bones.TransformByInertiaTensorInverse(handleB, jacobians.angularB[i]);
+                for (int k = 0; k < 3; ++k)
+                {
+                    bundle.linearJacobianA[i][k][lane] = jacobians.linearA[i][k];
+                    bundle.angularJacobianA[i][k][lane] = jacobians.angularA[i][k];
+                    bundle.linearJacobianB[i][k][lane] = jacobians.linearB[i][k];
+                    bundle.angularJacobianB[i][k][lane] = jacobians.angularB[i][k];
+                    bundle.linearVelocityChangeA[i][k][lane] = jacobians.linearA[i][k] * inverseMassA;
+                    bundle.angularVelocityChangeA[i][k][lane] = angularVelocityChangeA[k];
+                    bundle.linearVelocityChangeB[i][k][lane] = jacobians.linearB[i][k] * inverseMassB;
+                    bundle.angularVelocityChangeB[i][k][lane] = angularVelocityChangeB[k];
+                }
+                bundle.velocityBias[i][lane] = velocityBias[i];
+                for (int j = 0; j < Rows; ++j)
+                    bundle.effectiveMass[i][j][lane] = effectiveMass[i][j];
+            }
+            bundle.softness[lane] = softness;
+            bundle.maximumImpulse[lane] = maximumImpulse;
+            bundle.maximumImpulseSquared[lane] = maximumImpulseSquared;
+        }
+
+        /// <summary>
+        /// Applies the accumulated impulses of the used lanes of a bundle.
+        /// </summary>
+        template<int Rows>
+            inline void WarmStart(const JointBundle<Rows> &bundle, BoneStore &bones)
+        {
+            for (int lane = 0; lane < bundle.count; ++lane)
+            {
+                Vector3 linearA = vector3::Create(), angularA = vector3::Create(), linearB = vector3::Create(), angularB = vector3::Create();
+                for (int i = 0; i < Rows; ++i)
+                {
+                    float impulse = bundle.accumulatedImpulse[i][lane];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        linearA[k] += bundle.linearVelocityChangeA[i][k][lane] * impulse;
+                        angularA[k] += bundle.angularVelocityChangeA[i][k][lane] * impulse;
+                        linearB[k] += bundle.linearVelocityChangeB[i][k][lane] * impulse;
+                        angularB[k] += bundle.angularVelocityChangeB[i][k][lane] * impulse;
+                    }
+                }
+                auto handleA = bundle.handleA[lane];
+                auto handleB = bundle.handleB[lane];
+                bones.linearVelocities[handleA] = vector3::Add(bones.linearVelocities[handleA], linearA);
+                bones.angularVelocities[handleA] = vector3::Add(bones.angularVelocities[handleA], angularA);
+                bones.linearVelocities[handleB] = vector3::Add(bones.linearVelocities[handleB], linearB);
+                bones.angularVelocities[handleB] = vector3::Add(bones.angularVelocities[handleB], angularB);
+            }
+        }
+
+        /// <summary>
+        /// Gathers the bone velocities of a bundle, solves one velocity iteration with the given instruction set and scatters the velocity changes.
+        /// </summary>
+        template<int Rows>
+            inline void Solve(JointBundle<Rows> &bundle, bool isLimit, SimdLevel simdLevel, BoneStore &bones)
+        {
+            alignas(32) bundlekernels::BundleVelocities velocities;
+            for (int lane = 0; lane < JointBundleWidth; ++lane)
+            {
+                const auto &linearVelocityA = bones.linearVelocities[bundle.handleA[lane]];
+                const auto &angularVelocityA = bones.angularVelocities[bundle.handleA[lane]];
+                const auto &linearVelocityB = bones.linearVelocities[bundle.handleB[lane]];
+                const auto &angularVelocityB = bones.angularVelocities[bundle.handleB[lane]];
+                for (int k = 0; k < 3; ++k)
+                {
+                    velocities[k][lane] = linearVelocityA[k];
+                    velocities[3 + k][lane] = angularVelocityA[k];
+                    velocities[6 + k][lane] = linearVelocityB[k];
+                    velocities[9 + k][lane] = angularVelocityB[k];
+                }
+            }
+            switch (simdLevel)
+            {
+            case SimdLevel::AVX2:
+                bundlekernels::avx2::Solve(bundle, velocities, isLimit);
+                break;
+            case SimdLevel::SSE:
+                bundlekernels::sse::Solve(bundle, velocities, isLimit);
+                break;
+            default:
+                bundlekernels::scalar::Solve(bundle, velocities, isLimit);
+                break;
+            }
+            //Lanes never share an integrated bone, so the velocity changes can be applied in any order.
+            for (int lane = 0; lane < bundle.count; ++lane)
+            {
+                auto &linearVelocityA = bones.linearVelocities[bundle.handleA[lane]];
+                auto &angularVelocityA = bones.angularVelocities[bundle.handleA[lane]];
+                auto &linearVelocityB = bones.linearVelocities[bundle.handleB[lane]];
+                auto &angularVelocityB = bones.angularVelocities[bundle.handleB[lane]];
+                for (int k = 0; k < 3; ++k)
+                {
+                    linearVelocityA[k] += velocities[k][lane];
+                    angularVelocityA[k] += velocities[3 + k][lane];
+                    linearVelocityB[k] += velocities[6 + k][lane];
+                    angularVelocityB[k] += velocities[9 + k][lane];
+                }
+            }
+        }
+	}
+}
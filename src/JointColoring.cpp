@@ -0,0 +1,127 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/JointColoring.hpp"
+#include "bepuik/WorkerGroup.hpp"
+#include "bepuik/PermutationMapper.hpp"
+#include <algorithm>
+
+void BEPUik::JointColoring::Build(const std::vector<IKJoint*> &joints, const BoneStore &bones)
+{
+    Clear();
+    m_boneColors.resize(bones.GetIntegratedCount());
+	for(auto &colors : m_boneColors)
+        colors.clear();
+
+    //Pick the lowest color not yet used by either integrated bone.
+    std::vector<uint32_t> jointColors;
+    jointColors.reserve(joints.size());
+    std::vector<size_t> colorSizes;
+	for(auto *joint : joints)
+    {
+        uint32_t color = 0;
+        auto isUsed = [this, &bones](BoneHandle handle, uint32_t color) {
+            if (!bones.IsIntegrated(handle))
+                return false;
+            const auto &colors = m_boneColors[handle];
+            return std::find(colors.begin(), colors.end(), color) != colors.end();
+        };
+        while (isUsed(joint->m_handleA, color) || isUsed(joint->m_handleB, color))
+            ++color;
+        if (bones.IsIntegrated(joint->m_handleA))
+            m_boneColors[joint->m_handleA].push_back(color);
+        if (bones.IsIntegrated(joint->m_handleB))
+            m_boneColors[joint->m_handleB].push_back(color);
+        jointColors.push_back(color);
+        if (color >= colorSizes.size())
+            colorSizes.resize(color + 1, 0);
+        ++colorSizes[color];
+    }
+
+    //Counting sort by color, keeping the active set order within each color.
+    m_colorStarts.resize(colorSizes.size() + 1);
+    m_colorStarts[0] = 0;
+    for (size_t i = 0; i < colorSizes.size(); ++i)
+        m_colorStarts[i + 1] = m_colorStarts[i] + colorSizes[i];
+    m_joints.resize(joints.size());
+    std::vector<size_t> offsets(m_colorStarts.begin(), m_colorStarts.end() - 1);
+    for (size_t i = 0; i < joints.size(); ++i)
+        m_joints[offsets[jointColors[i]]++] = joints[i];
+}
+
+void BEPUik::JointColoring::Clear()
+{
+    m_joints.clear();
+    m_colorStarts.clear();
+}
+
+size_t BEPUik::JointColoring::GetColorCount() const {return m_colorStarts.empty() ? 0 : m_colorStarts.size() - 1;}
+
+BEPUik::IKJoint *const *BEPUik::JointColoring::GetColor(size_t color, size_t &count) const
+{
+    count = m_colorStarts[color + 1] - m_colorStarts[color];
+    return m_joints.data() + m_colorStarts[color];
+}
+
+template<class TFunc>
+    void BEPUik::JointColoring::ForEachInColor(WorkerGroup &workers, size_t color, const TFunc &func)
+{
+    size_t count;
+    auto *joints = GetColor(color, count);
+    if (count < MinimumParallelJoints)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(*joints[i]);
+        return;
+    }
+    workers.ParallelFor(count, [joints, &func](size_t begin, size_t end, uint32_t) {
+        for (auto i = begin; i < end; ++i)
+            func(*joints[i]);
+    });
+}
+
+void BEPUik::JointColoring::UpdateJoints(WorkerGroup &workers, bool updateEffectiveMass)
+{
+    //Computing the jacobians and effective mass only writes to the joint itself, so every joint can run concurrently.
+    auto update = [updateEffectiveMass](IKJoint &joint) {
+        joint.UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint.ComputeEffectiveMass();
+    };
+    if (m_joints.size() < MinimumParallelJoints)
+    {
+		for(auto *joint : m_joints)
+            update(*joint);
+    }
+    else
+    {
+        workers.ParallelFor(m_joints.size(), [this, &update](size_t begin, size_t end, uint32_t) {
+            for (auto i = begin; i < end; ++i)
+                update(*m_joints[i]);
+        });
+    }
+    for (size_t color = 0; color < GetColorCount(); ++color)
+        ForEachInColor(workers, color, [](IKJoint &joint) {joint.WarmStart();});
+}
+
+void BEPUik::JointColoring::SolveVelocityIteration(WorkerGroup &workers, PermutationMapper &permutationMapper)
+{
+    auto colorCount = static_cast<int>(GetColorCount());
+    for (int i = 0; i < colorCount; ++i)
+    {
+        auto color = static_cast<size_t>(permutationMapper.GetMappedIndex(i, colorCount));
+        ForEachInColor(workers, color, [](IKJoint &joint) {joint.SolveVelocityIteration();});
+    }
+}
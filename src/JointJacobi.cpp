@@ -0,0 +1,174 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/JointJacobi.hpp"
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/WorkerGroup.hpp"
+#include "bepuik/limit/IKLimit.hpp"
+#include "JointKernels.hpp"
+
+namespace BEPUik
+{
+    static void StoreImpulses(const jointkernels::WorldImpulses &impulses, Vector3 *target)
+    {
+        target[0] = impulses.linearA;
+        target[1] = impulses.angularA;
+        target[2] = impulses.linearB;
+        target[3] = impulses.angularB;
+    }
+
+    template<bool IsLimit>
+        static void ComputeVelocityImpulses(IKJoint &joint, float relaxation, jointkernels::WorldImpulses &impulses)
+    {
+        if (joint.m_degreesOfFreedom == 1)
+            jointkernels::ComputeJointVelocityImpulses<1, IsLimit>(joint, relaxation, impulses);
+        else if (joint.m_degreesOfFreedom == 2)
+            jointkernels::ComputeJointVelocityImpulses<2, IsLimit>(joint, relaxation, impulses);
+        else
+            jointkernels::ComputeJointVelocityImpulses<3, IsLimit>(joint, relaxation, impulses);
+    }
+}
+
+void BEPUik::JointJacobi::Build(const std::vector<IKJoint*> &joints, BoneStore &bones)
+{
+    Clear();
+    m_bones = &bones;
+    //The kernels only know how the built-in joints clamp their impulses, and custom joints may override the solve itself.
+	for(auto *joint : joints)
+    {
+        if (JointBatches::Classify(*joint) == JointType::Custom)
+            m_customJoints.push_back(joint);
+        else
+            m_joints.push_back(joint);
+    }
+    m_isLimit.reserve(m_joints.size());
+	for(auto *joint : m_joints)
+        m_isLimit.push_back(dynamic_cast<IKLimit*>(joint) != nullptr);
+    m_impulses.resize(m_joints.size() * 4);
+
+    //Counting sort of the joint ends by bone; border bones never receive impulses, so they are left out.
+    m_boneStarts.assign(bones.GetIntegratedCount() + 1, 0);
+	for(auto *joint : m_joints)
+    {
+        for (auto handle : {joint->m_handleA, joint->m_handleB})
+        {
+            if (bones.IsIntegrated(handle))
+                ++m_boneStarts[handle + 1];
+        }
+    }
+    for (size_t i = 1; i < m_boneStarts.size(); ++i)
+        m_boneStarts[i] += m_boneStarts[i - 1];
+    m_boneImpulses.resize(m_boneStarts.back());
+    std::vector<uint32_t> offsets(m_boneStarts.begin(), m_boneStarts.end() - 1);
+    for (size_t i = 0; i < m_joints.size(); ++i)
+    {
+        auto index = static_cast<uint32_t>(i * 4);
+        if (bones.IsIntegrated(m_joints[i]->m_handleA))
+            m_boneImpulses[offsets[m_joints[i]->m_handleA]++] = index;
+        if (bones.IsIntegrated(m_joints[i]->m_handleB))
+            m_boneImpulses[offsets[m_joints[i]->m_handleB]++] = index + 2;
+    }
+}
+
+void BEPUik::JointJacobi::Clear()
+{
+    m_bones = nullptr;
+    m_joints.clear();
+    m_customJoints.clear();
+    m_isLimit.clear();
+    m_impulses.clear();
+    m_boneStarts.clear();
+    m_boneImpulses.clear();
+}
+
+template<class TFunc>
+    void BEPUik::JointJacobi::ParallelFor(WorkerGroup &workers, size_t count, const TFunc &func)
+{
+    if (count < MinimumParallelJoints)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+    workers.ParallelFor(count, [&func](size_t begin, size_t end, uint32_t) {
+        for (auto i = begin; i < end; ++i)
+            func(i);
+    });
+}
+
+void BEPUik::JointJacobi::ApplyImpulses(WorkerGroup &workers)
+{
+    //Each bone sums the impulses of its joints in a fixed order, so the result is the same for any thread count.
+    ParallelFor(workers, m_boneStarts.size() - 1, [this](size_t bone) {
+        auto begin = m_boneStarts[bone];
+        auto end = m_boneStarts[bone + 1];
+        if (begin == end)
+            return;
+        Vector3 linearImpulse = m_impulses[m_boneImpulses[begin]];
+        Vector3 angularImpulse = m_impulses[m_boneImpulses[begin] + 1];
+        for (auto i = begin + 1; i < end; ++i)
+        {
+            linearImpulse = vector3::Add(linearImpulse, m_impulses[m_boneImpulses[i]]);
+            angularImpulse = vector3::Add(angularImpulse, m_impulses[m_boneImpulses[i] + 1]);
+        }
+        auto handle = static_cast<BoneHandle>(bone);
+        m_bones->ApplyLinearImpulse(handle, linearImpulse);
+        m_bones->ApplyAngularImpulse(handle, angularImpulse);
+    });
+}
+
+void BEPUik::JointJacobi::UpdateJoints(WorkerGroup &workers, bool updateEffectiveMass)
+{
+    //The warm start impulses are gathered like those of the velocity iterations.
+    ParallelFor(workers, m_joints.size(), [this, updateEffectiveMass](size_t i) {
+        auto &joint = *m_joints[i];
+        joint.UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint.ComputeEffectiveMass();
+        jointkernels::WorldImpulses impulses;
+        if (joint.m_degreesOfFreedom == 1)
+            jointkernels::ComputeJointWarmStartImpulses<1>(joint, impulses);
+        else if (joint.m_degreesOfFreedom == 2)
+            jointkernels::ComputeJointWarmStartImpulses<2>(joint, impulses);
+        else
+            jointkernels::ComputeJointWarmStartImpulses<3>(joint, impulses);
+        StoreImpulses(impulses, &m_impulses[i * 4]);
+    });
+    ApplyImpulses(workers);
+	for(auto *joint : m_customJoints)
+    {
+        joint->UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint->ComputeEffectiveMass();
+        joint->WarmStart();
+    }
+}
+
+void BEPUik::JointJacobi::SolveVelocityIteration(WorkerGroup &workers, float relaxation)
+{
+    //The joints only read the bone velocities here; nothing is applied until every joint has computed its impulse.
+    ParallelFor(workers, m_joints.size(), [this, relaxation](size_t i) {
+        auto &joint = *m_joints[i];
+        jointkernels::WorldImpulses impulses;
+        if (m_isLimit[i])
+            ComputeVelocityImpulses<true>(joint, relaxation, impulses);
+        else
+            ComputeVelocityImpulses<false>(joint, relaxation, impulses);
+        StoreImpulses(impulses, &m_impulses[i * 4]);
+    });
+    ApplyImpulses(workers);    //Custom joints follow with a sequential Gauss-Seidel pass through their own interface.
+	for(auto *joint : m_customJoints)
+        joint->SolveVelocityIteration();
+}
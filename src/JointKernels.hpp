@@ -0,0 +1,332 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/math.hpp"
+#include "bepuik/BoneStore.hpp"
+#include "bepuik/joint/IKJoint.hpp"
+#include <cmath>
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Solver kernels for two bone constraints sized by the constraint's degrees of freedom.
+    /// The jacobians of an N-DOF constraint are given as N rows per bone; rows beyond N are never touched.
+    /// The effective mass is a row-major NxN matrix; 1x1 and 2x2 masses are inverted directly.
+    /// </summary>
+	namespace jointkernels
+	{
+        template<int Rows>
+            struct JacobianRows
+        {
+            const Vector3 *linearA;
+            const Vector3 *angularA;
+            const Vector3 *linearB;
+            const Vector3 *angularB;
+        };
+
+        /// <summary>
+        /// Inverts the NxN effective mass denominator in place, matching the submatrix fallbacks of matrix::AdaptiveInvert.
+        /// </summary>
+        template<int Rows>
+            inline void InvertEffectiveMass(float (&effectiveMass)[Rows][Rows])
+        {
+            if constexpr (Rows == 1)
+            {
+                effectiveMass[0][0] = effectiveMass[0][0] != 0 ? 1 / effectiveMass[0][0] : 0.f;
+            }
+            else if constexpr (Rows == 2)
+            {
+                float m11 = effectiveMass[0][0];
+                float m12 = effectiveMass[0][1];
+                float m21 = effectiveMass[1][0];
+                float m22 = effectiveMass[1][1];
+                float determinant = m11 * m22 - m12 * m21;
+                if (determinant != 0)
+                {
+                    float determinantInverse = 1 / determinant;
+                    effectiveMass[0][0] = m22 * determinantInverse;
+                    effectiveMass[0][1] = -m12 * determinantInverse;
+                    effectiveMass[1][0] = -m21 * determinantInverse;
+                    effectiveMass[1][1] = m11 * determinantInverse;
+                }
+                else
+                {
+                    //Singular; fall back to whichever diagonal element can be inverted, like the adaptive inverse does.
+                    effectiveMass[0][1] = 0;
+                    effectiveMass[1][0] = 0;
+                    if (m11 != 0)
+                    {
+                        effectiveMass[0][0] = 1 / m11;
+                        effectiveMass[1][1] = 0;
+                    }
+                    else
+                    {
+                        effectiveMass[0][0] = 0;
+                        effectiveMass[1][1] = m22 != 0 ? 1 / m22 : 0.f;
+                    }
+                }
+            }
+            else
+            {
+                static_assert(Rows == 3, "Constraints have at most three degrees of freedom.");
+                Matrix3x3 matrix;
+                for (int i = 0; i < 3; ++i)
+                {
+                    for (int j = 0; j < 3; ++j)
+                        matrix[i][j] = effectiveMass[i][j];
+                }
+                matrix = matrix::AdaptiveInvert(matrix);
+                for (int i = 0; i < 3; ++i)
+                {
+                    for (int j = 0; j < 3; ++j)
+                        effectiveMass[i][j] = matrix[i][j];
+                }
+            }
+        }
+
+        /// <summary>
+        /// Computes the effective mass 1 / (J * M^-1 * JT) of an N-DOF constraint.
+        /// </summary>
+        template<int Rows>
+            inline void ComputeEffectiveMass(const JacobianRows<Rows> &jacobians, const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, float softness, float (&effectiveMass)[Rows][Rows])
+        {
+            float inverseMassA = bones.inverseMasses[handleA];
+            float inverseMassB = bones.inverseMasses[handleB];
+            //J * M^-1 for the angular components; the linear components are just scaled by the inverse mass.
+            //The inverse inertia tensors are symmetric, so transforming the jacobian rows gives the rows of J * I^-1.
+            Vector3 angularWA[Rows], angularWB[Rows];
+            for (int i = 0; i < Rows; ++i)
+            {
+                angularWA[i] = bones.TransformByInertiaTensorInverse(handleA, jacobians.angularA[i]);
+                angularWB[i] = bones.TransformByInertiaTensorInverse(handleB, jacobians.angularB[i]);
+            }
+            for (int i = 0; i < Rows; ++i)
+            {
+                for (int j = i; j < Rows; ++j)
+                {
+                    float value = inverseMassA * vector3::Dot(jacobians.linearA[i], jacobians.linearA[j]) +
+                        vector3::Dot(angularWA[i], jacobians.angularA[j]) +
+                        inverseMassB * vector3::Dot(jacobians.linearB[i], jacobians.linearB[j]) +
+                        vector3::Dot(angularWB[i], jacobians.angularB[j]);
+                    effectiveMass[i][j] = value;
+                    effectiveMass[j][i] = value;
+                }
+                //Incorporate the constraint softness into the effective mass denominator.
+                if (effectiveMass[i][i] != 0)
+                    effectiveMass[i][i] += softness;
+            }
+            InvertEffectiveMass<Rows>(effectiveMass);
+        }
+
+        /// <summary>
+        /// World space impulses of a two bone constraint on each of its bones.
+        /// </summary>
+        struct WorldImpulses
+        {
+            Vector3 linearA;
+            Vector3 angularA;
+            Vector3 linearB;
+            Vector3 angularB;
+        };
+
+        /// <summary>
+        /// Transforms a constraint space impulse into world space using the transposed jacobian.
+        /// </summary>
+        template<int Rows>
+            inline void ComputeWorldImpulses(const JacobianRows<Rows> &jacobians, const float (&constraintSpaceImpulse)[Rows], WorldImpulses &impulses)
+        {
+            impulses.linearA = vector3::Multiply(jacobians.linearA[0], constraintSpaceImpulse[0]);
+            impulses.angularA = vector3::Multiply(jacobians.angularA[0], constraintSpaceImpulse[0]);
+            impulses.linearB = vector3::Multiply(jacobians.linearB[0], constraintSpaceImpulse[0]);
+            impulses.angularB = vector3::Multiply(jacobians.angularB[0], constraintSpaceImpulse[0]);
+            for (int i = 1; i < Rows; ++i)
+            {
+                impulses.linearA = vector3::Add(impulses.linearA, vector3::Multiply(jacobians.linearA[i], constraintSpaceImpulse[i]));
+                impulses.angularA = vector3::Add(impulses.angularA, vector3::Multiply(jacobians.angularA[i], constraintSpaceImpulse[i]));
+                impulses.linearB = vector3::Add(impulses.linearB, vector3::Multiply(jacobians.linearB[i], constraintSpaceImpulse[i]));
+                impulses.angularB = vector3::Add(impulses.angularB, vector3::Multiply(jacobians.angularB[i], constraintSpaceImpulse[i]));
+            }
+        }
+
+        /// <summary>
+        /// Transforms a constraint space impulse into world space using the transposed jacobian and applies it to both bones.
+        /// Impulses on pinned border bones are discarded by the store.
+        /// </summary>
+        template<int Rows>
+            inline void ApplyImpulse(const JacobianRows<Rows> &jacobians, const float (&constraintSpaceImpulse)[Rows], BoneStore &bones, BoneHandle handleA, BoneHandle handleB)
+        {
+            WorldImpulses impulses;
+            ComputeWorldImpulses<Rows>(jacobians, constraintSpaceImpulse, impulses);
+            bones.ApplyLinearImpulse(handleA, impulses.linearA);
+            bones.ApplyAngularImpulse(handleA, impulses.angularA);
+            bones.ApplyLinearImpulse(handleB, impulses.linearB);
+            bones.ApplyAngularImpulse(handleB, impulses.angularB);
+        }
+
+        /// <summary>
+        /// Computes the impulse that satisfies the velocity constraint of an N-DOF constraint for the current bone velocities and adds it to the accumulated impulse.
+        /// The new impulse is scaled by the relaxation factor before it is accumulated. Limits can only apply positive impulses.
+        /// </summary>
+        /// <param name="constraintSpaceImpulse">Receives the change of the accumulated impulse, which is yet to be applied to the bones.</param>
+        template<int Rows, bool IsLimit>
+            inline void ComputeVelocityImpulse(const JacobianRows<Rows> &jacobians, const float (&velocityBias)[Rows], const float (&effectiveMass)[Rows][Rows],
+                float softness, float maximumImpulse, float maximumImpulseSquared, float relaxation, float (&accumulatedImpulse)[Rows],
+                const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, float (&constraintSpaceImpulse)[Rows])
+        {
+            const auto &linearVelocityA = bones.linearVelocities[handleA];
+            const auto &angularVelocityA = bones.angularVelocities[handleA];
+            const auto &linearVelocityB = bones.linearVelocities[handleB];
+            const auto &angularVelocityB = bones.angularVelocities[handleB];
+
+            //The constraint velocity error, less the position correction and softness biases, is the velocity we try to remove.
+            float constraintVelocityError[Rows];
+            for (int i = 0; i < Rows; ++i)
+            {
+                constraintVelocityError[i] = vector3::Dot(linearVelocityA, jacobians.linearA[i]) + vector3::Dot(angularVelocityA, jacobians.angularA[i]) +
+                    vector3::Dot(linearVelocityB, jacobians.linearB[i]) + vector3::Dot(angularVelocityB, jacobians.angularB[i]) -
+                    velocityBias[i] + accumulatedImpulse[i] * softness;
+            }
+
+            float preadd[Rows];
+            float impulseSquared = 0;
+            for (int i = 0; i < Rows; ++i)
+            {
+                float impulse = 0;
+                for (int j = 0; j < Rows; ++j)
+                    impulse -= constraintVelocityError[j] * effectiveMass[j][i];
+                preadd[i] = accumulatedImpulse[i];
+                accumulatedImpulse[i] += relaxation * impulse;
+                if constexpr (IsLimit)
+                    accumulatedImpulse[i] = std::max(0.f, accumulatedImpulse[i]);
+                impulseSquared += accumulatedImpulse[i] * accumulatedImpulse[i];
+            }
+            //The accumulated impulse may exceed this constraint's capacity; clamp it down.
+            if (impulseSquared > maximumImpulseSquared)
+            {
+                float scale = maximumImpulse / (float)std::sqrt(impulseSquared);
+                for (int i = 0; i < Rows; ++i)
+                    accumulatedImpulse[i] *= scale;
+            }
+            for (int i = 0; i < Rows; ++i)
+                constraintSpaceImpulse[i] = accumulatedImpulse[i] - preadd[i];
+        }
+
+        /// <summary>
+        /// Applies impulses to satisfy the velocity constraint of an N-DOF constraint.
+        /// Limits can only apply positive impulses.
+        /// </summary>
+        template<int Rows, bool IsLimit>
+            inline void SolveVelocityIteration(const JacobianRows<Rows> &jacobians, const float (&velocityBias)[Rows], const float (&effectiveMass)[Rows][Rows],
+                float softness, float maximumImpulse, float maximumImpulseSquared, float (&accumulatedImpulse)[Rows],
+                BoneStore &bones, BoneHandle handleA, BoneHandle handleB)
+        {
+            float constraintSpaceImpulse[Rows];
+            ComputeVelocityImpulse<Rows, IsLimit>(jacobians, velocityBias, effectiveMass, softness, maximumImpulse, maximumImpulseSquared, 1.f, accumulatedImpulse,
+                bones, handleA, handleB, constraintSpaceImpulse);
+            ApplyImpulse<Rows>(jacobians, constraintSpaceImpulse, bones, handleA, handleB);
+        }
+
+        template<int Rows>
+            inline JacobianRows<Rows> GetJacobianRows(const IKJoint &joint)
+        {
+            //Each row of a Matrix3x3 is a Vector3 and the rows are contiguous, so the joint's matrices can be viewed as row arrays directly.
+            return {&joint.linearJacobianA[0], &joint.angularJacobianA[0], &joint.linearJacobianB[0], &joint.angularJacobianB[0]};
+        }
+
+        /// <summary>
+        /// Computes the reduced effective mass of a joint and stores it in the upper left block of the joint's effective mass matrix.
+        /// </summary>
+        template<int Rows>
+            inline void ComputeJointEffectiveMass(IKJoint &joint)
+        {
+            float effectiveMass[Rows][Rows];
+            ComputeEffectiveMass<Rows>(GetJacobianRows<Rows>(joint), *joint.m_boneStore, joint.m_handleA, joint.m_handleB, joint.softness, effectiveMass);
+            joint.effectiveMass = matrix::Create();
+            for (int i = 0; i < Rows; ++i)
+            {
+                for (int j = 0; j < Rows; ++j)
+                    joint.effectiveMass[i][j] = effectiveMass[i][j];
+            }
+        }
+
+        template<int Rows>
+            inline void WarmStartJoint(IKJoint &joint)
+        {
+            float accumulatedImpulse[Rows];
+            for (int i = 0; i < Rows; ++i)
+                accumulatedImpulse[i] = joint.accumulatedImpulse[i];
+            ApplyImpulse<Rows>(GetJacobianRows<Rows>(joint), accumulatedImpulse, *joint.m_boneStore, joint.m_handleA, joint.m_handleB);
+        }
+
+        /// <summary>
+        /// Computes the world space impulses of a joint's accumulated impulse without applying them.
+        /// </summary>
+        template<int Rows>
+            inline void ComputeJointWarmStartImpulses(const IKJoint &joint, WorldImpulses &impulses)
+        {
+            float accumulatedImpulse[Rows];
+            for (int i = 0; i < Rows; ++i)
+                accumulatedImpulse[i] = joint.accumulatedImpulse[i];
+            ComputeWorldImpulses<Rows>(GetJacobianRows<Rows>(joint), accumulatedImpulse, impulses);
+        }
+
+        /// <summary>
+        /// Computes and accumulates the relaxed velocity impulse of a joint, and outputs its world space impulses instead of applying them.
+        /// </summary>
+        template<int Rows, bool IsLimit>
+            inline void ComputeJointVelocityImpulses(IKJoint &joint, float relaxation, WorldImpulses &impulses)
+        {
+            float velocityBias[Rows];
+            float effectiveMass[Rows][Rows];
+            float accumulatedImpulse[Rows];
+            for (int i = 0; i < Rows; ++i)
+            {
+                velocityBias[i] = joint.velocityBias[i];
+                accumulatedImpulse[i] = joint.accumulatedImpulse[i];
+                for (int j = 0; j < Rows; ++j)
+                    effectiveMass[i][j] = joint.effectiveMass[i][j];
+            }
+            auto jacobians = GetJacobianRows<Rows>(joint);
+            float constraintSpaceImpulse[Rows];
+            ComputeVelocityImpulse<Rows, IsLimit>(jacobians, velocityBias, effectiveMass, joint.softness, joint.MaximumImpulse, joint.MaximumImpulseSquared, relaxation,
+                accumulatedImpulse, *joint.m_boneStore, joint.m_handleA, joint.m_handleB, constraintSpaceImpulse);
+            for (int i = 0; i < Rows; ++i)
+                joint.accumulatedImpulse[i] = accumulatedImpulse[i];
+            ComputeWorldImpulses<Rows>(jacobians, constraintSpaceImpulse, impulses);
+        }
+
+        template<int Rows, bool IsLimit>
+            inline void SolveJointVelocityIteration(IKJoint &joint)
+        {
+            float velocityBias[Rows];
+            float effectiveMass[Rows][Rows];
+            float accumulatedImpulse[Rows];
+            for (int i = 0; i < Rows; ++i)
+            {
+                velocityBias[i] = joint.velocityBias[i];
+                accumulatedImpulse[i] = joint.accumulatedImpulse[i];
+                for (int j = 0; j < Rows; ++j)
+                    effectiveMass[i][j] = joint.effectiveMass[i][j];
+            }
+            SolveVelocityIteration<Rows, IsLimit>(GetJacobianRows<Rows>(joint), velocityBias, effectiveMass,
+                joint.softness, joint.MaximumImpulse, joint.MaximumImpulseSquared, accumulatedImpulse,
+                *joint.m_boneStore, joint.m_handleA, joint.m_handleB);
+            for (int i = 0; i < Rows; ++i)
+                joint.accumulatedImpulse[i] = accumulatedImpulse[i];
+        }
+	}
+}
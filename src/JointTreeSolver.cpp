@@ -0,0 +1,442 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/JointTreeSolver.hpp"
+#include "bepuik/JointBatches.hpp"
+#include "bepuik/PermutationMapper.hpp"
+#include "bepuik/limit/IKLimit.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+namespace BEPUik
+{
+    //Inverts a symmetric definite block of the given size in place through an LDLT decomposition.
+    //Negative definite blocks are inverted through their negation. Directions without a usable pivot are dropped from the inverse,
+    //like the submatrix fallbacks of matrix::AdaptiveInvert.
+    static void InvertDefinite(float (&block)[6][6], int size, bool negative)
+    {
+        float sign = negative ? -1.f : 1.f;
+        float lower[6][6] {};
+        float diagonal[6];
+        float largestDiagonal = 0;
+        for (int i = 0; i < size; ++i)
+            largestDiagonal = std::max(largestDiagonal, sign * block[i][i]);
+        float threshold = largestDiagonal * 1e-6f;
+        for (int j = 0; j < size; ++j)
+        {
+            float d = sign * block[j][j];
+            for (int k = 0; k < j; ++k)
+                d -= lower[j][k] * lower[j][k] * diagonal[k];
+            diagonal[j] = d > threshold ? d : 0.f;
+            lower[j][j] = 1;
+            for (int i = j + 1; i < size; ++i)
+            {
+                if (diagonal[j] == 0)
+                {
+                    lower[i][j] = 0;
+                    continue;
+                }
+                float value = sign * block[i][j];
+                for (int k = 0; k < j; ++k)
+                    value -= lower[i][k] * lower[j][k] * diagonal[k];
+                lower[i][j] = value / diagonal[j];
+            }
+        }
+        //Invert the unit lower triangular factor by forward substitution.
+        float lowerInverse[6][6] {};
+        for (int j = 0; j < size; ++j)
+        {
+            lowerInverse[j][j] = 1;
+            for (int i = j + 1; i < size; ++i)
+            {
+                float value = 0;
+                for (int k = j; k < i; ++k)
+                    value -= lower[i][k] * lowerInverse[k][j];
+                lowerInverse[i][j] = value;
+            }
+        }
+        //A^-1 = L^-T * D^-1 * L^-1.
+        for (int i = 0; i < size; ++i)
+        {
+            for (int j = i; j < size; ++j)
+            {
+                float value = 0;
+                for (int k = j; k < size; ++k)
+                {
+                    if (diagonal[k] != 0)
+                        value += lowerInverse[k][i] * lowerInverse[k][j] / diagonal[k];
+                }
+                block[i][j] = sign * value;
+                block[j][i] = sign * value;
+            }
+        }
+    }
+}
+
+void BEPUik::JointTreeSolver::Build(const std::vector<IKJoint*> &joints, BoneStore &bones)
+{
+    Clear();
+    m_bones = &bones;
+    auto isMovable = [&bones](BoneHandle handle) {return bones.IsIntegrated(handle) && bones.inverseMasses[handle] != 0.f;};
+
+    //Merge the equality joints by bone pair. A constraint between two movable bones which are already connected would close a loop, so it stays iterative.
+    std::vector<uint32_t> treeParents(bones.GetIntegratedCount());
+    std::iota(treeParents.begin(), treeParents.end(), 0u);
+    auto findRoot = [&treeParents](uint32_t handle) {
+        while (treeParents[handle] != handle)
+        {
+            treeParents[handle] = treeParents[treeParents[handle]];
+            handle = treeParents[handle];
+        }
+        return handle;
+    };
+    std::map<std::pair<BoneHandle, BoneHandle>, size_t> pairConstraints;
+	for(auto *joint : joints)
+    {
+        auto handleA = joint->m_handleA;
+        auto handleB = joint->m_handleB;
+        bool movableA = isMovable(handleA);
+        bool movableB = isMovable(handleB);
+        //Custom joints may clamp or solve their impulses in ways the direct solve can't represent.
+        if (dynamic_cast<IKLimit*>(joint) != nullptr || JointBatches::Classify(*joint) == JointType::Custom || (!movableA && !movableB))
+        {
+            m_iterativeJoints.push_back(joint);
+            continue;
+        }
+        auto key = std::minmax(handleA, handleB);
+        auto existing = pairConstraints.find(key);
+        if (existing != pairConstraints.end())
+        {
+            auto &constraint = m_constraints[existing->second];
+            if (constraint.rowCount + joint->GetDegreesOfFreedom() > MaximumRows)
+            {
+                m_iterativeJoints.push_back(joint);
+                continue;
+            }
+            constraint.joints.push_back(joint);
+            constraint.rowCount += joint->GetDegreesOfFreedom();
+            continue;
+        }
+        if (movableA && movableB)
+        {
+            auto rootA = findRoot(handleA);
+            auto rootB = findRoot(handleB);
+            if (rootA == rootB)
+            {
+                m_iterativeJoints.push_back(joint);
+                continue;
+            }
+            treeParents[rootA] = rootB;
+        }
+        pairConstraints.emplace(key, m_constraints.size());
+        m_constraints.push_back({{joint}, handleA, handleB, joint->GetDegreesOfFreedom()});
+    }
+	for(auto &constraint : m_constraints)
+        m_directJointCount += constraint.joints.size();
+
+    //Walk every tree breadth first from its lowest bone handle. Bones and constraints alternate along the way.
+    std::vector<std::vector<uint32_t>> boneConstraints(bones.GetIntegratedCount());
+    for (size_t i = 0; i < m_constraints.size(); ++i)
+    {
+        for (auto handle : {m_constraints[i].handleA, m_constraints[i].handleB})
+        {
+            if (isMovable(handle))
+                boneConstraints[handle].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    m_boneNodes.assign(bones.GetIntegratedCount(), NoParent);
+    std::vector<uint8_t> visitedConstraints(m_constraints.size(), 0);
+    auto addNode = [this](uint32_t parent, uint32_t index, bool isBone, int size) {
+        auto &node = m_nodes.emplace_back();
+        node.parent = parent;
+        node.index = index;
+        node.isBone = isBone;
+        node.size = size;
+    };
+    for (uint32_t root = 0; root < boneConstraints.size(); ++root)
+    {
+        if (boneConstraints[root].empty() || m_boneNodes[root] != NoParent)
+            continue;
+        m_boneNodes[root] = static_cast<uint32_t>(m_nodes.size());
+        addNode(NoParent, root, true, 6);
+        for (auto i = m_boneNodes[root]; i < m_nodes.size(); ++i)
+        {
+            auto index = m_nodes[i].index;
+            if (m_nodes[i].isBone)
+            {
+				for(auto constraintIndex : boneConstraints[index])
+                {
+                    if (visitedConstraints[constraintIndex])
+                        continue;
+                    visitedConstraints[constraintIndex] = 1;
+                    addNode(i, constraintIndex, false, m_constraints[constraintIndex].rowCount);
+                }
+                continue;
+            }
+            for (auto handle : {m_constraints[index].handleA, m_constraints[index].handleB})
+            {
+                if (!isMovable(handle) || m_boneNodes[handle] != NoParent)
+                    continue;
+                m_boneNodes[handle] = static_cast<uint32_t>(m_nodes.size());
+                addNode(i, handle, true, 6);
+            }
+        }
+    }
+}
+
+void BEPUik::JointTreeSolver::Clear()
+{
+    m_bones = nullptr;
+    m_iterativeJoints.clear();
+    m_constraints.clear();
+    m_directJointCount = 0;
+    m_nodes.clear();
+    m_boneNodes.clear();
+}
+
+size_t BEPUik::JointTreeSolver::GetDirectJointCount() const {return m_directJointCount;}
+const std::vector<BEPUik::IKJoint*> &BEPUik::JointTreeSolver::GetIterativeJoints() const {return m_iterativeJoints;}
+
+void BEPUik::JointTreeSolver::UpdateJoints(bool updateEffectiveMass)
+{
+	for(auto *joint : m_iterativeJoints)
+    {
+        joint->UpdateJacobiansAndVelocityBias();
+        if (updateEffectiveMass)
+            joint->ComputeEffectiveMass();
+        joint->WarmStart();
+    }
+    //The direct joints never use their effective mass.
+	for(auto &constraint : m_constraints)
+    {
+		for(auto *joint : constraint.joints)
+        {
+            joint->UpdateJacobiansAndVelocityBias();
+            joint->WarmStart();
+        }
+    }
+    Factorize();
+}
+
+void BEPUik::JointTreeSolver::Factorize()
+{
+    auto &bones = *m_bones;
+    //Fill in the blocks of [M J^T; J -S]. The pivot blocks are kept in inverseDiagonal until they are inverted.
+	for(auto &node : m_nodes)
+    {
+        auto &diagonal = node.inverseDiagonal;
+        for (int i = 0; i < MaximumRows; ++i)
+        {
+            for (int j = 0; j < MaximumRows; ++j)
+            {
+                diagonal[i][j] = 0;
+                node.parentCoupling[i][j] = 0;
+            }
+        }
+        if (node.isBone)
+        {
+            auto handle = static_cast<BoneHandle>(node.index);
+            float mass = 1 / bones.inverseMasses[handle];
+            //Both inertia tensors are symmetric, so the transformed unit vectors can be used as rows.
+            Matrix3x3 inertiaTensorInverse;
+            inertiaTensorInverse[0] = bones.TransformByInertiaTensorInverse(handle, Vector3(1.f, 0.f, 0.f));
+            inertiaTensorInverse[1] = bones.TransformByInertiaTensorInverse(handle, Vector3(0.f, 1.f, 0.f));
+            inertiaTensorInverse[2] = bones.TransformByInertiaTensorInverse(handle, Vector3(0.f, 0.f, 1.f));
+            auto inertiaTensor = matrix::Invert(inertiaTensorInverse);
+            for (int i = 0; i < 3; ++i)
+            {
+                diagonal[i][i] = mass;
+                for (int j = 0; j < 3; ++j)
+                    diagonal[3 + i][3 + j] = inertiaTensor[i][j];
+            }
+        }
+        else
+        {
+            int row = 0;
+			for(auto *joint : m_constraints[node.index].joints)
+            {
+                for (int i = 0; i < joint->GetDegreesOfFreedom(); ++i, ++row)
+                    diagonal[row][row] = -joint->softness;
+            }
+        }
+        if (node.parent == NoParent)
+            continue;
+
+        //The coupling between a constraint and a bone is the constraint's jacobian for that bone; below a bone, the coupling is its transpose.
+        auto &constraintNode = node.isBone ? m_nodes[node.parent] : node;
+        auto handle = static_cast<BoneHandle>(node.isBone ? node.index : m_nodes[node.parent].index);
+        int row = 0;
+		for(auto *joint : m_constraints[constraintNode.index].joints)
+        {
+            bool isA = joint->m_handleA == handle;
+            const auto &linearJacobian = isA ? joint->linearJacobianA : joint->linearJacobianB;
+            const auto &angularJacobian = isA ? joint->angularJacobianA : joint->angularJacobianB;
+            for (int i = 0; i < joint->GetDegreesOfFreedom(); ++i, ++row)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (node.isBone)
+                    {
+                        node.parentCoupling[k][row] = linearJacobian[i][k];
+                        node.parentCoupling[3 + k][row] = angularJacobian[i][k];
+                    }
+                    else
+                    {
+                        node.parentCoupling[row][k] = linearJacobian[i][k];
+                        node.parentCoupling[row][3 + k] = angularJacobian[i][k];
+                    }
+                }
+            }
+        }
+    }
+
+    //Eliminate the leaves first. Every child was eliminated before its parent, so the parent's pivot block is complete when it is reached.
+    for (size_t n = m_nodes.size(); n-- > 0;)
+    {
+        auto &node = m_nodes[n];
+        InvertDefinite(node.inverseDiagonal, node.size, !node.isBone);
+        if (node.parent == NoParent)
+            continue;
+        //D_parent -= C^T * D^-1 * C.
+        auto &parent = m_nodes[node.parent];
+        float product[MaximumRows][MaximumRows];
+        for (int i = 0; i < node.size; ++i)
+        {
+            for (int j = 0; j < parent.size; ++j)
+            {
+                float value = 0;
+                for (int k = 0; k < node.size; ++k)
+                    value += node.inverseDiagonal[i][k] * node.parentCoupling[k][j];
+                product[i][j] = value;
+            }
+        }
+        for (int i = 0; i < parent.size; ++i)
+        {
+            for (int j = 0; j < parent.size; ++j)
+            {
+                float value = 0;
+                for (int k = 0; k < node.size; ++k)
+                    value += node.parentCoupling[k][i] * product[k][j];
+                parent.inverseDiagonal[i][j] -= value;
+            }
+        }
+    }
+}
+
+void BEPUik::JointTreeSolver::SolveDirect()
+{
+    auto &bones = *m_bones;
+    //The right hand side is zero for the bones and the velocity error of the constraints, as the iterative joints would compute it.
+	for(auto &node : m_nodes)
+    {
+        for (int i = 0; i < node.size; ++i)
+            node.y[i] = 0;
+        if (node.isBone)
+            continue;
+        int row = 0;
+		for(auto *joint : m_constraints[node.index].joints)
+        {
+            const auto &linearVelocityA = bones.linearVelocities[joint->m_handleA];
+            const auto &angularVelocityA = bones.angularVelocities[joint->m_handleA];
+            const auto &linearVelocityB = bones.linearVelocities[joint->m_handleB];
+            const auto &angularVelocityB = bones.angularVelocities[joint->m_handleB];
+            for (int i = 0; i < joint->GetDegreesOfFreedom(); ++i, ++row)
+            {
+                float constraintVelocityError = vector3::Dot(linearVelocityA, joint->linearJacobianA[i]) + vector3::Dot(angularVelocityA, joint->angularJacobianA[i]) +
+                    vector3::Dot(linearVelocityB, joint->linearJacobianB[i]) + vector3::Dot(angularVelocityB, joint->angularJacobianB[i]) -
+                    joint->velocityBias[i] + joint->accumulatedImpulse[i] * joint->softness;
+                node.y[row] = -constraintVelocityError;
+            }
+        }
+    }
+
+    //Forward substitution from the leaves: y_parent -= C^T * D^-1 * y.
+    for (size_t n = m_nodes.size(); n-- > 0;)
+    {
+        auto &node = m_nodes[n];
+        if (node.parent == NoParent)
+            continue;
+        auto &parent = m_nodes[node.parent];
+        float scaled[MaximumRows];
+        for (int i = 0; i < node.size; ++i)
+        {
+            float value = 0;
+            for (int k = 0; k < node.size; ++k)
+                value += node.inverseDiagonal[i][k] * node.y[k];
+            scaled[i] = value;
+        }
+        for (int j = 0; j < parent.size; ++j)
+        {
+            float value = 0;
+            for (int k = 0; k < node.size; ++k)
+                value += node.parentCoupling[k][j] * scaled[k];
+            parent.y[j] -= value;
+        }
+    }
+
+    //Back substitution from the roots: x = D^-1 * (y - C * x_parent).
+	for(auto &node : m_nodes)
+    {
+        float residual[MaximumRows];
+        for (int i = 0; i < node.size; ++i)
+        {
+            residual[i] = node.y[i];
+            if (node.parent == NoParent)
+                continue;
+            auto &parent = m_nodes[node.parent];
+            for (int k = 0; k < parent.size; ++k)
+                residual[i] -= node.parentCoupling[i][k] * parent.x[k];
+        }
+        for (int i = 0; i < node.size; ++i)
+        {
+            float value = 0;
+            for (int k = 0; k < node.size; ++k)
+                value += node.inverseDiagonal[i][k] * residual[k];
+            node.x[i] = value;
+        }
+    }
+
+    //The bone rows hold the velocity changes and the constraint rows the negated impulses.
+	for(auto &node : m_nodes)
+    {
+        if (node.isBone)
+        {
+            auto handle = static_cast<BoneHandle>(node.index);
+            bones.linearVelocities[handle] = vector3::Add(bones.linearVelocities[handle], Vector3(node.x[0], node.x[1], node.x[2]));
+            bones.angularVelocities[handle] = vector3::Add(bones.angularVelocities[handle], Vector3(node.x[3], node.x[4], node.x[5]));
+            continue;
+        }
+        int row = 0;
+		for(auto *joint : m_constraints[node.index].joints)
+        {
+            for (int i = 0; i < joint->GetDegreesOfFreedom(); ++i, ++row)
+                joint->accumulatedImpulse[i] -= node.x[row];
+        }
+    }
+}
+
+void BEPUik::JointTreeSolver::SolveVelocityIteration(PermutationMapper &permutationMapper)
+{
+    auto jointCount = static_cast<int>(m_iterativeJoints.size());
+    for (int jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+    {
+        auto remappedIndex = permutationMapper.GetMappedIndex(jointIndex, jointCount);
+        m_iterativeJoints[remappedIndex]->SolveVelocityIteration();
+    }
+    //The direct solve comes last so that the equality joints hold exactly for the velocities that get integrated.
+    SolveDirect();
+}
@@ -18,7 +18,7 @@
 namespace BEPUik
 {
 
-	int64_t primes[] = {
+	static constexpr int64_t primes[] = {
     
                                         818660357, 878916037, 844828463, 706609493, 478906601, 707908823, 938052293, 630235027, 984165979, 522311087, 
                                         533822657, 647031821, 756030427, 649614073, 988123237, 367570499, 906500941, 996040853, 783408599, 547916219, 
@@ -74,7 +74,7 @@ namespace BEPUik
     
     
                                    };   
-	int64_t primesLength = 503;
+	static constexpr int64_t primesLength = 503;
 
 /// <summary>
 /// Constructs a new permutation mapper.
@@ -0,0 +1,84 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/Simd.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BEPUIK_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace BEPUik
+{
+    //Defined by the per-instruction set kernel translation units; false if the build could not compile them.
+	namespace bundlekernels
+	{
+		namespace sse {extern const bool Available;}
+		namespace avx2 {extern const bool Available;}
+	}
+
+	static SimdLevel DetectSimdLevel()
+	{
+#if defined(BEPUIK_X86)
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		bool avx2 = false;
+		if (maxLeaf >= 7 && osxsave && avx)
+		{
+			//The OS must also save the upper halves of the ymm registers on context switches.
+			bool ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+			__cpuidex(info, 7, 0);
+			avx2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2 && bundlekernels::avx2::Available)
+			return SimdLevel::AVX2;
+		if (sse2 && bundlekernels::sse::Available)
+			return SimdLevel::SSE;
+#endif
+		return SimdLevel::Scalar;
+	}
+}
+
+BEPUik::SimdLevel BEPUik::GetSupportedSimdLevel()
+{
+	static const SimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+int BEPUik::GetSimdWidth(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX2:
+		return 8;
+	case SimdLevel::SSE:
+		return 4;
+	default:
+		return 1;
+	}
+}
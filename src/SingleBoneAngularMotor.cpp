@@ -16,14 +16,14 @@
 #include "bepuik/SingleBoneAngularMotor.hpp"
 #include "bepuik/Bone.hpp"
 
-void BEPUik::SingleBoneAngularMotor::UpdateJacobiansAndVelocityBias()
+void BEPUik::SingleBoneAngularMotor::ComputeJacobians(const Vector3 &, const Quaternion &orientation, SingleBoneJacobians &jacobians) const
 {
-    linearJacobian = BEPUik::matrix::Create();
-	angularJacobian = BEPUik::matrix::GetIdentity();
+    jacobians.linear = BEPUik::matrix::Create();
+	jacobians.angular = BEPUik::matrix::GetIdentity();
 
     //Error is in world space. It gets projected onto the jacobians later.
     Quaternion errorQuaternion;
-    errorQuaternion = BEPUik::quaternion::Conjugate(TargetBone->Orientation);
+    errorQuaternion = BEPUik::quaternion::Conjugate(orientation);
     errorQuaternion = BEPUik::quaternion::Multiply(TargetOrientation, errorQuaternion);
     float angle;
     Vector3 angularError;
@@ -31,5 +31,5 @@ void BEPUik::SingleBoneAngularMotor::UpdateJacobiansAndVelocityBias()
     angularError = vector3::Multiply(angularError, angle);
 
     //This is equivalent to projecting the error onto the angular jacobian. The angular jacobian just happens to be the identity matrix!
-    velocityBias = vector3::Multiply(angularError, errorCorrectionFactor);
+    jacobians.velocityBias = vector3::Multiply(angularError, errorCorrectionFactor);
 }
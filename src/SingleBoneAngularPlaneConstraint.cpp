@@ -16,18 +16,19 @@
 #include "bepuik/SingleBoneAngularPlaneConstraint.hpp"
 #include "bepuik/Bone.hpp"
 
-void BEPUik::SingleBoneAngularPlaneConstraint::UpdateJacobiansAndVelocityBias()
+void BEPUik::SingleBoneAngularPlaneConstraint::ComputeJacobians(const Vector3 &, const Quaternion &orientation, SingleBoneJacobians &jacobians) const
 {
  
 
-    linearJacobian = matrix::Create();
+    jacobians.linear = matrix::Create();
 
     Vector3 boneAxis;
-    boneAxis = quaternion::Transform(BoneLocalAxis, TargetBone->Orientation);
+    boneAxis = quaternion::Transform(BoneLocalAxis, orientation);
 
     Vector3 jacobian;
     jacobian = vector3::Cross(boneAxis, PlaneNormal);
 
+    auto &angularJacobian = jacobians.angular;
 	angularJacobian = matrix::Create();
 	angularJacobian[0][0]=jacobian.x;
 	angularJacobian[0][1]=jacobian.y;
@@ -40,8 +41,8 @@ void BEPUik::SingleBoneAngularPlaneConstraint::UpdateJacobiansAndVelocityBias()
 	angularJacobian[2][2]=0;
 
 
-    velocityBias.x = vector3::Dot(boneAxis, PlaneNormal);
-    velocityBias.x = -errorCorrectionFactor * velocityBias.x;
+    jacobians.velocityBias.x = vector3::Dot(boneAxis, PlaneNormal);
+    jacobians.velocityBias.x = -errorCorrectionFactor * jacobians.velocityBias.x;
 
 
 }
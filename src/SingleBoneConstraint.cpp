@@ -15,22 +15,45 @@
 
 #include "bepuik/SingleBoneConstraint.hpp"
 #include "bepuik/Bone.hpp"
+#include <cassert>
 
 BEPUik::Bone *BEPUik::SingleBoneConstraint::GetTargetBone() {return TargetBone;}
 void BEPUik::SingleBoneConstraint::SetTargetBone(Bone *bone) {TargetBone = bone;}
+void BEPUik::SingleBoneConstraint::ComputeJacobians([[maybe_unused]] const Vector3 &position, [[maybe_unused]] const Quaternion &orientation, SingleBoneJacobians &jacobians) const
+{
+    //Fallback for custom constraints that predate ComputeJacobians and compute their jacobians in UpdateJacobiansAndVelocityBias.
+    assert(position == TargetBone->Position && orientation == TargetBone->Orientation);
+    const_cast<SingleBoneConstraint*>(this)->UpdateJacobiansAndVelocityBias();
+    jacobians.linear = linearJacobian;
+    jacobians.angular = angularJacobian;
+    jacobians.velocityBias = velocityBias;
+}
+
+void BEPUik::SingleBoneConstraint::UpdateJacobiansAndVelocityBias()
+{
+    SingleBoneJacobians jacobians;
+    ComputeJacobians(TargetBone->Position, TargetBone->Orientation, jacobians);
+    linearJacobian = jacobians.linear;
+    angularJacobian = jacobians.angular;
+    velocityBias = jacobians.velocityBias;
+}
+
 void BEPUik::SingleBoneConstraint::ComputeEffectiveMass()
 {
     //For all constraints, the effective mass matrix is 1 / (J * M^-1 * JT).
     //For single bone constraints, J has 2 3x3 matrices. M^-1 (W below) is a 6x6 matrix with 2 3x3 block diagonal matrices.
     //To compute the whole denominator,
+    auto &bones = *TargetBone->store;
+    auto handle = TargetBone->handle;
     Matrix3x3 linearW;
-    linearW = matrix::CreateScale(TargetBone->inverseMass);
+    linearW = matrix::CreateScale(bones.inverseMasses[handle]);
     Matrix3x3 linear;
     linear = matrix::Multiply(linearJacobian, linearW); //Compute J * M^-1 for linear component
     linear = matrix::MultiplyByTransposed(linear, linearJacobian); //Compute (J * M^-1) * JT for linear component
 
     Matrix3x3 angular;
-    angular = matrix::Multiply(angularJacobian, TargetBone->inertiaTensorInverse); //Compute J * M^-1 for angular component
+    for (int i = 0; i < 3; ++i)
+        angular[i] = bones.TransformByInertiaTensorInverse(handle, angularJacobian[i]); //Compute J * M^-1 for angular component
     angular = matrix::MultiplyByTransposed(angular, angularJacobian); //Compute (J * M^-1) * JT for angular component
 
     //A nice side effect of the block diagonal nature of M^-1 is that the above separated components are now combined into the complete denominator matrix by addition!
@@ -56,23 +79,27 @@ void BEPUik::SingleBoneConstraint::WarmStart()
     //(where P is the impulse, JT is the transposed jacobian matrix, and lambda is the accumulated impulse).
     //Recall the jacobian takes impulses from world space into constraint space, and transpose takes them from constraint space into world space.
     //Compute and apply linear impulse.
+    auto &bones = *TargetBone->store;
+    auto handle = TargetBone->handle;
     Vector3 impulse;
     impulse = matrix::Transform(accumulatedImpulse, linearJacobian);
-    TargetBone->ApplyLinearImpulse(impulse);
+    bones.ApplyLinearImpulse(handle, impulse);
 
     //Compute and apply angular impulse.
     impulse = matrix::Transform(accumulatedImpulse, angularJacobian);
-    TargetBone->ApplyAngularImpulse(impulse);
+    bones.ApplyAngularImpulse(handle, impulse);
 }
 
 void BEPUik::SingleBoneConstraint::SolveVelocityIteration()
 {
     //Compute the 'relative' linear and angular velocities. For single bone constraints, it's based entirely on the one bone's velocities!
     //They have to be pulled into constraint space first to compute the necessary impulse, though.
+    auto &bones = *TargetBone->store;
+    auto handle = TargetBone->handle;
     Vector3 linearContribution;
-    linearContribution = matrix::TransformTranspose(TargetBone->linearVelocity, linearJacobian);
+    linearContribution = matrix::TransformTranspose(bones.linearVelocities[handle], linearJacobian);
     Vector3 angularContribution;
-    angularContribution = matrix::TransformTranspose(TargetBone->angularVelocity, angularJacobian);
+    angularContribution = matrix::TransformTranspose(bones.angularVelocities[handle], angularJacobian);
 
     //The constraint velocity error will be the velocity we try to remove.
     Vector3 constraintVelocityError;
@@ -113,11 +140,16 @@ void BEPUik::SingleBoneConstraint::SolveVelocityIteration()
     angularImpulse = matrix::Transform(constraintSpaceImpulse, angularJacobian);
 
     //Apply them!
-    TargetBone->ApplyLinearImpulse(linearImpulse);
-    TargetBone->ApplyAngularImpulse(angularImpulse);
+    bones.ApplyLinearImpulse(handle, linearImpulse);
+    bones.ApplyAngularImpulse(handle, angularImpulse);
 }
 
 void BEPUik::SingleBoneConstraint::ClearAccumulatedImpulses()
 {
     accumulatedImpulse = vector3::Create();
 }
+
+void BEPUik::SingleBoneConstraint::ScaleAccumulatedImpulses(float scale)
+{
+    accumulatedImpulse = vector3::Multiply(accumulatedImpulse, scale);
+}
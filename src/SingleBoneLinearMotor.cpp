@@ -19,21 +19,21 @@
 BEPUik::Vector3 BEPUik::SingleBoneLinearMotor::GetOffset() const { return quaternion::Transform(LocalOffset, TargetBone->Orientation); }
 void BEPUik::SingleBoneLinearMotor::SetOffset(const Vector3 &value) { LocalOffset = quaternion::Transform(value, BEPUik::quaternion::Conjugate(TargetBone->Orientation)); }
 
-void BEPUik::SingleBoneLinearMotor::UpdateJacobiansAndVelocityBias()
+void BEPUik::SingleBoneLinearMotor::ComputeJacobians(const Vector3 &position, const Quaternion &orientation, SingleBoneJacobians &jacobians) const
 {
-    linearJacobian = matrix::GetIdentity();
+    jacobians.linear = matrix::GetIdentity();
     Vector3 r;
-    r = quaternion::Transform(LocalOffset, TargetBone->Orientation);
-    angularJacobian = matrix::CreateCrossProduct(r);
+    r = quaternion::Transform(LocalOffset, orientation);
+    jacobians.angular = matrix::CreateCrossProduct(r);
     //Transposing a skew symmetric matrix is equivalent to negating it.
-    angularJacobian = matrix::Transpose(angularJacobian);
+    jacobians.angular = matrix::Transpose(jacobians.angular);
 
     Vector3 worldPosition;
-    worldPosition = vector3::Add(TargetBone->Position, r);
+    worldPosition = vector3::Add(position, r);
 
     //Error is in world space.
     Vector3 linearError;
     linearError = vector3::Subtract(TargetPosition, worldPosition);
     //This is equivalent to projecting the error onto the linear jacobian. The linear jacobian just happens to be the identity matrix!
-    velocityBias = vector3::Multiply(linearError, errorCorrectionFactor);
+    jacobians.velocityBias = vector3::Multiply(linearError, errorCorrectionFactor);
 }
@@ -29,15 +29,16 @@ void BEPUik::SingleBoneRevoluteConstraint::SetFreeAxis(const Vector3 &value)
     constrainedAxis2 = vector3::Cross(freeAxis, constrainedAxis1);
 }
 
-void BEPUik::SingleBoneRevoluteConstraint::UpdateJacobiansAndVelocityBias()
+void BEPUik::SingleBoneRevoluteConstraint::ComputeJacobians(const Vector3 &, const Quaternion &orientation, SingleBoneJacobians &jacobians) const
 {
  
 
-    linearJacobian = matrix::Create();
+    jacobians.linear = matrix::Create();
 
     Vector3 boneAxis;
-    boneAxis = quaternion::Transform(BoneLocalFreeAxis, TargetBone->Orientation);
+    boneAxis = quaternion::Transform(BoneLocalFreeAxis, orientation);
 
+    auto &angularJacobian = jacobians.angular;
 	angularJacobian = matrix::Create();
 	angularJacobian[0][0]=constrainedAxis1.x;
 	angularJacobian[0][1]=constrainedAxis1.y;
@@ -55,8 +56,8 @@ void BEPUik::SingleBoneRevoluteConstraint::UpdateJacobiansAndVelocityBias()
     Vector2 constraintSpaceError;
     constraintSpaceError.x = vector3::Dot(error, constrainedAxis1);
     constraintSpaceError.y = vector3::Dot(error, constrainedAxis2);
-    velocityBias.x = errorCorrectionFactor * constraintSpaceError.x;
-    velocityBias.y = errorCorrectionFactor * constraintSpaceError.y;
+    jacobians.velocityBias.x = errorCorrectionFactor * constraintSpaceError.x;
+    jacobians.velocityBias.y = errorCorrectionFactor * constraintSpaceError.y;
 
 
 }
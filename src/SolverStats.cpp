@@ -0,0 +1,58 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/SolverStats.hpp"
+
+const char *BEPUik::GetSolvePhaseName(SolvePhase phase)
+{
+	switch (phase)
+	{
+	case SolvePhase::ActiveSetUpdate:
+		return "ActiveSetUpdate";
+	case SolvePhase::Preparation:
+		return "Preparation";
+	case SolvePhase::InertiaTensorUpdate:
+		return "InertiaTensorUpdate";
+	case SolvePhase::JointUpdate:
+		return "JointUpdate";
+	case SolvePhase::ControlUpdate:
+		return "ControlUpdate";
+	case SolvePhase::VelocitySolve:
+		return "VelocitySolve";
+	case SolvePhase::Integration:
+		return "Integration";
+	case SolvePhase::IslandSolve:
+		return "IslandSolve";
+	default:
+		return "Unknown";
+	}
+}
+
+void BEPUik::SolverStats::Reset() {*this = SolverStats{};}
+
+BEPUik::SolvePhaseScope::SolvePhaseScope(SolverStats &stats, const SolvePhaseCallback &callback, SolvePhase phase)
+	: m_stats(stats), m_callback(callback), m_phase(phase)
+{
+	if (m_callback)
+		m_callback(m_phase, true);
+	m_start = std::chrono::steady_clock::now();
+}
+
+BEPUik::SolvePhaseScope::~SolvePhaseScope()
+{
+	m_stats.phaseSeconds[static_cast<size_t>(m_phase)] += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	if (m_callback)
+		m_callback(m_phase, false);
+}
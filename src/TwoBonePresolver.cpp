@@ -0,0 +1,264 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/TwoBonePresolver.hpp"
+#include "bepuik/Bone.hpp"
+#include "bepuik/control/Control.hpp"
+#include "bepuik/SingleBoneLinearMotor.hpp"
+#include "bepuik/joint/IKBallSocketJoint.hpp"
+#include "bepuik/joint/IKRevoluteJoint.hpp"
+#include "bepuik/joint/IKSwivelHingeJoint.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace BEPUik
+{
+	static Bone *GetOtherBone(IKJoint &joint, const Bone &bone)
+	{
+		return joint.m_connectionA == &bone ? joint.m_connectionB : joint.m_connectionA;
+	}
+
+    //Checks that every joint of the bone leads to one of the given bones.
+	static bool ConnectsOnlyTo(const Bone &bone, const Bone *first, const Bone *second)
+	{
+		for(auto *joint : bone.joints)
+		{
+			auto *other = GetOtherBone(*joint, bone);
+			if (other != first && other != second)
+				return false;
+		}
+		return true;
+	}
+
+    //Finds a ball socket joint between the bones and gets its anchor in the local space of each.
+	static bool FindBallSocket(const Bone &a, const Bone &b, Vector3 &localAnchorA, Vector3 &localAnchorB)
+	{
+		for(auto *joint : a.joints)
+		{
+			auto *ballSocket = dynamic_cast<IKBallSocketJoint*>(joint);
+			if (!ballSocket || GetOtherBone(*joint, a) != &b)
+				continue;
+			bool aFirst = ballSocket->m_connectionA == &a;
+			localAnchorA = aFirst ? ballSocket->LocalOffsetA : ballSocket->LocalOffsetB;
+			localAnchorB = aFirst ? ballSocket->LocalOffsetB : ballSocket->LocalOffsetA;
+			return true;
+		}
+		return false;
+	}
+
+    //Finds a hinge between the bones and gets its free axis along with the bone whose local space it is expressed in.
+	static bool FindHinge(const Bone &a, const Bone &b, const Bone *&axisBone, Vector3 &localAxis)
+	{
+		for(auto *joint : a.joints)
+		{
+			if (GetOtherBone(*joint, a) != &b)
+				continue;
+			if (auto *revolute = dynamic_cast<IKRevoluteJoint*>(joint))
+			{
+				axisBone = revolute->m_connectionA;
+				localAxis = revolute->GetLocalFreeAxisA();
+				return true;
+			}
+			if (auto *swivelHinge = dynamic_cast<IKSwivelHingeJoint*>(joint))
+			{
+				axisBone = swivelHinge->m_connectionA;
+				localAxis = swivelHinge->LocalHingeAxis;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static void SetPose(BoneStore &bones, BoneHandle handle, const Vector3 &position, const Quaternion &orientation)
+	{
+		bones.positions[handle] = position;
+		bones.SetOrientation(handle, orientation);
+		bones.bones[handle]->Position = position;
+		bones.bones[handle]->Orientation = orientation;
+	}
+
+	static Vector3 GetWorldPoint(const BoneStore &bones, BoneHandle handle, const Vector3 &localPoint)
+	{
+		return vector3::Add(bones.positions[handle], quaternion::Transform(localPoint, bones.orientations[handle]));
+	}
+}
+
+bool BEPUik::TwoBonePresolver::FindLimb(Control &control, const BoneStore &bones, Limb &limb)
+{
+    auto *motor = control.GetLinearMotor();
+    auto *target = control.GetTargetBone();
+    if (!motor || !target || target->store != &bones || target->joints.empty())
+        return false;
+
+    //The control either pulls on the lower bone of the limb directly, or on a leaf bone hanging off of its end.
+    //Either way, all joints of the target bone must lead to the same neighbour.
+    auto *neighbor = GetOtherBone(*target->joints.front(), *target);
+    if (!ConnectsOnlyTo(*target, neighbor, nullptr))
+        return false;
+    const Bone *lower = nullptr;
+    const Bone *upper = nullptr;
+    const Bone *carried = nullptr;
+    const Bone *hingeBone = nullptr;
+    Vector3 hingeAxis;
+    if (FindHinge(*target, *neighbor, hingeBone, hingeAxis))
+    {
+        lower = target;
+        upper = neighbor;
+    }
+    else
+    {
+		for(auto *joint : neighbor->joints)
+        {
+            auto *other = GetOtherBone(*joint, *neighbor);
+            if (other != target && FindHinge(*neighbor, *other, hingeBone, hingeAxis))
+            {
+                lower = neighbor;
+                upper = other;
+                carried = target;
+                break;
+            }
+        }
+        if (!lower || !ConnectsOnlyTo(*lower, upper, carried))
+            return false;
+    }
+
+    //The upper bone must hang off of exactly one other bone, which stays put.
+    const Bone *root = nullptr;
+	for(auto *joint : upper->joints)
+    {
+        auto *other = GetOtherBone(*joint, *upper);
+        if (other != lower)
+        {
+            root = other;
+            break;
+        }
+    }
+    if (!root || root == carried || !ConnectsOnlyTo(*upper, root, lower) || root->store != &bones)
+        return false;
+    if (!bones.IsIntegrated(upper->handle) || !bones.IsIntegrated(lower->handle) || (carried && !bones.IsIntegrated(carried->handle)))
+        return false;
+
+    limb.motor = motor;
+    limb.root = root->handle;
+    limb.upper = upper->handle;
+    limb.lower = lower->handle;
+    limb.carried = carried ? carried->handle : InvalidBoneHandle;
+    limb.hingeBone = hingeBone->handle;
+    limb.hingeAxis = hingeAxis;
+    if (!FindBallSocket(*root, *upper, limb.rootShoulder, limb.upperShoulder) || !FindBallSocket(*upper, *lower, limb.upperElbow, limb.lowerElbow))
+        return false;
+    if (carried)
+    {
+        if (!FindBallSocket(*lower, *carried, limb.lowerEnd, limb.carriedWrist))
+            return false;
+    }
+    else
+        limb.lowerEnd = motor->LocalOffset;
+    return true;
+}
+
+void BEPUik::TwoBonePresolver::PlaceLimb(const Limb &limb, BoneStore &bones)
+{
+    auto upperLength = vector3::Length(vector3::Subtract(limb.upperElbow, limb.upperShoulder));
+    auto lowerLength = vector3::Length(vector3::Subtract(limb.lowerEnd, limb.lowerElbow));
+    if (upperLength < Epsilon || lowerLength < Epsilon)
+        return;
+
+    //The end of the lower bone has to reach the goal. If the control pulls on a carried bone, the goal is shifted by the carried bone's offset from the wrist.
+    auto goal = limb.motor->TargetPosition;
+    if (limb.carried != InvalidBoneHandle)
+    {
+        auto targetPoint = GetWorldPoint(bones, limb.carried, limb.motor->LocalOffset);
+        auto wrist = GetWorldPoint(bones, limb.carried, limb.carriedWrist);
+        goal = vector3::Subtract(goal, vector3::Subtract(targetPoint, wrist));
+    }
+
+    auto shoulder = GetWorldPoint(bones, limb.root, limb.rootShoulder);
+    auto toGoal = vector3::Subtract(goal, shoulder);
+    auto goalDistance = vector3::Length(toGoal);
+    if (goalDistance < Epsilon)
+        return;
+    auto direction = vector3::Divide(toGoal, goalDistance);
+    //Keep a sliver of bend so the limb does not lock up straight or fold completely.
+    auto reach = std::clamp(goalDistance, std::abs(upperLength - lowerLength) * 1.001f, (upperLength + lowerLength) * 0.999f);
+
+    //Bend in the plane the limb is currently bent in. A straight limb bends around the elbow hinge instead.
+    auto elbow = GetWorldPoint(bones, limb.upper, limb.upperElbow);
+    auto bend = vector3::Subtract(elbow, shoulder);
+    bend = vector3::Subtract(bend, vector3::Multiply(direction, vector3::Dot(bend, direction)));
+    if (vector3::LengthSqr(bend) < 1e-6f * upperLength * upperLength)
+    {
+        auto hingeAxis = quaternion::Transform(limb.hingeAxis, bones.orientations[limb.hingeBone]);
+        bend = vector3::Cross(hingeAxis, direction);
+        if (vector3::LengthSqr(bend) < Epsilon)
+            return;
+    }
+    vector3::Normalize(bend);
+
+    //Law of cosines for the angle between the upper bone and the shoulder to goal line.
+    auto cosine = std::clamp((upperLength * upperLength + reach * reach - lowerLength * lowerLength) / (2 * upperLength * reach), -1.f, 1.f);
+    auto sine = std::sqrt(1 - cosine * cosine);
+    auto newElbow = vector3::Add(shoulder, vector3::Add(vector3::Multiply(direction, upperLength * cosine), vector3::Multiply(bend, upperLength * sine)));
+    auto newEnd = vector3::Add(shoulder, vector3::Multiply(direction, reach));
+
+    //Swing the upper bone onto the new elbow with the shortest rotation, carrying the lower bone along so their relative twist is kept.
+    auto upperShoulder = GetWorldPoint(bones, limb.upper, limb.upperShoulder);
+    auto upperDirection = vector3::Subtract(elbow, upperShoulder);
+    vector3::Normalize(upperDirection);
+    auto newUpperDirection = vector3::Subtract(newElbow, shoulder);
+    vector3::Normalize(newUpperDirection);
+    auto upperRotation = quaternion::GetQuaternionBetweenNormalizedVectors(upperDirection, newUpperDirection);
+    auto upperOrientation = quaternion::Concatenate(bones.orientations[limb.upper], upperRotation);
+    auto upperPosition = vector3::Subtract(shoulder, quaternion::Transform(limb.upperShoulder, upperOrientation));
+    auto lowerOrientation = quaternion::Concatenate(bones.orientations[limb.lower], upperRotation);
+
+    //Then swing the lower bone about the elbow onto the goal.
+    auto elbowAnchor = vector3::Add(upperPosition, quaternion::Transform(limb.upperElbow, upperOrientation));
+    auto lowerDirection = quaternion::Transform(vector3::Subtract(limb.lowerEnd, limb.lowerElbow), lowerOrientation);
+    vector3::Normalize(lowerDirection);
+    auto newLowerDirection = vector3::Subtract(newEnd, elbowAnchor);
+    vector3::Normalize(newLowerDirection);
+    lowerOrientation = quaternion::Concatenate(lowerOrientation, quaternion::GetQuaternionBetweenNormalizedVectors(lowerDirection, newLowerDirection));
+    auto lowerPosition = vector3::Subtract(elbowAnchor, quaternion::Transform(limb.lowerElbow, lowerOrientation));
+
+    if (limb.carried != InvalidBoneHandle)
+    {
+        //The carried bone keeps its orientation and follows the end of the lower bone.
+        auto wrist = GetWorldPoint(bones, limb.carried, limb.carriedWrist);
+        auto newWrist = vector3::Add(lowerPosition, quaternion::Transform(limb.lowerEnd, lowerOrientation));
+        SetPose(bones, limb.carried, vector3::Add(bones.positions[limb.carried], vector3::Subtract(newWrist, wrist)), bones.orientations[limb.carried]);
+    }
+    SetPose(bones, limb.upper, upperPosition, upperOrientation);
+    SetPose(bones, limb.lower, lowerPosition, lowerOrientation);
+}
+
+int BEPUik::TwoBonePresolver::Apply(const std::vector<Control*> &controls, BoneStore &bones)
+{
+    int placedCount = 0;
+    placedLowerBones.clear();
+	for(auto *control : controls)
+    {
+        Limb limb;
+        if (!FindLimb(*control, bones, limb))
+            continue;
+        //Several controls may pull on the same limb; only the first one places it.
+        if (std::find(placedLowerBones.begin(), placedLowerBones.end(), limb.lower) != placedLowerBones.end())
+            continue;
+        placedLowerBones.push_back(limb.lower);
+        PlaceLimb(limb, bones);
+        ++placedCount;
+    }
+    return placedCount;
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bepuik/WorkerGroup.hpp"
+#include <algorithm>
+
+BEPUik::WorkerGroup::WorkerGroup(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    m_threadCount = threadCount;
+    //Worker 0 is the thread calling ParallelFor.
+    m_threads.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i)
+        m_threads.emplace_back(&WorkerGroup::WorkerMain, this, i);
+}
+
+BEPUik::WorkerGroup::~WorkerGroup()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_startCondition.notify_all();
+	for(auto &thread : m_threads)
+        thread.join();
+}
+
+uint32_t BEPUik::WorkerGroup::GetThreadCount() const {return m_threadCount;}
+
+void BEPUik::WorkerGroup::ParallelFor(size_t count, const std::function<void(size_t begin, size_t end, uint32_t workerIndex)> &body)
+{
+    if (count == 0)
+        return;
+    //Not worth waking the other threads for a single element.
+    if (m_threads.empty() || count == 1)
+    {
+        body(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_exception = nullptr;
+        m_pendingThreads.store(static_cast<uint32_t>(m_threads.size()), std::memory_order_relaxed);
+        ++m_generation;
+    }
+    m_startCondition.notify_all();
+
+    RunRange(0);
+
+    //The ranges are short-lived; spin rather than paying for another round trip through the condition variable.
+    while (m_pendingThreads.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+
+    m_body = nullptr;
+    if (m_exception)
+    {
+        auto exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void BEPUik::WorkerGroup::RunRange(uint32_t workerIndex)
+{
+    auto begin = m_count * workerIndex / m_threadCount;
+    auto end = m_count * (workerIndex + 1) / m_threadCount;
+    if (begin == end)
+        return;
+    try
+    {
+        (*m_body)(begin, end, workerIndex);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_exception)
+            m_exception = std::current_exception();
+    }
+}
+
+void BEPUik::WorkerGroup::WorkerMain(uint32_t workerIndex)
+{
+    uint64_t generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, generation]() {return m_shutdown || m_generation != generation;});
+            if (m_shutdown)
+                return;
+            generation = m_generation;
+        }
+        RunRange(workerIndex);
+        m_pendingThreads.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
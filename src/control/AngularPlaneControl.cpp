@@ -23,12 +23,16 @@ void BEPUik::AngularPlaneControl::SetTargetBone(Bone *value) {
 	AngularMotor->TargetBone = value;
 }
 
-BEPUik::SingleBoneAngularPlaneConstraint *BEPUik::AngularPlaneControl::GetAngularMotor() {return AngularMotor.get();}
-void BEPUik::AngularPlaneControl::SetAngularMotor(std::unique_ptr<SingleBoneAngularPlaneConstraint> value) {AngularMotor = std::move(value);}
+BEPUik::SingleBoneAngularPlaneConstraint *BEPUik::AngularPlaneControl::GetAngularMotor() {return AngularMotor;}
+void BEPUik::AngularPlaneControl::SetAngularMotor(std::unique_ptr<SingleBoneAngularPlaneConstraint> value)
+{
+	m_customAngularMotor = std::move(value);
+	AngularMotor = m_customAngularMotor.get();
+}
 
 BEPUik::AngularPlaneControl::AngularPlaneControl()
 {
-    AngularMotor = std::make_unique<SingleBoneAngularPlaneConstraint>();
+    AngularMotor = &m_angularMotor;
     AngularMotor->Rigidity = 1;
 }
 
@@ -62,6 +66,11 @@ void BEPUik::AngularPlaneControl::ClearAccumulatedImpulses()
     AngularMotor->ClearAccumulatedImpulses();
 }
 
+void BEPUik::AngularPlaneControl::ScaleAccumulatedImpulses(float scale)
+{
+    AngularMotor->ScaleAccumulatedImpulses(scale);
+}
+
 float BEPUik::AngularPlaneControl::GetMaximumForce() const { return AngularMotor->MaximumForce; }
 void BEPUik::AngularPlaneControl::SetMaximumForce(float value)
 {
@@ -24,12 +24,16 @@ void BEPUik::DragControl::SetTargetBone(Bone* value)
 	LinearMotor->TargetBone = value;
 }
 
-BEPUik::SingleBoneLinearMotor* BEPUik::DragControl::GetLinearMotor() { return LinearMotor.get(); }
-void BEPUik::DragControl::SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value) { LinearMotor = std::move(value); }
+BEPUik::SingleBoneLinearMotor* BEPUik::DragControl::GetLinearMotor() { return LinearMotor; }
+void BEPUik::DragControl::SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value)
+{
+	m_customLinearMotor = std::move(value);
+	LinearMotor = m_customLinearMotor.get();
+}
 
 BEPUik::DragControl::DragControl()
 {
-	LinearMotor = std::make_unique<SingleBoneLinearMotor>();
+	LinearMotor = &m_linearMotor;
 	LinearMotor->Rigidity = 1;
 }
 
@@ -63,6 +67,11 @@ void BEPUik::DragControl::ClearAccumulatedImpulses()
 	LinearMotor->ClearAccumulatedImpulses();
 }
 
+void BEPUik::DragControl::ScaleAccumulatedImpulses(float scale)
+{
+	LinearMotor->ScaleAccumulatedImpulses(scale);
+}
+
 float BEPUik::DragControl::GetMaximumForce() const { return LinearMotor->MaximumForce; }
 void BEPUik::DragControl::SetMaximumForce(float value) { LinearMotor->MaximumForce = value; }
 
@@ -77,3 +86,9 @@ void BEPUik::OrientedDragControl::ClearAccumulatedImpulses()
 	DragControl::ClearAccumulatedImpulses();
 	GetTargetBone()->Orientation = m_targetOrientation;
 }
+
+void BEPUik::OrientedDragControl::ScaleAccumulatedImpulses(float scale)
+{
+	DragControl::ScaleAccumulatedImpulses(scale);
+	GetTargetBone()->Orientation = m_targetOrientation;
+}
@@ -23,12 +23,16 @@ void BEPUik::RevoluteControl::SetTargetBone(Bone *value)
     AngularMotor->TargetBone = value;
 }
 
-BEPUik::SingleBoneRevoluteConstraint *BEPUik::RevoluteControl::GetAngularMotor() {return AngularMotor.get();}
-void BEPUik::RevoluteControl::SetAngularMotor(std::unique_ptr<SingleBoneRevoluteConstraint> value) {AngularMotor = std::move(value);}
+BEPUik::SingleBoneRevoluteConstraint *BEPUik::RevoluteControl::GetAngularMotor() {return AngularMotor;}
+void BEPUik::RevoluteControl::SetAngularMotor(std::unique_ptr<SingleBoneRevoluteConstraint> value)
+{
+	m_customAngularMotor = std::move(value);
+	AngularMotor = m_customAngularMotor.get();
+}
 
 BEPUik::RevoluteControl::RevoluteControl()
 {
-    AngularMotor = std::make_unique<SingleBoneRevoluteConstraint>();
+    AngularMotor = &m_angularMotor;
     AngularMotor->Rigidity = 1;
 }
 
@@ -62,6 +66,11 @@ void BEPUik::RevoluteControl::ClearAccumulatedImpulses()
     AngularMotor->ClearAccumulatedImpulses();
 }
 
+void BEPUik::RevoluteControl::ScaleAccumulatedImpulses(float scale)
+{
+    AngularMotor->ScaleAccumulatedImpulses(scale);
+}
+
 float BEPUik::RevoluteControl::GetMaximumForce() const { return AngularMotor->MaximumForce; }
 void BEPUik::RevoluteControl::SetMaximumForce(float value)
 {
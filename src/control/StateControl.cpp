@@ -28,16 +28,24 @@ void BEPUik::StateControl::SetTargetBone(Bone* value)
 		AngularMotor->TargetOrientation = value->Orientation;
 }
 
-BEPUik::SingleBoneLinearMotor* BEPUik::StateControl::GetLinearMotor() { return LinearMotor.get(); }
-void BEPUik::StateControl::SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value) { LinearMotor = std::move(value); }
+BEPUik::SingleBoneLinearMotor* BEPUik::StateControl::GetLinearMotor() { return LinearMotor; }
+void BEPUik::StateControl::SetLinearMotor(std::unique_ptr<SingleBoneLinearMotor> value)
+{
+	m_customLinearMotor = std::move(value);
+	LinearMotor = m_customLinearMotor.get();
+}
 
-BEPUik::SingleBoneAngularMotor* BEPUik::StateControl::GetAngularMotor() { return AngularMotor.get(); }
-void BEPUik::StateControl::SetAngularMotor(std::unique_ptr<SingleBoneAngularMotor> value) { AngularMotor = std::move(value); }
+BEPUik::SingleBoneAngularMotor* BEPUik::StateControl::GetAngularMotor() { return AngularMotor; }
+void BEPUik::StateControl::SetAngularMotor(std::unique_ptr<SingleBoneAngularMotor> value)
+{
+	m_customAngularMotor = std::move(value);
+	AngularMotor = m_customAngularMotor.get();
+}
 
 BEPUik::StateControl::StateControl()
 {
-	LinearMotor = std::make_unique<SingleBoneLinearMotor>();
-	AngularMotor = std::make_unique<SingleBoneAngularMotor>();
+	LinearMotor = &m_linearMotor;
+	AngularMotor = &m_angularMotor;
 	LinearMotor->Rigidity = 1;
 	AngularMotor->Rigidity = 1;
 }
@@ -79,6 +87,12 @@ void BEPUik::StateControl::ClearAccumulatedImpulses()
 	AngularMotor->ClearAccumulatedImpulses();
 }
 
+void BEPUik::StateControl::ScaleAccumulatedImpulses(float scale)
+{
+	LinearMotor->ScaleAccumulatedImpulses(scale);
+	AngularMotor->ScaleAccumulatedImpulses(scale);
+}
+
 float BEPUik::StateControl::GetMaximumForce() const { return LinearMotor->MaximumForce; }
 void BEPUik::StateControl::SetMaximumForce(float value)
 {
@@ -25,33 +25,35 @@ BEPUik::IKAngularJoint::IKAngularJoint(Bone &connectionA, Bone &connectionB)
 
 }
 
-void BEPUik::IKAngularJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKAngularJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
-	linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
-    angularJacobianA = matrix::Create(1.f);
-    angularJacobianB = matrix::Create(-1.f);
+    const auto &orientationA = bones.orientations[handleA];
+    const auto &orientationB = bones.orientations[handleB];
+	jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
+    jacobians.angularA = matrix::Create(1.f);
+    jacobians.angularB = matrix::Create(-1.f);
 
     //The error is computed using this equation:
-    //GoalRelativeOrientation * m_connectionA->Orientation * Error = m_connectionB->Orientation
+    //GoalRelativeOrientation * orientationA * Error = orientationB
     //GoalRelativeOrientation is the original rotation from A to B in A's local space.
     //Multiplying by A's orientation gives us where B *should* be.
     //Of course, B won't be exactly where it should be after initialization.
     //The Error component holds the difference between what is and what should be.
-    //Error = (GoalRelativeOrientation * m_connectionA->Orientation)^-1 * m_connectionB->Orientation
-    Quaternion bTarget = quaternion::Concatenate(GoalRelativeOrientation, m_connectionA->Orientation);
+    //Error = (GoalRelativeOrientation * orientationA)^-1 * orientationB
+    Quaternion bTarget = quaternion::Concatenate(GoalRelativeOrientation, orientationA);
     Quaternion bTargetConjugate = BEPUik::quaternion::Conjugate(bTarget);
 
-    Quaternion error = quaternion::Concatenate(bTargetConjugate, m_connectionB->Orientation);
+    Quaternion error = quaternion::Concatenate(bTargetConjugate, orientationB);
 
     //Convert the error into an axis-angle vector usable for bias velocity.
     float angle;
     Vector3 axis;
     BEPUik::quaternion::GetAxisAngleFromQuaternion(error, axis, angle);
 
-    velocityBias.x = errorCorrectionFactor * axis.x * angle;
-    velocityBias.y = errorCorrectionFactor * axis.y * angle;
-    velocityBias.z = errorCorrectionFactor * axis.z * angle;
+    jacobians.velocityBias.x = errorCorrectionFactor * axis.x * angle;
+    jacobians.velocityBias.y = errorCorrectionFactor * axis.y * angle;
+    jacobians.velocityBias.z = errorCorrectionFactor * axis.z * angle;
 
 
 }
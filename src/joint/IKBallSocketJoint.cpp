@@ -39,25 +39,29 @@ BEPUik::IKBallSocketJoint::IKBallSocketJoint(Bone &connectionA, Bone &connection
     SetOffsetB(vector3::Subtract(anchor, m_connectionB->Position));
 }
 
-void BEPUik::IKBallSocketJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKBallSocketJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
-	linearJacobianA = matrix::GetIdentity();
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
+	jacobians.linearA = matrix::GetIdentity();
     //The jacobian entries are is [ La, Aa, -Lb, -Ab ] because the relative velocity is computed using A-B. So, negate B's jacobians!
-	linearJacobianB = matrix::Create(-1.f);
-    Vector3 rA = quaternion::Transform(LocalOffsetA, m_connectionA->Orientation);
-    angularJacobianA = matrix::CreateCrossProduct(rA);
+	jacobians.linearB = matrix::Create(-1.f);
+    Vector3 rA = matrix::Transform(LocalOffsetA, rotationA);
+    jacobians.angularA = matrix::CreateCrossProduct(rA);
     //Transposing a skew-symmetric matrix is equivalent to negating it.
-    angularJacobianA = matrix::Transpose(angularJacobianA);
+    jacobians.angularA = matrix::Transpose(jacobians.angularA);
 
-    Vector3 worldPositionA = vector3::Add(m_connectionA->Position, rA);
+    Vector3 worldPositionA = vector3::Add(positionA, rA);
 
-    Vector3 rB = quaternion::Transform(LocalOffsetB, m_connectionB->Orientation);
-    angularJacobianB = matrix::CreateCrossProduct(rB);
+    Vector3 rB = matrix::Transform(LocalOffsetB, rotationB);
+    jacobians.angularB = matrix::CreateCrossProduct(rB);
 
     Vector3 worldPositionB;
-    worldPositionB = vector3::Add(m_connectionB->Position, rB);
+    worldPositionB = vector3::Add(positionB, rB);
 
     Vector3 linearError = vector3::Subtract(worldPositionB, worldPositionA);
-    velocityBias = vector3::Multiply(linearError, errorCorrectionFactor);
+    jacobians.velocityBias = vector3::Multiply(linearError, errorCorrectionFactor);
 
 }
\ No newline at end of file
@@ -33,20 +33,24 @@ float BEPUik::IKDistanceJoint::GetDistance() const { return distance; }
 void BEPUik::IKDistanceJoint::SetDistance(float value) { distance = std::max(0.f, value); }
 
 BEPUik::IKDistanceJoint::IKDistanceJoint(Bone &connectionA, Bone &connectionB, const Vector3 &anchorA, const Vector3 &anchorB)
-    : IKJoint(connectionA, connectionB)
+    : IKJoint(connectionA, connectionB, 1)
 {
 	SetAnchorA(anchorA);
 	SetAnchorB(anchorB);
     SetDistance(vector3::Distance(anchorA, anchorB));
 }
 
-void BEPUik::IKDistanceJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKDistanceJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
     //Transform the anchors and offsets into world space.
-    Vector3 offsetA = quaternion::Transform(LocalAnchorA, m_connectionA->Orientation);
-    Vector3 offsetB = quaternion::Transform(LocalAnchorB, m_connectionB->Orientation);
-    Vector3 anchorA = vector3::Add(m_connectionA->Position, offsetA);
-    Vector3 anchorB = vector3::Add(m_connectionB->Position, offsetB);
+    Vector3 offsetA = matrix::Transform(LocalAnchorA, rotationA);
+    Vector3 offsetB = matrix::Transform(LocalAnchorB, rotationB);
+    Vector3 anchorA = vector3::Add(positionA, offsetA);
+    Vector3 anchorB = vector3::Add(positionB, offsetB);
 
     //Compute the distance.
     Vector3 separation = vector3::Subtract(anchorB, anchorA);
@@ -60,11 +64,11 @@ void BEPUik::IKDistanceJoint::UpdateJacobiansAndVelocityBias()
         linearA.y = separation.y / currentDistance;
         linearA.z = separation.z / currentDistance;
 
-        velocityBias = Vector3(errorCorrectionFactor * (currentDistance - distance), 0, 0);
+        jacobians.velocityBias = Vector3(errorCorrectionFactor * (currentDistance - distance), 0, 0);
     }
     else
     {
-        velocityBias = vector3::Create();
+        jacobians.velocityBias = vector3::Create();
         linearA = vector3::Create();
     }
 
@@ -73,21 +77,21 @@ void BEPUik::IKDistanceJoint::UpdateJacobiansAndVelocityBias()
     Vector3 angularB = vector3::Cross(linearA, offsetB);
 
     //Put all the 1x3 jacobians into a 3x3 matrix representation.
-	linearJacobianA = matrix::Create();
-	linearJacobianA[0][0] = linearA.x;
-	linearJacobianA[0][1] = linearA.y;
-	linearJacobianA[0][2] = linearA.z;
-	linearJacobianB = matrix::Create();
-	linearJacobianB[0][0] = -linearA.x;
-	linearJacobianB[0][1] = -linearA.y;
-	linearJacobianB[0][2] = -linearA.z;
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = angularA.x;
-	angularJacobianA[0][1] = angularA.y;
-	angularJacobianA[0][2] = angularA.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = angularB.x;
-	angularJacobianB[0][1] = angularB.y;
-	angularJacobianB[0][2] = angularB.z;
+	jacobians.linearA = matrix::Create();
+	jacobians.linearA[0][0] = linearA.x;
+	jacobians.linearA[0][1] = linearA.y;
+	jacobians.linearA[0][2] = linearA.z;
+	jacobians.linearB = matrix::Create();
+	jacobians.linearB[0][0] = -linearA.x;
+	jacobians.linearB[0][1] = -linearA.y;
+	jacobians.linearB[0][2] = -linearA.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = angularA.x;
+	jacobians.angularA[0][1] = angularA.y;
+	jacobians.angularA[0][2] = angularA.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = angularB.x;
+	jacobians.angularB[0][1] = angularB.y;
+	jacobians.angularB[0][2] = angularB.z;
 
 }
@@ -14,6 +14,8 @@
 // limitations under the License.
 
 #include "bepuik/joint/IKJoint.hpp"
+#include "JointKernels.hpp"
+#include <cassert>
 
 BEPUik::Bone *BEPUik::IKJoint::GetConnectionA() {return m_connectionA;}
 BEPUik::Bone* BEPUik::IKJoint::GetConnectionB() {return m_connectionB;}
@@ -32,55 +34,93 @@ void BEPUik::IKJoint::SetEnabled(bool value)
 		m_connectionA->joints.push_back(this);
 		m_connectionB->joints.push_back(this);
     }
+    if (m_enabled != value)
+    {
+        ++m_connectionA->topologyVersion;
+        ++m_connectionB->topologyVersion;
+    }
     m_enabled = value;
 }
 
-BEPUik::IKJoint::IKJoint(Bone &connectionA, Bone &connectionB)
+BEPUik::IKJoint::IKJoint(Bone &connectionA, Bone &connectionB, int degreesOfFreedom)
 {
+    if (degreesOfFreedom < 1 || degreesOfFreedom > 3)
+        throw std::invalid_argument("Joints must have between 1 and 3 degrees of freedom.");
     m_connectionA = &connectionA;
     m_connectionB = &connectionB;
+    m_degreesOfFreedom = degreesOfFreedom;
     SetEnabled(true);
 }
 
+int BEPUik::IKJoint::GetDegreesOfFreedom() const {return m_degreesOfFreedom;}
+
+void BEPUik::IKJoint::BindBoneStore()
+{
+    m_boneStore = m_connectionA->store;
+    m_handleA = m_connectionA->handle;
+    m_handleB = m_connectionB->handle;
+}
+
+void BEPUik::IKJoint::ComputeJacobians([[maybe_unused]] const BoneStore &bones, [[maybe_unused]] BoneHandle handleA, [[maybe_unused]] BoneHandle handleB, JointJacobians &jacobians) const
+{
+    //Fallback for custom joints that predate ComputeJacobians and compute their jacobians in UpdateJacobiansAndVelocityBias.
+    assert(&bones == m_boneStore && handleA == m_handleA && handleB == m_handleB);
+    const_cast<IKJoint*>(this)->UpdateJacobiansAndVelocityBias();
+    jacobians.linearA = linearJacobianA;
+    jacobians.angularA = angularJacobianA;
+    jacobians.linearB = linearJacobianB;
+    jacobians.angularB = angularJacobianB;
+    jacobians.velocityBias = velocityBias;
+}
+
+void BEPUik::IKJoint::UpdateJacobiansAndVelocityBias()
+{
+    JointJacobians jacobians;
+    ComputeJacobians(*m_boneStore, m_handleA, m_handleB, jacobians);
+    linearJacobianA = jacobians.linearA;
+    angularJacobianA = jacobians.angularA;
+    linearJacobianB = jacobians.linearB;
+    angularJacobianB = jacobians.angularB;
+    velocityBias = jacobians.velocityBias;
+}
+
 void BEPUik::IKJoint::ComputeEffectiveMass()
 {
+    //Joints with fewer degrees of freedom only fill the leading jacobian rows; skip the zero rows and invert a scalar or 2x2 instead.
+    if (m_degreesOfFreedom == 1)
+    {
+        jointkernels::ComputeJointEffectiveMass<1>(*this);
+        return;
+    }
+    if (m_degreesOfFreedom == 2)
+    {
+        jointkernels::ComputeJointEffectiveMass<2>(*this);
+        return;
+    }
+
     //For all constraints, the effective mass matrix is 1 / (J * M^-1 * JT).
     //For two bone constraints, J has 4 3x3 matrices. M^-1 (W below) is a 12x12 matrix with 4 3x3 block diagonal matrices.
     //To compute the whole denominator,
+    //Pinned bones are stored with zero inverse mass and inertia, so they contribute nothing to the denominator.
+    auto &bones = *m_boneStore;
     Matrix3x3 linearW;
     Matrix3x3 linearA, angularA, linearB, angularB;
 
-    if (!m_connectionA->Pinned)
-    {
-        linearW = matrix::CreateScale(m_connectionA->inverseMass);
-        linearA = matrix::Multiply(linearJacobianA, linearW); //Compute J * M^-1 for linear component
-        linearA = matrix::MultiplyByTransposed(linearA, linearJacobianA); //Compute (J * M^-1) * JT for linear component
+    linearW = matrix::CreateScale(bones.inverseMasses[m_handleA]);
+    linearA = matrix::Multiply(linearJacobianA, linearW); //Compute J * M^-1 for linear component
+    linearA = matrix::MultiplyByTransposed(linearA, linearJacobianA); //Compute (J * M^-1) * JT for linear component
 
-        angularA = matrix::Multiply(angularJacobianA, m_connectionA->inertiaTensorInverse); //Compute J * M^-1 for angular component
-        angularA = matrix::MultiplyByTransposed(angularA, angularJacobianA); //Compute (J * M^-1) * JT for angular component
-    }
-    else
-    {
-        //Treat pinned bones as if they have infinite inertia.
-        linearA = matrix::Create();
-        angularA = matrix::Create();
-    }
+    for (int i = 0; i < 3; ++i)
+        angularA[i] = bones.TransformByInertiaTensorInverse(m_handleA, angularJacobianA[i]); //Compute J * M^-1 for angular component
+    angularA = matrix::MultiplyByTransposed(angularA, angularJacobianA); //Compute (J * M^-1) * JT for angular component
 
-    if (!m_connectionB->Pinned)
-    {
-        linearW = matrix::CreateScale(m_connectionB->inverseMass);
-        linearB = matrix::Multiply(linearJacobianB, linearW); //Compute J * M^-1 for linear component
-        linearB = matrix::MultiplyByTransposed(linearB, linearJacobianB); //Compute (J * M^-1) * JT for linear component
+    linearW = matrix::CreateScale(bones.inverseMasses[m_handleB]);
+    linearB = matrix::Multiply(linearJacobianB, linearW); //Compute J * M^-1 for linear component
+    linearB = matrix::MultiplyByTransposed(linearB, linearJacobianB); //Compute (J * M^-1) * JT for linear component
 
-        angularB = matrix::Multiply(angularJacobianB, m_connectionB->inertiaTensorInverse); //Compute J * M^-1 for angular component
-        angularB = matrix::MultiplyByTransposed(angularB, angularJacobianB); //Compute (J * M^-1) * JT for angular component
-    }
-    else
-    {
-        //Treat pinned bones as if they have infinite inertia.
-        linearB = matrix::Create();
-        angularB = matrix::Create();
-    }
+    for (int i = 0; i < 3; ++i)
+        angularB[i] = bones.TransformByInertiaTensorInverse(m_handleB, angularJacobianB[i]); //Compute J * M^-1 for angular component
+    angularB = matrix::MultiplyByTransposed(angularB, angularJacobianB); //Compute (J * M^-1) * JT for angular component
 
     //A nice side effect of the block diagonal nature of M^-1 is that the above separated components are now combined into the complete denominator matrix by addition!
     effectiveMass = matrix::Add(linearA, angularA);
@@ -107,42 +147,61 @@ void BEPUik::IKJoint::WarmStart()
     //(where P is the impulse, JT is the transposed jacobian matrix, and lambda is the accumulated impulse).
     //Recall the jacobian takes impulses from world space into constraint space, and transpose takes them from constraint space into world space.
 
-    Vector3 impulse;
-    if (!m_connectionA->Pinned) //Treat pinned elements as if they have infinite inertia.
+    if (m_degreesOfFreedom == 1)
     {
-        //Compute and apply linear impulse for A.
-        impulse = matrix::Transform(accumulatedImpulse, linearJacobianA);
-        m_connectionA->ApplyLinearImpulse(impulse);
-
-        //Compute and apply angular impulse for A.
-        impulse = matrix::Transform(accumulatedImpulse, angularJacobianA);
-        m_connectionA->ApplyAngularImpulse(impulse);
+        jointkernels::WarmStartJoint<1>(*this);
+        return;
     }
-
-    if (!m_connectionB->Pinned) //Treat pinned elements as if they have infinite inertia.
+    if (m_degreesOfFreedom == 2)
     {
-        //Compute and apply linear impulse for B.
-        impulse = matrix::Transform(accumulatedImpulse, linearJacobianB);
-        m_connectionB->ApplyLinearImpulse(impulse);
-
-        //Compute and apply angular impulse for B.
-        impulse = matrix::Transform(accumulatedImpulse, angularJacobianB);
-        m_connectionB->ApplyAngularImpulse(impulse);
+        jointkernels::WarmStartJoint<2>(*this);
+        return;
     }
+
+    //Pinned bones have zero inverse mass and inertia in the store, so applying impulses to them does nothing.
+    auto &bones = *m_boneStore;
+    Vector3 impulse;
+    //Compute and apply linear impulse for A.
+    impulse = matrix::Transform(accumulatedImpulse, linearJacobianA);
+    bones.ApplyLinearImpulse(m_handleA, impulse);
+
+    //Compute and apply angular impulse for A.
+    impulse = matrix::Transform(accumulatedImpulse, angularJacobianA);
+    bones.ApplyAngularImpulse(m_handleA, impulse);
+
+    //Compute and apply linear impulse for B.
+    impulse = matrix::Transform(accumulatedImpulse, linearJacobianB);
+    bones.ApplyLinearImpulse(m_handleB, impulse);
+
+    //Compute and apply angular impulse for B.
+    impulse = matrix::Transform(accumulatedImpulse, angularJacobianB);
+    bones.ApplyAngularImpulse(m_handleB, impulse);
 }
 
 void BEPUik::IKJoint::SolveVelocityIteration()
 {
+    if (m_degreesOfFreedom == 1)
+    {
+        jointkernels::SolveJointVelocityIteration<1, false>(*this);
+        return;
+    }
+    if (m_degreesOfFreedom == 2)
+    {
+        jointkernels::SolveJointVelocityIteration<2, false>(*this);
+        return;
+    }
+
     //Compute the 'relative' linear and angular velocities. For single bone constraints, it's based entirely on the one bone's velocities!
     //They have to be pulled into constraint space first to compute the necessary impulse, though.
+    auto &bones = *m_boneStore;
     Vector3 linearContributionA;
-    linearContributionA = matrix::TransformTranspose(m_connectionA->linearVelocity, linearJacobianA);
+    linearContributionA = matrix::TransformTranspose(bones.linearVelocities[m_handleA], linearJacobianA);
     Vector3 angularContributionA;
-    angularContributionA = matrix::TransformTranspose(m_connectionA->angularVelocity, angularJacobianA);
+    angularContributionA = matrix::TransformTranspose(bones.angularVelocities[m_handleA], angularJacobianA);
     Vector3 linearContributionB;
-    linearContributionB = matrix::TransformTranspose(m_connectionB->linearVelocity, linearJacobianB);
+    linearContributionB = matrix::TransformTranspose(bones.linearVelocities[m_handleB], linearJacobianB);
     Vector3 angularContributionB;
-    angularContributionB = matrix::TransformTranspose(m_connectionB->angularVelocity, angularJacobianB);
+    angularContributionB = matrix::TransformTranspose(bones.angularVelocities[m_handleB], angularJacobianB);
 
     //The constraint velocity error will be the velocity we try to remove.
     Vector3 constraintVelocityError;
@@ -179,28 +238,21 @@ void BEPUik::IKJoint::SolveVelocityIteration()
 
     //The constraint space impulse now represents the impulse we want to apply to the bone... but in constraint space.
     //Bring it to world space using the transposed jacobian.
-    if (!m_connectionA->Pinned)//Treat pinned elements as if they have infinite inertia.
-    {
-        Vector3 linearImpulseA;
-        linearImpulseA = matrix::Transform(constraintSpaceImpulse, linearJacobianA);
-        Vector3 angularImpulseA;
-        angularImpulseA = matrix::Transform(constraintSpaceImpulse, angularJacobianA);
-
-        //Apply them!
-        m_connectionA->ApplyLinearImpulse(linearImpulseA);
-        m_connectionA->ApplyAngularImpulse(angularImpulseA);
-    }
-    if (!m_connectionB->Pinned)//Treat pinned elements as if they have infinite inertia.
-    {
-        Vector3 linearImpulseB;
-        linearImpulseB = matrix::Transform(constraintSpaceImpulse, linearJacobianB);
-        Vector3 angularImpulseB;
-        angularImpulseB = matrix::Transform(constraintSpaceImpulse, angularJacobianB);
-
-        //Apply them!
-        m_connectionB->ApplyLinearImpulse(linearImpulseB);
-        m_connectionB->ApplyAngularImpulse(angularImpulseB);
-    }
+    //Pinned bones have zero inverse mass and inertia in the store, so applying impulses to them does nothing.
+    Vector3 linearImpulseA;
+    linearImpulseA = matrix::Transform(constraintSpaceImpulse, linearJacobianA);
+    Vector3 angularImpulseA;
+    angularImpulseA = matrix::Transform(constraintSpaceImpulse, angularJacobianA);
+    Vector3 linearImpulseB;
+    linearImpulseB = matrix::Transform(constraintSpaceImpulse, linearJacobianB);
+    Vector3 angularImpulseB;
+    angularImpulseB = matrix::Transform(constraintSpaceImpulse, angularJacobianB);
+
+    //Apply them!
+    bones.ApplyLinearImpulse(m_handleA, linearImpulseA);
+    bones.ApplyAngularImpulse(m_handleA, angularImpulseA);
+    bones.ApplyLinearImpulse(m_handleB, linearImpulseB);
+    bones.ApplyAngularImpulse(m_handleB, angularImpulseB);
 
 }
 
@@ -64,7 +64,7 @@ void BEPUik::IKPointOnLineJoint::ComputeRestrictedAxes()
 }
 
 BEPUik::IKPointOnLineJoint::IKPointOnLineJoint(Bone &connectionA, Bone &connectionB, const Vector3 &lineAnchor, const Vector3 &lineDirection, const Vector3 &anchorB)
-: IKJoint(connectionA, connectionB)
+: IKJoint(connectionA, connectionB, 2)
 {
 	SetLineAnchor(lineAnchor);
 	SetLineDirection(lineDirection);
@@ -72,24 +72,28 @@ BEPUik::IKPointOnLineJoint::IKPointOnLineJoint(Bone &connectionA, Bone &connecti
 
 }
 
-void BEPUik::IKPointOnLineJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKPointOnLineJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
 
 	//Transform local stuff into world space
 	Vector3 worldRestrictedAxis1, worldRestrictedAxis2;
-	worldRestrictedAxis1 = quaternion::Transform(localRestrictedAxis1, m_connectionA->Orientation);
-	worldRestrictedAxis2 = quaternion::Transform(localRestrictedAxis2, m_connectionA->Orientation);
+	worldRestrictedAxis1 = matrix::Transform(localRestrictedAxis1, rotationA);
+	worldRestrictedAxis2 = matrix::Transform(localRestrictedAxis2, rotationA);
 
 	Vector3 worldLineAnchor;
-	worldLineAnchor = quaternion::Transform(LocalLineAnchor, m_connectionA->Orientation);
-	worldLineAnchor = vector3::Add(worldLineAnchor, m_connectionA->Position);
+	worldLineAnchor = matrix::Transform(LocalLineAnchor, rotationA);
+	worldLineAnchor = vector3::Add(worldLineAnchor, positionA);
 	Vector3 lineDirection;
-	lineDirection = quaternion::Transform(localLineDirection, m_connectionA->Orientation);
+	lineDirection = matrix::Transform(localLineDirection, rotationA);
 
 	Vector3 rB;
-	rB = quaternion::Transform(LocalAnchorB, m_connectionB->Orientation);
+	rB = matrix::Transform(LocalAnchorB, rotationB);
 	Vector3 worldPoint;
-	worldPoint = vector3::Add(rB, m_connectionB->Position);
+	worldPoint = vector3::Add(rB, positionB);
 
 	//Find the point on the line closest to the world point.
 	Vector3 offset;
@@ -101,7 +105,7 @@ void BEPUik::IKPointOnLineJoint::UpdateJacobiansAndVelocityBias()
 	offset = vector3::Multiply(lineDirection, distanceAlongAxis);
 	worldNearPoint = vector3::Add(worldLineAnchor, offset);
 	Vector3 rA;
-	rA = vector3::Subtract(worldNearPoint, m_connectionA->Position);
+	rA = vector3::Subtract(worldNearPoint, positionA);
 
 	//Error
 	Vector3 error3D;
@@ -111,8 +115,8 @@ void BEPUik::IKPointOnLineJoint::UpdateJacobiansAndVelocityBias()
 	error.x = vector3::Dot(error3D, worldRestrictedAxis1);
 	error.y = vector3::Dot(error3D, worldRestrictedAxis2);
 
-	velocityBias.x = errorCorrectionFactor * error.x;
-	velocityBias.y = errorCorrectionFactor * error.y;
+	jacobians.velocityBias.x = errorCorrectionFactor * error.x;
+	jacobians.velocityBias.y = errorCorrectionFactor * error.y;
 
 
 	//Set up the jacobians
@@ -123,28 +127,28 @@ void BEPUik::IKPointOnLineJoint::UpdateJacobiansAndVelocityBias()
 	angularB2 = vector3::Cross(worldRestrictedAxis2, rB);
 
 	//Put all the 1x3 jacobians into a 3x3 matrix representation.
-	linearJacobianA = matrix::Create();
-	linearJacobianA[0][0] = worldRestrictedAxis1.x;
-	linearJacobianA[0][1] = worldRestrictedAxis1.y;
-	linearJacobianA[0][2] = worldRestrictedAxis1.z;
-	linearJacobianA[1][0] = worldRestrictedAxis2.x;
-	linearJacobianA[1][1] = worldRestrictedAxis2.y;
-	linearJacobianA[1][2] = worldRestrictedAxis2.z;
-	linearJacobianB = matrix::Negate(linearJacobianA);
-
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = angularA1.x;
-	angularJacobianA[0][1] = angularA1.y;
-	angularJacobianA[0][2] = angularA1.z;
-	angularJacobianA[1][0] = angularA2.x;
-	angularJacobianA[1][1] = angularA2.y;
-	angularJacobianA[1][2] = angularA2.z;
-
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = angularB1.x;
-	angularJacobianB[0][1] = angularB1.y;
-	angularJacobianB[0][2] = angularB1.z;
-	angularJacobianB[1][0] = angularB2.x;
-	angularJacobianB[1][1] = angularB2.y;
-	angularJacobianB[1][2] = angularB2.z;
+	jacobians.linearA = matrix::Create();
+	jacobians.linearA[0][0] = worldRestrictedAxis1.x;
+	jacobians.linearA[0][1] = worldRestrictedAxis1.y;
+	jacobians.linearA[0][2] = worldRestrictedAxis1.z;
+	jacobians.linearA[1][0] = worldRestrictedAxis2.x;
+	jacobians.linearA[1][1] = worldRestrictedAxis2.y;
+	jacobians.linearA[1][2] = worldRestrictedAxis2.z;
+	jacobians.linearB = matrix::Negate(jacobians.linearA);
+
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = angularA1.x;
+	jacobians.angularA[0][1] = angularA1.y;
+	jacobians.angularA[0][2] = angularA1.z;
+	jacobians.angularA[1][0] = angularA2.x;
+	jacobians.angularA[1][1] = angularA2.y;
+	jacobians.angularA[1][2] = angularA2.z;
+
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = angularB1.x;
+	jacobians.angularB[0][1] = angularB1.y;
+	jacobians.angularB[0][2] = angularB1.z;
+	jacobians.angularB[1][0] = angularB2.x;
+	jacobians.angularB[1][1] = angularB2.y;
+	jacobians.angularB[1][2] = angularB2.z;
 }
\ No newline at end of file
@@ -25,23 +25,27 @@ BEPUik::Vector3 BEPUik::IKPointOnPlaneJoint::GetAnchorB() const { return vector3
 void BEPUik::IKPointOnPlaneJoint::SetAnchorB(const Vector3 &value) { LocalAnchorB = quaternion::Transform(vector3::Subtract(value, m_connectionB->Position), BEPUik::quaternion::Conjugate(m_connectionB->Orientation)); }
 
 BEPUik::IKPointOnPlaneJoint::IKPointOnPlaneJoint(Bone &connectionA, Bone &connectionB, const Vector3 &planeAnchor, const Vector3 &planeNormal, const Vector3 &anchorB)
-    : IKJoint(connectionA, connectionB)
+    : IKJoint(connectionA, connectionB, 1)
 {
     SetPlaneAnchor(planeAnchor);
     SetPlaneNormal(planeNormal);
     SetAnchorB(anchorB);
 }
 
-void BEPUik::IKPointOnPlaneJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKPointOnPlaneJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
     //Transform the anchors and offsets into world space.
     Vector3 offsetA, offsetB, lineDirection;
-    offsetA = quaternion::Transform(LocalPlaneAnchor, m_connectionA->Orientation);
-    lineDirection = quaternion::Transform(LocalPlaneNormal, m_connectionA->Orientation);
-    offsetB = quaternion::Transform(LocalAnchorB, m_connectionB->Orientation);
+    offsetA = matrix::Transform(LocalPlaneAnchor, rotationA);
+    lineDirection = matrix::Transform(LocalPlaneNormal, rotationA);
+    offsetB = matrix::Transform(LocalAnchorB, rotationB);
     Vector3 anchorA, anchorB;
-    anchorA = vector3::Add(m_connectionA->Position, offsetA);
-    anchorB = vector3::Add(m_connectionB->Position, offsetB);
+    anchorA = vector3::Add(positionA, offsetA);
+    anchorB = vector3::Add(positionB, offsetB);
 
     //Compute the distance.
     Vector3 separation;
@@ -49,33 +53,33 @@ void BEPUik::IKPointOnPlaneJoint::UpdateJacobiansAndVelocityBias()
     //This entire constraint is very similar to the IKDistanceLimit, except the current distance is along an axis.
     float currentDistance;
     currentDistance = vector3::Dot(separation, lineDirection);
-    velocityBias = Vector3(errorCorrectionFactor * currentDistance, 0, 0);
+    jacobians.velocityBias = Vector3(errorCorrectionFactor * currentDistance, 0, 0);
 
     //Compute jacobians
     Vector3 angularA, angularB;
     //We can't just use the offset to anchor for A's jacobian- the 'collision' location is way there at anchorB!
     Vector3 rA;
-    rA = vector3::Subtract(anchorB, m_connectionA->Position);
+    rA = vector3::Subtract(anchorB, positionA);
     angularA = vector3::Cross(rA, lineDirection);
     //linearB = -linearA, so just swap the cross product order.
     angularB = vector3::Cross(lineDirection, offsetB);
 
     //Put all the 1x3 jacobians into a 3x3 matrix representation.
-	linearJacobianA = matrix::Create();
-	linearJacobianA[0][0] = lineDirection.x;
-	linearJacobianA[0][1] = lineDirection.y;
-	linearJacobianA[0][2] = lineDirection.z;
-	linearJacobianB = matrix::Create();
-	linearJacobianB[0][0] = -lineDirection.x;
-	linearJacobianB[0][1] = -lineDirection.y;
-	linearJacobianB[0][2] = -lineDirection.z;
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = angularA.x;
-	angularJacobianA[0][1] = angularA.y;
-	angularJacobianA[0][2] = angularA.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = angularB.x;
-	angularJacobianB[0][1] = angularB.y;
-	angularJacobianB[0][2] = angularB.z;
+	jacobians.linearA = matrix::Create();
+	jacobians.linearA[0][0] = lineDirection.x;
+	jacobians.linearA[0][1] = lineDirection.y;
+	jacobians.linearA[0][2] = lineDirection.z;
+	jacobians.linearB = matrix::Create();
+	jacobians.linearB[0][0] = -lineDirection.x;
+	jacobians.linearB[0][1] = -lineDirection.y;
+	jacobians.linearB[0][2] = -lineDirection.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = angularA.x;
+	jacobians.angularA[0][1] = angularA.y;
+	jacobians.angularA[0][2] = angularA.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = angularB.x;
+	jacobians.angularB[0][1] = angularB.y;
+	jacobians.angularB[0][2] = angularB.z;
 
 }
\ No newline at end of file
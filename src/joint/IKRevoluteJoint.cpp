@@ -79,49 +79,51 @@ void BEPUik::IKRevoluteJoint::ComputeConstrainedAxes()
 }
 
 BEPUik::IKRevoluteJoint::IKRevoluteJoint(Bone &connectionA, Bone &connectionB, const Vector3 &freeAxis)
-    : IKJoint(connectionA, connectionB)
+    : IKJoint(connectionA, connectionB, 2)
 {
     SetWorldFreeAxisA(freeAxis);
     SetWorldFreeAxisB(freeAxis);
 }
 
-void BEPUik::IKRevoluteJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKRevoluteJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
-    linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
+    jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
     //We know the one free axis. We need the two restricted axes. This amounts to completing the orthonormal basis.
     //We can grab one of the restricted axes using a cross product of the two world axes. This is not guaranteed
     //to be nonzero, so the normalization requires protection.
 
     Vector3 worldAxisA, worldAxisB;
-    worldAxisA = quaternion::Transform(localFreeAxisA, m_connectionA->Orientation);
-    worldAxisB = quaternion::Transform(localFreeAxisB, m_connectionB->Orientation);
+    worldAxisA = matrix::Transform(localFreeAxisA, rotationA);
+    worldAxisB = matrix::Transform(localFreeAxisB, rotationB);
 
     Vector3 error;
     error = vector3::Cross(worldAxisA, worldAxisB);
 
     Vector3 worldConstrainedAxis1, worldConstrainedAxis2;
-    worldConstrainedAxis1 = quaternion::Transform(localConstrainedAxis1, m_connectionA->Orientation);
-    worldConstrainedAxis2 = quaternion::Transform(localConstrainedAxis2, m_connectionA->Orientation);
+    worldConstrainedAxis1 = matrix::Transform(localConstrainedAxis1, rotationA);
+    worldConstrainedAxis2 = matrix::Transform(localConstrainedAxis2, rotationA);
 
 
-    angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = worldConstrainedAxis1.x;
-	angularJacobianA[0][1] = worldConstrainedAxis1.y;
-	angularJacobianA[0][2] = worldConstrainedAxis1.z;
-	angularJacobianA[1][0] = worldConstrainedAxis2.x;
-	angularJacobianA[1][1] = worldConstrainedAxis2.y;
-	angularJacobianA[1][2] = worldConstrainedAxis2.z;
+    jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = worldConstrainedAxis1.x;
+	jacobians.angularA[0][1] = worldConstrainedAxis1.y;
+	jacobians.angularA[0][2] = worldConstrainedAxis1.z;
+	jacobians.angularA[1][0] = worldConstrainedAxis2.x;
+	jacobians.angularA[1][1] = worldConstrainedAxis2.y;
+	jacobians.angularA[1][2] = worldConstrainedAxis2.z;
 
-    angularJacobianB = matrix::Negate(angularJacobianA);
+    jacobians.angularB = matrix::Negate(jacobians.angularA);
 
 
     Vector2 constraintSpaceError;
     constraintSpaceError.x = vector3::Dot(error, worldConstrainedAxis1);
     constraintSpaceError.y = vector3::Dot(error, worldConstrainedAxis2);
-    velocityBias.x = errorCorrectionFactor * constraintSpaceError.x;
-    velocityBias.y = errorCorrectionFactor * constraintSpaceError.y;
+    jacobians.velocityBias.x = errorCorrectionFactor * constraintSpaceError.x;
+    jacobians.velocityBias.y = errorCorrectionFactor * constraintSpaceError.y;
 
 
 }
@@ -28,16 +28,18 @@ void BEPUik::IKSwivelHingeJoint::SetWorldTwistAxis(const Vector3 &value)
 }
 
 BEPUik::IKSwivelHingeJoint::IKSwivelHingeJoint(Bone &connectionA, Bone &connectionB, const Vector3 &worldHingeAxis, const Vector3 &worldTwistAxis)
-    : IKJoint(connectionA, connectionB)
+    : IKJoint(connectionA, connectionB, 1)
 {
     SetWorldHingeAxis(worldHingeAxis);
     SetWorldTwistAxis(worldTwistAxis);
 }
 
-void BEPUik::IKSwivelHingeJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKSwivelHingeJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
-    linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
+    jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
 
     //There are two free axes and one restricted axis.
@@ -45,8 +47,8 @@ void BEPUik::IKSwivelHingeJoint::UpdateJacobiansAndVelocityBias()
     //The restricted axis is the cross product between the twist and hinge axes.
 
     Vector3 worldTwistAxis, worldHingeAxis;
-    worldHingeAxis = quaternion::Transform(LocalHingeAxis, m_connectionA->Orientation);
-    worldTwistAxis = quaternion::Transform(LocalTwistAxis, m_connectionB->Orientation);
+    worldHingeAxis = matrix::Transform(LocalHingeAxis, rotationA);
+    worldTwistAxis = matrix::Transform(LocalTwistAxis, rotationB);
 
     Vector3 restrictedAxis;
     restrictedAxis = vector3::Cross(worldHingeAxis, worldTwistAxis);
@@ -62,17 +64,17 @@ void BEPUik::IKSwivelHingeJoint::UpdateJacobiansAndVelocityBias()
     }
 
 
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = restrictedAxis.x;
-	angularJacobianA[0][1] = restrictedAxis.y;
-	angularJacobianA[0][2] = restrictedAxis.z;
-    angularJacobianB = matrix::Negate(angularJacobianA);
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = restrictedAxis.x;
+	jacobians.angularA[0][1] = restrictedAxis.y;
+	jacobians.angularA[0][2] = restrictedAxis.z;
+    jacobians.angularB = matrix::Negate(jacobians.angularA);
 
     float error;
     error = vector3::Dot(worldHingeAxis, worldTwistAxis);
-    error = (float)std::acos(std::clamp(error, -1.f, 1.f)) - PiOver2;
+    error = Acos(std::clamp(error, -1.f, 1.f)) - PiOver2;
 
-    velocityBias = Vector3(errorCorrectionFactor * error, 0, 0);
+    jacobians.velocityBias = Vector3(errorCorrectionFactor * error, 0, 0);
 
 
 }
\ No newline at end of file
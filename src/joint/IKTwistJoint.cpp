@@ -59,7 +59,7 @@ void BEPUik::IKTwistJoint::ComputeMeasurementAxes()
 }
 
 BEPUik::IKTwistJoint::IKTwistJoint(Bone &connectionA, Bone &connectionB, const Vector3 &axisA, const Vector3 &axisB)
-    : IKJoint(connectionA, connectionB)
+    : IKJoint(connectionA, connectionB, 1)
 {
     SetAxisA(axisA);
     SetAxisB(axisB);
@@ -67,21 +67,23 @@ BEPUik::IKTwistJoint::IKTwistJoint(Bone &connectionA, Bone &connectionB, const V
     ComputeMeasurementAxes();
 }
 
-void BEPUik::IKTwistJoint::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKTwistJoint::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
 
     //This constraint doesn't consider linear motion.
-    linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+    jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
     //Compute the world axes.
     Vector3 axisA, axisB;
-    axisA = quaternion::Transform(LocalAxisA, m_connectionA->Orientation);
-    axisB = quaternion::Transform(LocalAxisB, m_connectionB->Orientation);
+    axisA = matrix::Transform(LocalAxisA, rotationA);
+    axisB = matrix::Transform(LocalAxisB, rotationB);
 
     Vector3 twistMeasureAxisA, twistMeasureAxisB;
-    twistMeasureAxisA = quaternion::Transform(LocalMeasurementAxisA, m_connectionA->Orientation);
-    twistMeasureAxisB = quaternion::Transform(LocalMeasurementAxisB, m_connectionB->Orientation);
+    twistMeasureAxisA = matrix::Transform(LocalMeasurementAxisA, rotationA);
+    twistMeasureAxisB = matrix::Transform(LocalMeasurementAxisB, rotationB);
 
     //Compute the shortest rotation to bring axisB into alignment with axisA.
     Quaternion alignmentRotation;
@@ -93,7 +95,7 @@ void BEPUik::IKTwistJoint::UpdateJacobiansAndVelocityBias()
     //We can now compare the angle between the twist axes.
     float error;
     error = vector3::Dot(twistMeasureAxisA, twistMeasureAxisB);
-    error = (float)std::acos(std::clamp(error, -1.f, 1.f));
+    error = Acos(std::clamp(error, -1.f, 1.f));
     Vector3 cross;
     cross = vector3::Cross(twistMeasureAxisA, twistMeasureAxisB);
     float dot;
@@ -102,7 +104,7 @@ void BEPUik::IKTwistJoint::UpdateJacobiansAndVelocityBias()
         error = -error;
 
     //Compute the bias based upon the error.
-    velocityBias = Vector3(errorCorrectionFactor * error, 0, 0);
+    jacobians.velocityBias = Vector3(errorCorrectionFactor * error, 0, 0);
 
     //We can't just use the axes directly as jacobians. Consider 'cranking' one object around the other.
     Vector3 jacobian;
@@ -118,14 +120,14 @@ void BEPUik::IKTwistJoint::UpdateJacobiansAndVelocityBias()
         jacobian = vector3::Create();
     }
 
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = jacobian.x;
-	angularJacobianA[0][1] = jacobian.y;
-	angularJacobianA[0][2] = jacobian.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = -jacobian.x;
-	angularJacobianB[0][1] = -jacobian.y;
-	angularJacobianB[0][2] = -jacobian.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = jacobian.x;
+	jacobians.angularA[0][1] = jacobian.y;
+	jacobians.angularA[0][2] = jacobian.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = -jacobian.x;
+	jacobians.angularB[0][1] = -jacobian.y;
+	jacobians.angularB[0][2] = -jacobian.z;
 
 
 
@@ -29,7 +29,7 @@ float BEPUik::IKDistanceLimit::GetMaximumDistance() { return MaximumDistance; }
 void BEPUik::IKDistanceLimit::SetMaximumDistance(float value) { MaximumDistance = std::max(0.f, value); }
 
 BEPUik::IKDistanceLimit::IKDistanceLimit(Bone &connectionA, Bone &connectionB, const Vector3 &anchorA, const Vector3 &anchorB, float minimumDistance, float maximumDistance)
-    : IKLimit(connectionA, connectionB)
+    : IKLimit(connectionA, connectionB, 1)
 {
     SetAnchorA(anchorA);
     SetAnchorB(anchorB);
@@ -37,15 +37,19 @@ BEPUik::IKDistanceLimit::IKDistanceLimit(Bone &connectionA, Bone &connectionB, c
     MaximumDistance = maximumDistance;
 }
 
-void BEPUik::IKDistanceLimit::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKDistanceLimit::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
     //Transform the anchors and offsets into world space.
     Vector3 offsetA, offsetB;
-    offsetA = quaternion::Transform(LocalAnchorA, m_connectionA->Orientation);
-    offsetB = quaternion::Transform(LocalAnchorB, m_connectionB->Orientation);
+    offsetA = matrix::Transform(LocalAnchorA, rotationA);
+    offsetB = matrix::Transform(LocalAnchorB, rotationB);
     Vector3 anchorA, anchorB;
-    anchorA = vector3::Add(m_connectionA->Position, offsetA);
-    anchorB = vector3::Add(m_connectionB->Position, offsetB);
+    anchorA = vector3::Add(positionA, offsetA);
+    anchorB = vector3::Add(positionB, offsetB);
 
     //Compute the distance.
     Vector3 separation;
@@ -63,31 +67,31 @@ void BEPUik::IKDistanceLimit::UpdateJacobiansAndVelocityBias()
         if (currentDistance > MaximumDistance)
         {
             //We are exceeding the maximum limit.
-            velocityBias = Vector3(errorCorrectionFactor * (currentDistance - MaximumDistance), 0, 0);
+            jacobians.velocityBias = Vector3(errorCorrectionFactor * (currentDistance - MaximumDistance), 0, 0);
         }
         else if (currentDistance < MinimumDistance)
         {
             //We are exceeding the minimum limit.
-            velocityBias = Vector3(errorCorrectionFactor * (MinimumDistance - currentDistance), 0, 0);
+            jacobians.velocityBias = Vector3(errorCorrectionFactor * (MinimumDistance - currentDistance), 0, 0);
             //The limit can only push in one direction. Flip the jacobian!
             linearA = vector3::Negate(linearA);
         }
         else if (currentDistance - MinimumDistance > (MaximumDistance - MinimumDistance) * 0.5f)
         {
             //The objects are closer to hitting the maximum limit.
-            velocityBias = Vector3(currentDistance - MaximumDistance, 0, 0);
+            jacobians.velocityBias = Vector3(currentDistance - MaximumDistance, 0, 0);
         }
         else
         {
             //The objects are closer to hitting the minimum limit.
-            velocityBias = Vector3(MinimumDistance - currentDistance, 0, 0);
+            jacobians.velocityBias = Vector3(MinimumDistance - currentDistance, 0, 0);
             //The limit can only push in one direction. Flip the jacobian!
             linearA = vector3::Negate(linearA);
         }
     }
     else
     {
-        velocityBias = vector3::Create();
+        jacobians.velocityBias = vector3::Create();
         linearA = vector3::Create();
     }
 
@@ -97,21 +101,21 @@ void BEPUik::IKDistanceLimit::UpdateJacobiansAndVelocityBias()
     angularB = vector3::Cross(linearA, offsetB);
 
     //Put all the 1x3 jacobians into a 3x3 matrix representation.
-	linearJacobianA = matrix::Create();
-	linearJacobianA[0][0] = linearA.x;
-	linearJacobianA[0][1] = linearA.y;
-	linearJacobianA[0][2] = linearA.z;
-	linearJacobianB = matrix::Create();
-	linearJacobianB[0][0] = -linearA.x;
-	linearJacobianB[0][1] = -linearA.y;
-	linearJacobianB[0][2] = -linearA.z;
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = angularA.x;
-	angularJacobianA[0][1] = angularA.y;
-	angularJacobianA[0][2] = angularA.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = angularB.x;
-	angularJacobianB[0][1] = angularB.y;
-	angularJacobianB[0][2] = angularB.z;
+	jacobians.linearA = matrix::Create();
+	jacobians.linearA[0][0] = linearA.x;
+	jacobians.linearA[0][1] = linearA.y;
+	jacobians.linearA[0][2] = linearA.z;
+	jacobians.linearB = matrix::Create();
+	jacobians.linearB[0][0] = -linearA.x;
+	jacobians.linearB[0][1] = -linearA.y;
+	jacobians.linearB[0][2] = -linearA.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = angularA.x;
+	jacobians.angularA[0][1] = angularA.y;
+	jacobians.angularA[0][2] = angularA.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = angularB.x;
+	jacobians.angularB[0][1] = angularB.y;
+	jacobians.angularB[0][2] = angularB.z;
 
 }
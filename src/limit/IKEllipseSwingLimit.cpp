@@ -60,7 +60,7 @@ void BEPUik::IKEllipseSwingLimit::SetXAxis(const Vector3& axis)
 }
 
 BEPUik::IKEllipseSwingLimit::IKEllipseSwingLimit(Bone& connectionA, Bone& connectionB, const Vector3& axisA, const Vector3& axisB, float maximumAngleX, float maximumAngleY)
-	: IKLimit(connectionA, connectionB)
+	: IKLimit(connectionA, connectionB, 1)
 {
 	SetAxisA(axisA);
 	SetAxisB(axisB);
@@ -70,7 +70,7 @@ BEPUik::IKEllipseSwingLimit::IKEllipseSwingLimit(Bone& connectionA, Bone& connec
 }
 
 BEPUik::IKEllipseSwingLimit::IKEllipseSwingLimit(Bone& connectionA, Bone& connectionB, const Vector3& axisA, const Vector3& axisB, const Vector3& axisBRight, const Vector3& axisBUp, float maximumAngleX, float maximumAngleY)
-	: IKLimit(connectionA, connectionB)
+	: IKLimit(connectionA, connectionB, 1)
 {
 	SetAxisA(axisA);
 	SetAxisB(axisB);
@@ -106,16 +106,18 @@ void BEPUik::IKEllipseSwingLimit::SetupJointTransforms(const Vector3& twistAxis)
 	yAxis = vector3::Rotate(quaternion::Inverse(m_connectionA->Orientation), yAxis);
 }
 
-void BEPUik::IKEllipseSwingLimit::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKEllipseSwingLimit::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
 	//This constraint doesn't consider linear motion.
-	linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+	jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
 	//Compute the world axes.
 	Vector3 axisA, axisB;
-	axisA = quaternion::Transform(LocalAxisA, m_connectionA->Orientation);
-	axisB = quaternion::Transform(LocalAxisB, m_connectionB->Orientation);
+	axisA = matrix::Transform(LocalAxisA, rotationA);
+	axisB = matrix::Transform(LocalAxisB, rotationB);
 
 	auto worldTwistAxisB = axisB;
 	auto primaryAxis = axisA;
@@ -134,10 +136,10 @@ void BEPUik::IKEllipseSwingLimit::UpdateJacobiansAndVelocityBias()
 	axisAngle.z = axis.z * angle;
 
 	auto basisXAxis = xAxis;
-	basisXAxis = vector3::Rotate(m_connectionA->Orientation, basisXAxis);
+	basisXAxis = matrix::Transform(basisXAxis, rotationA);
 
 	auto basisYAxis = yAxis;
-	basisYAxis = vector3::Rotate(m_connectionA->Orientation, basisYAxis);
+	basisYAxis = matrix::Transform(basisYAxis, rotationA);
 	//basis.rotationMatrix = connectionA.orientationMatrix;
 
 	//Compute the individual swing angles.
@@ -152,14 +154,14 @@ void BEPUik::IKEllipseSwingLimit::UpdateJacobiansAndVelocityBias()
 	Vector3 hingeAxis;
 	hingeAxis = vector3::Cross(axisA, axisB);
 
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = hingeAxis.x;
-	angularJacobianA[0][1] = hingeAxis.y;
-	angularJacobianA[0][2] = hingeAxis.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = -hingeAxis.x;
-	angularJacobianB[0][1] = -hingeAxis.y;
-	angularJacobianB[0][2] = -hingeAxis.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = hingeAxis.x;
+	jacobians.angularA[0][1] = hingeAxis.y;
+	jacobians.angularA[0][2] = hingeAxis.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = -hingeAxis.x;
+	jacobians.angularB[0][1] = -hingeAxis.y;
+	jacobians.angularB[0][2] = -hingeAxis.z;
 
 	//Note how we've computed the jacobians despite the limit being potentially inactive.
 	//This is to enable 'speculative' limits.
@@ -170,12 +172,12 @@ void BEPUik::IKEllipseSwingLimit::UpdateJacobiansAndVelocityBias()
 	auto effectiveMaximumAngle = vector2::Length(p);
 	if (effectiveAngle >= effectiveMaximumAngle)
 	{
-		velocityBias = Vector3(errorCorrectionFactor * (effectiveAngle - effectiveMaximumAngle), 0, 0);
+		jacobians.velocityBias = Vector3(errorCorrectionFactor * (effectiveAngle - effectiveMaximumAngle), 0, 0);
 	}
 	else
 	{
 		//The constraint is not yet violated. But, it may be- allow only as much motion as could occur withviolating the constraint.
 		//Limits can't 'pull,' so this will not result in erroneous sticking.
-		velocityBias = Vector3(effectiveAngle - effectiveMaximumAngle, 0, 0);
+		jacobians.velocityBias = Vector3(effectiveAngle - effectiveMaximumAngle, 0, 0);
 	}
 }
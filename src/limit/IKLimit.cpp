@@ -14,24 +14,37 @@
 // limitations under the License.
 
 #include "bepuik/limit/IKLimit.hpp"
+#include "JointKernels.hpp"
 
-BEPUik::IKLimit::IKLimit(Bone &connectionA, Bone &connectionB)
-    : IKJoint(connectionA, connectionB)
+BEPUik::IKLimit::IKLimit(Bone &connectionA, Bone &connectionB, int degreesOfFreedom)
+    : IKJoint(connectionA, connectionB, degreesOfFreedom)
 {
 }
 
 void BEPUik::IKLimit::SolveVelocityIteration()
 {
+    if (m_degreesOfFreedom == 1)
+    {
+        jointkernels::SolveJointVelocityIteration<1, true>(*this);
+        return;
+    }
+    if (m_degreesOfFreedom == 2)
+    {
+        jointkernels::SolveJointVelocityIteration<2, true>(*this);
+        return;
+    }
+
     //Compute the 'relative' linear and angular velocities. For single bone constraints, it's based entirely on the one bone's velocities!
     //They have to be pulled into constraint space first to compute the necessary impulse, though.
+    auto &bones = *m_boneStore;
     Vector3 linearContributionA;
-    linearContributionA = matrix::TransformTranspose(m_connectionA->linearVelocity, linearJacobianA);
+    linearContributionA = matrix::TransformTranspose(bones.linearVelocities[m_handleA], linearJacobianA);
     Vector3 angularContributionA;
-    angularContributionA = matrix::TransformTranspose(m_connectionA->angularVelocity, angularJacobianA);
+    angularContributionA = matrix::TransformTranspose(bones.angularVelocities[m_handleA], angularJacobianA);
     Vector3 linearContributionB;
-    linearContributionB = matrix::TransformTranspose(m_connectionB->linearVelocity, linearJacobianB);
+    linearContributionB = matrix::TransformTranspose(bones.linearVelocities[m_handleB], linearJacobianB);
     Vector3 angularContributionB;
-    angularContributionB = matrix::TransformTranspose(m_connectionB->angularVelocity, angularJacobianB);
+    angularContributionB = matrix::TransformTranspose(bones.angularVelocities[m_handleB], angularJacobianB);
 
     //The constraint velocity error will be the velocity we try to remove.
     Vector3 constraintVelocityError;
@@ -70,27 +83,20 @@ void BEPUik::IKLimit::SolveVelocityIteration()
 
     //The constraint space impulse now represents the impulse we want to apply to the bone... but in constraint space.
     //Bring it to world space using the transposed jacobian.
-    if (!m_connectionA->Pinned)//Treat pinned elements as if they have infinite inertia.
-    {
-        Vector3 linearImpulseA;
-        linearImpulseA = matrix::Transform(constraintSpaceImpulse, linearJacobianA);
-        Vector3 angularImpulseA;
-        angularImpulseA = matrix::Transform(constraintSpaceImpulse, angularJacobianA);
+    //Pinned bones have zero inverse mass and inertia in the store, so applying impulses to them does nothing.
+    Vector3 linearImpulseA;
+    linearImpulseA = matrix::Transform(constraintSpaceImpulse, linearJacobianA);
+    Vector3 angularImpulseA;
+    angularImpulseA = matrix::Transform(constraintSpaceImpulse, angularJacobianA);
+    Vector3 linearImpulseB;
+    linearImpulseB = matrix::Transform(constraintSpaceImpulse, linearJacobianB);
+    Vector3 angularImpulseB;
+    angularImpulseB = matrix::Transform(constraintSpaceImpulse, angularJacobianB);
 
-        //Apply them!
-        m_connectionA->ApplyLinearImpulse(linearImpulseA);
-        m_connectionA->ApplyAngularImpulse(angularImpulseA);
-    }
-    if (!m_connectionB->Pinned)//Treat pinned elements as if they have infinite inertia.
-    {
-        Vector3 linearImpulseB;
-        linearImpulseB = matrix::Transform(constraintSpaceImpulse, linearJacobianB);
-        Vector3 angularImpulseB;
-        angularImpulseB = matrix::Transform(constraintSpaceImpulse, angularJacobianB);
-
-        //Apply them!
-        m_connectionB->ApplyLinearImpulse(linearImpulseB);
-        m_connectionB->ApplyAngularImpulse(angularImpulseB);
-    }
+    //Apply them!
+    bones.ApplyLinearImpulse(m_handleA, linearImpulseA);
+    bones.ApplyAngularImpulse(m_handleA, angularImpulseA);
+    bones.ApplyLinearImpulse(m_handleB, linearImpulseB);
+    bones.ApplyAngularImpulse(m_handleB, angularImpulseB);
 
 }
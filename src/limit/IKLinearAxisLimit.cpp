@@ -31,7 +31,7 @@ float BEPUik::IKLinearAxisLimit::GetMaximumDistance() const { return maximumDist
 void BEPUik::IKLinearAxisLimit::SetMaximumDistance(float value) { maximumDistance = value; }
 
 BEPUik::IKLinearAxisLimit::IKLinearAxisLimit(Bone &connectionA, Bone &connectionB, const Vector3 &lineAnchor, const Vector3 &lineDirection, const Vector3 &anchorB, float minimumDistance, float maximumDistance)
-    : IKLimit(connectionA, connectionB)
+    : IKLimit(connectionA, connectionB, 1)
 {
     SetLineAnchor(lineAnchor);
     SetLineDirection(lineDirection);
@@ -40,16 +40,20 @@ BEPUik::IKLinearAxisLimit::IKLinearAxisLimit(Bone &connectionA, Bone &connection
     SetMaximumDistance(maximumDistance);
 }
 
-void BEPUik::IKLinearAxisLimit::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKLinearAxisLimit::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &positionA = bones.positions[handleA];
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &positionB = bones.positions[handleB];
+    const auto &rotationB = bones.rotations[handleB];
     //Transform the anchors and offsets into world space.
     Vector3 offsetA, offsetB, lineDirection;
-    offsetA = quaternion::Transform(LocalLineAnchor, m_connectionA->Orientation);
-    lineDirection = quaternion::Transform(LocalLineDirection, m_connectionA->Orientation);
-    offsetB = quaternion::Transform(LocalAnchorB, m_connectionB->Orientation);
+    offsetA = matrix::Transform(LocalLineAnchor, rotationA);
+    lineDirection = matrix::Transform(LocalLineDirection, rotationA);
+    offsetB = matrix::Transform(LocalAnchorB, rotationB);
     Vector3 anchorA, anchorB;
-    anchorA = vector3::Add(m_connectionA->Position, offsetA);
-    anchorB = vector3::Add(m_connectionB->Position, offsetB);
+    anchorA = vector3::Add(positionA, offsetA);
+    anchorB = vector3::Add(positionB, offsetB);
 
     //Compute the distance.
     Vector3 separation;
@@ -62,24 +66,24 @@ void BEPUik::IKLinearAxisLimit::UpdateJacobiansAndVelocityBias()
     if (currentDistance > maximumDistance)
     {
         //We are exceeding the maximum limit.
-        velocityBias = Vector3(errorCorrectionFactor * (currentDistance - maximumDistance), 0, 0);
+        jacobians.velocityBias = Vector3(errorCorrectionFactor * (currentDistance - maximumDistance), 0, 0);
     }
     else if (currentDistance < minimumDistance)
     {
         //We are exceeding the minimum limit.
-        velocityBias = Vector3(errorCorrectionFactor * (minimumDistance - currentDistance), 0, 0);
+        jacobians.velocityBias = Vector3(errorCorrectionFactor * (minimumDistance - currentDistance), 0, 0);
         //The limit can only push in one direction. Flip the jacobian!
         lineDirection = vector3::Negate(lineDirection);
     }
     else if (currentDistance - minimumDistance > (maximumDistance - minimumDistance) * 0.5f)
     {
         //The objects are closer to hitting the maximum limit.
-        velocityBias = Vector3(currentDistance - maximumDistance, 0, 0);
+        jacobians.velocityBias = Vector3(currentDistance - maximumDistance, 0, 0);
     }
     else
     {
         //The objects are closer to hitting the minimum limit.
-        velocityBias = Vector3(minimumDistance - currentDistance, 0, 0);
+        jacobians.velocityBias = Vector3(minimumDistance - currentDistance, 0, 0);
         //The limit can only push in one direction. Flip the jacobian!
         lineDirection = vector3::Negate(lineDirection);
     }
@@ -87,27 +91,27 @@ void BEPUik::IKLinearAxisLimit::UpdateJacobiansAndVelocityBias()
     Vector3 angularA, angularB;
     //We can't just use the offset to anchor for A's jacobian- the 'collision' location is way there at anchorB!
     Vector3 rA;
-    rA = vector3::Subtract(anchorB, m_connectionA->Position);
+    rA = vector3::Subtract(anchorB, positionA);
     angularA = vector3::Cross(rA, lineDirection);
     //linearB = -linearA, so just swap the cross product order.
     angularB = vector3::Cross(lineDirection, offsetB);
 
     //Put all the 1x3 jacobians into a 3x3 matrix representation.
-	linearJacobianA = matrix::Create();
-	linearJacobianA[0][0] = lineDirection.x;
-	linearJacobianA[0][1] = lineDirection.y;
-	linearJacobianA[0][2] = lineDirection.z;
-	linearJacobianB = matrix::Create();
-	linearJacobianB[0][0] = -lineDirection.x;
-	linearJacobianB[0][1] = -lineDirection.y;
-	linearJacobianB[0][2] = -lineDirection.z;
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = angularA.x;
-	angularJacobianA[0][1] = angularA.y;
-	angularJacobianA[0][2] = angularA.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = angularB.x;
-	angularJacobianB[0][1] = angularB.y;
-	angularJacobianB[0][2] = angularB.z;
+	jacobians.linearA = matrix::Create();
+	jacobians.linearA[0][0] = lineDirection.x;
+	jacobians.linearA[0][1] = lineDirection.y;
+	jacobians.linearA[0][2] = lineDirection.z;
+	jacobians.linearB = matrix::Create();
+	jacobians.linearB[0][0] = -lineDirection.x;
+	jacobians.linearB[0][1] = -lineDirection.y;
+	jacobians.linearB[0][2] = -lineDirection.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = angularA.x;
+	jacobians.angularA[0][1] = angularA.y;
+	jacobians.angularA[0][2] = angularA.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = angularB.x;
+	jacobians.angularB[0][1] = angularB.y;
+	jacobians.angularB[0][2] = angularB.z;
 
 }
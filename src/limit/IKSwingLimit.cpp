@@ -25,55 +25,57 @@ float BEPUik::IKSwingLimit::GetMaximumAngle() const { return maximumAngle; }
 void BEPUik::IKSwingLimit::SetMaximumAngle(float value) { maximumAngle = std::max(0.f, value); }
 
 BEPUik::IKSwingLimit::IKSwingLimit(Bone &connectionA, Bone &connectionB, const Vector3 &axisA, const Vector3 &axisB, float maximumAngle)
-    : IKLimit(connectionA, connectionB)
+    : IKLimit(connectionA, connectionB, 1)
 {
     SetAxisA(axisA);
     SetAxisB(axisB);
     SetMaximumAngle(maximumAngle);
 }
 
-void BEPUik::IKSwingLimit::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKSwingLimit::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
 
     //This constraint doesn't consider linear motion.
-    linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+    jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
     //Compute the world axes.
     Vector3 axisA, axisB;
-    axisA = quaternion::Transform(LocalAxisA, m_connectionA->Orientation);
-    axisB = quaternion::Transform(LocalAxisB, m_connectionB->Orientation);
+    axisA = matrix::Transform(LocalAxisA, rotationA);
+    axisB = matrix::Transform(LocalAxisB, rotationB);
 
     float dot;
     dot = vector3::Dot(axisA, axisB);
 
     //Yes, we could avoid this acos here. Performance is not the highest goal of this system; the less tricks used, the easier it is to understand.
-    float angle = (float)std::acos(std::clamp(dot, -1.f, 1.f));
+    float angle = Acos(std::clamp(dot, -1.f, 1.f));
 
     //One angular DOF is constrained by this limit.
     Vector3 hingeAxis;
     hingeAxis = vector3::Cross(axisA, axisB);
 
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = hingeAxis.x;
-	angularJacobianA[0][1] = hingeAxis.y;
-	angularJacobianA[0][2] = hingeAxis.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = -hingeAxis.x;
-	angularJacobianB[0][1] = -hingeAxis.y;
-	angularJacobianB[0][2] = -hingeAxis.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = hingeAxis.x;
+	jacobians.angularA[0][1] = hingeAxis.y;
+	jacobians.angularA[0][2] = hingeAxis.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = -hingeAxis.x;
+	jacobians.angularB[0][1] = -hingeAxis.y;
+	jacobians.angularB[0][2] = -hingeAxis.z;
 
     //Note how we've computed the jacobians despite the limit being potentially inactive.
     //This is to enable 'speculative' limits.
     if (angle >= maximumAngle)
     {
-        velocityBias = Vector3(errorCorrectionFactor * (angle - maximumAngle), 0, 0);
+        jacobians.velocityBias = Vector3(errorCorrectionFactor * (angle - maximumAngle), 0, 0);
     }
     else
     {
         //The constraint is not yet violated. But, it may be- allow only as much motion as could occur withviolating the constraint.
         //Limits can't 'pull,' so this will not result in erroneous sticking.
-        velocityBias = Vector3(angle - maximumAngle, 0, 0);
+        jacobians.velocityBias = Vector3(angle - maximumAngle, 0, 0);
     }
 
 
@@ -62,7 +62,7 @@ void BEPUik::IKTwistLimit::ComputeMeasurementAxes()
 }
 
 BEPUik::IKTwistLimit::IKTwistLimit(Bone& connectionA, Bone& connectionB, const Vector3& axisA, const Vector3& axisB, float maximumAngle)
-	: IKLimit(connectionA, connectionB)
+	: IKLimit(connectionA, connectionB, 1)
 {
 	SetAxisA(axisA);
 	SetAxisB(axisB);
@@ -71,21 +71,23 @@ BEPUik::IKTwistLimit::IKTwistLimit(Bone& connectionA, Bone& connectionB, const V
 	ComputeMeasurementAxes();
 }
 
-void BEPUik::IKTwistLimit::UpdateJacobiansAndVelocityBias()
+void BEPUik::IKTwistLimit::ComputeJacobians(const BoneStore &bones, BoneHandle handleA, BoneHandle handleB, JointJacobians &jacobians) const
 {
+    const auto &rotationA = bones.rotations[handleA];
+    const auto &rotationB = bones.rotations[handleB];
 
 	//This constraint doesn't consider linear motion.
-	linearJacobianA = matrix::Create();
-	linearJacobianB = matrix::Create();
+	jacobians.linearA = matrix::Create();
+	jacobians.linearB = matrix::Create();
 
 	//Compute the world axes.
 	Vector3 axisA, axisB;
-	axisA = quaternion::Transform(LocalAxisA, m_connectionA->Orientation);
-	axisB = quaternion::Transform(LocalAxisB, m_connectionB->Orientation);
+	axisA = matrix::Transform(LocalAxisA, rotationA);
+	axisB = matrix::Transform(LocalAxisB, rotationB);
 
 	Vector3 twistMeasureAxisA, twistMeasureAxisB;
-	twistMeasureAxisA = quaternion::Transform(LocalMeasurementAxisA, m_connectionA->Orientation);
-	twistMeasureAxisB = quaternion::Transform(LocalMeasurementAxisB, m_connectionB->Orientation);
+	twistMeasureAxisA = matrix::Transform(LocalMeasurementAxisA, rotationA);
+	twistMeasureAxisB = matrix::Transform(LocalMeasurementAxisB, rotationB);
 
 	//Compute the shortest rotation to bring axisB into alignment with axisA.
 	Quaternion alignmentRotation;
@@ -97,13 +99,13 @@ void BEPUik::IKTwistLimit::UpdateJacobiansAndVelocityBias()
 	//We can now compare the angle between the twist axes.
 	float angle;
 	angle = vector3::Dot(twistMeasureAxisA, twistMeasureAxisB);
-	angle = (float)std::acos(std::clamp(angle, -1.f, 1.f));
+	angle = Acos(std::clamp(angle, -1.f, 1.f));
 
 	//Compute the bias based upon the error.
 	if (angle > maximumAngle)
-		velocityBias = Vector3(errorCorrectionFactor * (angle - maximumAngle), 0, 0);
+		jacobians.velocityBias = Vector3(errorCorrectionFactor * (angle - maximumAngle), 0, 0);
 	else //If the constraint isn't violated, set up the velocity bias to allow a 'speculative' limit.
-		velocityBias = Vector3(angle - maximumAngle, 0, 0);
+		jacobians.velocityBias = Vector3(angle - maximumAngle, 0, 0);
 
 	//We can't just use the axes directly as jacobians. Consider 'cranking' one object around the other.
 	Vector3 jacobian;
@@ -131,14 +133,14 @@ void BEPUik::IKTwistLimit::UpdateJacobiansAndVelocityBias()
 	if (limitSide < 0)
 		jacobian = vector3::Negate(jacobian);
 
-	angularJacobianA = matrix::Create();
-	angularJacobianA[0][0] = jacobian.x;
-	angularJacobianA[0][1] = jacobian.y;
-	angularJacobianA[0][2] = jacobian.z;
-	angularJacobianB = matrix::Create();
-	angularJacobianB[0][0] = -jacobian.x;
-	angularJacobianB[0][1] = -jacobian.y;
-	angularJacobianB[0][2] = -jacobian.z;
+	jacobians.angularA = matrix::Create();
+	jacobians.angularA[0][0] = jacobian.x;
+	jacobians.angularA[0][1] = jacobian.y;
+	jacobians.angularA[0][2] = jacobian.z;
+	jacobians.angularB = matrix::Create();
+	jacobians.angularB[0][0] = -jacobian.x;
+	jacobians.angularB[0][1] = -jacobian.y;
+	jacobians.angularB[0][2] = -jacobian.z;
 
 
 
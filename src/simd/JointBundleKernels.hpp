@@ -0,0 +1,141 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "bepuik/JointBatches.hpp"
+
+namespace BEPUik
+{
+    /// <summary>
+    /// Velocity iteration kernels for SIMD joint bundles.
+    /// Each instruction set lives in its own translation unit so that it can be compiled with the matching architecture flags;
+    /// the solver only calls into the ones the CPU supports.
+    /// </summary>
+	namespace bundlekernels
+	{
+        /// <summary>
+        /// Number of velocity components gathered per lane: linear A, angular A, linear B and angular B.
+        /// </summary>
+        constexpr int BundleVelocityCount = 12;
+        using BundleVelocities = float[BundleVelocityCount][JointBundleWidth];
+
+        /// <summary>
+        /// Solves one velocity iteration for all lanes of a bundle using the wide float type TWide.
+        /// TWide provides Width, Load, Store, Broadcast, the arithmetic operators, Max, Sqrt and SelectGreater.
+        /// The kernels only touch plain float data; gathering and scattering the bone velocities is left to the caller,
+        /// so no inline library code gets compiled with the wider instruction sets.
+        /// </summary>
+        /// <param name="bundle">Bundle to solve.</param>
+        /// <param name="velocities">Gathered bone velocities of each lane on input, velocity changes to apply on output.</param>
+        template<class TWide, int Rows, bool IsLimit>
+            inline void SolveBundle(JointBundle<Rows> &bundle, BundleVelocities &velocities)
+        {
+            for (int lane = 0; lane < JointBundleWidth; lane += TWide::Width)
+            {
+                TWide velocity[BundleVelocityCount];
+                for (int k = 0; k < BundleVelocityCount; ++k)
+                    velocity[k] = TWide::Load(&velocities[k][lane]);
+
+                //Pull the relative velocity into constraint space and remove the position correction and softness biases.
+                TWide softness = TWide::Load(&bundle.softness[lane]);
+                TWide constraintVelocityError[Rows];
+                TWide accumulatedImpulse[Rows];
+                for (int i = 0; i < Rows; ++i)
+                {
+                    TWide error = TWide::Load(&bundle.linearJacobianA[i][0][lane]) * velocity[0];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        if (k > 0)
+                            error = error + TWide::Load(&bundle.linearJacobianA[i][k][lane]) * velocity[k];
+                        error = error + TWide::Load(&bundle.angularJacobianA[i][k][lane]) * velocity[3 + k];
+                        error = error + TWide::Load(&bundle.linearJacobianB[i][k][lane]) * velocity[6 + k];
+                        error = error + TWide::Load(&bundle.angularJacobianB[i][k][lane]) * velocity[9 + k];
+                    }
+                    accumulatedImpulse[i] = TWide::Load(&bundle.accumulatedImpulse[i][lane]);
+                    constraintVelocityError[i] = error - TWide::Load(&bundle.velocityBias[i][lane]) + accumulatedImpulse[i] * softness;
+                }
+
+                TWide preadd[Rows];
+                TWide impulseSquared = TWide::Broadcast(0.f);
+                for (int i = 0; i < Rows; ++i)
+                {
+                    TWide impulse = TWide::Broadcast(0.f);
+                    for (int j = 0; j < Rows; ++j)
+                        impulse = impulse - constraintVelocityError[j] * TWide::Load(&bundle.effectiveMass[j][i][lane]);
+                    preadd[i] = accumulatedImpulse[i];
+                    accumulatedImpulse[i] = accumulatedImpulse[i] + impulse;
+                    if constexpr (IsLimit)
+                        accumulatedImpulse[i] = Max(TWide::Broadcast(0.f), accumulatedImpulse[i]);
+                    impulseSquared = impulseSquared + accumulatedImpulse[i] * accumulatedImpulse[i];
+                }
+                //Clamp the lanes whose accumulated impulse exceeds their capacity.
+                TWide maximumImpulseSquared = TWide::Load(&bundle.maximumImpulseSquared[lane]);
+                TWide scale = SelectGreater(impulseSquared, maximumImpulseSquared,
+                    TWide::Load(&bundle.maximumImpulse[lane]) / Sqrt(impulseSquared), TWide::Broadcast(1.f));
+
+                TWide velocityChange[BundleVelocityCount];
+                for (int i = 0; i < Rows; ++i)
+                {
+                    accumulatedImpulse[i] = accumulatedImpulse[i] * scale;
+                    accumulatedImpulse[i].Store(&bundle.accumulatedImpulse[i][lane]);
+                    TWide constraintSpaceImpulse = accumulatedImpulse[i] - preadd[i];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        TWide linearA = TWide::Load(&bundle.linearVelocityChangeA[i][k][lane]) * constraintSpaceImpulse;
+                        TWide angularA = TWide::Load(&bundle.angularVelocityChangeA[i][k][lane]) * constraintSpaceImpulse;
+                        TWide linearB = TWide::Load(&bundle.linearVelocityChangeB[i][k][lane]) * constraintSpaceImpulse;
+                        TWide angularB = TWide::Load(&bundle.angularVelocityChangeB[i][k][lane]) * constraintSpaceImpulse;
+                        velocityChange[k] = i == 0 ? linearA : velocityChange[k] + linearA;
+                        velocityChange[3 + k] = i == 0 ? angularA : velocityChange[3 + k] + angularA;
+                        velocityChange[6 + k] = i == 0 ? linearB : velocityChange[6 + k] + linearB;
+                        velocityChange[9 + k] = i == 0 ? angularB : velocityChange[9 + k] + angularB;
+                    }
+                }
+                for (int k = 0; k < BundleVelocityCount; ++k)
+                    velocityChange[k].Store(&velocities[k][lane]);
+            }
+        }
+
+        //Entry points of each instruction set. isLimit selects the positive impulse clamp.
+#define BEPUIK_DECLARE_BUNDLE_KERNELS(NAMESPACE) \
+		namespace NAMESPACE \
+		{ \
+			extern const bool Available; \
+			void Solve(JointBundle<1> &bundle, BundleVelocities &velocities, bool isLimit); \
+			void Solve(JointBundle<2> &bundle, BundleVelocities &velocities, bool isLimit); \
+			void Solve(JointBundle<3> &bundle, BundleVelocities &velocities, bool isLimit); \
+		}
+		BEPUIK_DECLARE_BUNDLE_KERNELS(scalar)
+		BEPUIK_DECLARE_BUNDLE_KERNELS(sse)
+		BEPUIK_DECLARE_BUNDLE_KERNELS(avx2)
+#undef BEPUIK_DECLARE_BUNDLE_KERNELS
+
+        //Defines the entry points of an instruction set for the wide type TWide.
+#define BEPUIK_DEFINE_BUNDLE_KERNELS(NAMESPACE, TWide) \
+		void BEPUik::bundlekernels::NAMESPACE::Solve(JointBundle<1> &bundle, BundleVelocities &velocities, bool isLimit) \
+		{ \
+			if (isLimit) SolveBundle<TWide, 1, true>(bundle, velocities); else SolveBundle<TWide, 1, false>(bundle, velocities); \
+		} \
+		void BEPUik::bundlekernels::NAMESPACE::Solve(JointBundle<2> &bundle, BundleVelocities &velocities, bool isLimit) \
+		{ \
+			if (isLimit) SolveBundle<TWide, 2, true>(bundle, velocities); else SolveBundle<TWide, 2, false>(bundle, velocities); \
+		} \
+		void BEPUik::bundlekernels::NAMESPACE::Solve(JointBundle<3> &bundle, BundleVelocities &velocities, bool isLimit) \
+		{ \
+			if (isLimit) SolveBundle<TWide, 3, true>(bundle, velocities); else SolveBundle<TWide, 3, false>(bundle, velocities); \
+		}
+	}
+}
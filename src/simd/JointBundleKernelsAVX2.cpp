@@ -0,0 +1,59 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//This file is compiled with AVX2 code generation enabled (see CMakeLists.txt). It must only be entered after checking GetSupportedSimdLevel.
+#include "JointBundleKernels.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace BEPUik
+{
+	namespace bundlekernels
+	{
+		namespace
+		{
+			struct AVX2Wide
+			{
+				static constexpr int Width = 8;
+				__m256 value;
+
+				static AVX2Wide Load(const float *p) {return {_mm256_load_ps(p)};}
+				static AVX2Wide Broadcast(float v) {return {_mm256_set1_ps(v)};}
+				void Store(float *p) const {_mm256_store_ps(p, value);}
+			};
+			inline AVX2Wide operator+(AVX2Wide a, AVX2Wide b) {return {_mm256_add_ps(a.value, b.value)};}
+			inline AVX2Wide operator-(AVX2Wide a, AVX2Wide b) {return {_mm256_sub_ps(a.value, b.value)};}
+			inline AVX2Wide operator*(AVX2Wide a, AVX2Wide b) {return {_mm256_mul_ps(a.value, b.value)};}
+			inline AVX2Wide operator/(AVX2Wide a, AVX2Wide b) {return {_mm256_div_ps(a.value, b.value)};}
+			inline AVX2Wide Max(AVX2Wide a, AVX2Wide b) {return {_mm256_max_ps(a.value, b.value)};}
+			inline AVX2Wide Sqrt(AVX2Wide a) {return {_mm256_sqrt_ps(a.value)};}
+			inline AVX2Wide SelectGreater(AVX2Wide a, AVX2Wide b, AVX2Wide ifGreater, AVX2Wide otherwise)
+			{
+				return {_mm256_blendv_ps(otherwise.value, ifGreater.value, _mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ))};
+			}
+		}
+	}
+}
+
+const bool BEPUik::bundlekernels::avx2::Available = true;
+BEPUIK_DEFINE_BUNDLE_KERNELS(avx2, AVX2Wide)
+#else
+//The compiler could not target AVX2 for this file; the solver never selects these kernels.
+const bool BEPUik::bundlekernels::avx2::Available = false;
+void BEPUik::bundlekernels::avx2::Solve(JointBundle<1> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+void BEPUik::bundlekernels::avx2::Solve(JointBundle<2> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+void BEPUik::bundlekernels::avx2::Solve(JointBundle<3> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "JointBundleKernels.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BEPUIK_HAS_SSE 1
+#include <emmintrin.h>
+
+namespace BEPUik
+{
+	namespace bundlekernels
+	{
+		namespace
+		{
+			struct SSEWide
+			{
+				static constexpr int Width = 4;
+				__m128 value;
+
+				static SSEWide Load(const float *p) {return {_mm_load_ps(p)};}
+				static SSEWide Broadcast(float v) {return {_mm_set1_ps(v)};}
+				void Store(float *p) const {_mm_store_ps(p, value);}
+			};
+			inline SSEWide operator+(SSEWide a, SSEWide b) {return {_mm_add_ps(a.value, b.value)};}
+			inline SSEWide operator-(SSEWide a, SSEWide b) {return {_mm_sub_ps(a.value, b.value)};}
+			inline SSEWide operator*(SSEWide a, SSEWide b) {return {_mm_mul_ps(a.value, b.value)};}
+			inline SSEWide operator/(SSEWide a, SSEWide b) {return {_mm_div_ps(a.value, b.value)};}
+			inline SSEWide Max(SSEWide a, SSEWide b) {return {_mm_max_ps(a.value, b.value)};}
+			inline SSEWide Sqrt(SSEWide a) {return {_mm_sqrt_ps(a.value)};}
+			inline SSEWide SelectGreater(SSEWide a, SSEWide b, SSEWide ifGreater, SSEWide otherwise)
+			{
+				__m128 mask = _mm_cmpgt_ps(a.value, b.value);
+				return {_mm_or_ps(_mm_and_ps(mask, ifGreater.value), _mm_andnot_ps(mask, otherwise.value))};
+			}
+		}
+	}
+}
+
+const bool BEPUik::bundlekernels::sse::Available = true;
+BEPUIK_DEFINE_BUNDLE_KERNELS(sse, SSEWide)
+#else
+//SSE2 is not available on this architecture; the solver never selects these kernels.
+const bool BEPUik::bundlekernels::sse::Available = false;
+void BEPUik::bundlekernels::sse::Solve(JointBundle<1> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+void BEPUik::bundlekernels::sse::Solve(JointBundle<2> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+void BEPUik::bundlekernels::sse::Solve(JointBundle<3> &bundle, BundleVelocities &velocities, bool isLimit) {scalar::Solve(bundle, velocities, isLimit);}
+#endif
@@ -0,0 +1,46 @@
+// Copyright (c) 2023 Bepu Entertainment LLC
+// Copyright (c) 2023 Silverlan
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "JointBundleKernels.hpp"
+#include <cmath>
+
+namespace BEPUik
+{
+	namespace bundlekernels
+	{
+		namespace
+		{
+			struct ScalarWide
+			{
+				static constexpr int Width = 1;
+				float value;
+
+				static ScalarWide Load(const float *p) {return {*p};}
+				static ScalarWide Broadcast(float v) {return {v};}
+				void Store(float *p) const {*p = value;}
+			};
+			inline ScalarWide operator+(ScalarWide a, ScalarWide b) {return {a.value + b.value};}
+			inline ScalarWide operator-(ScalarWide a, ScalarWide b) {return {a.value - b.value};}
+			inline ScalarWide operator*(ScalarWide a, ScalarWide b) {return {a.value * b.value};}
+			inline ScalarWide operator/(ScalarWide a, ScalarWide b) {return {a.value / b.value};}
+			inline ScalarWide Max(ScalarWide a, ScalarWide b) {return {a.value > b.value ? a.value : b.value};}
+			inline ScalarWide Sqrt(ScalarWide a) {return {std::sqrt(a.value)};}
+			inline ScalarWide SelectGreater(ScalarWide a, ScalarWide b, ScalarWide ifGreater, ScalarWide otherwise) {return a.value > b.value ? ifGreater : otherwise;}
+		}
+	}
+}
+
+const bool BEPUik::bundlekernels::scalar::Available = true;
+BEPUIK_DEFINE_BUNDLE_KERNELS(scalar, ScalarWide)